@@ -0,0 +1,295 @@
+// Reservoir resampling of the first diffuse bounce (ReSTIR GI) for FRAME_RESTIR frames.
+// Included by gradient.comp after tracePath(). RESTIR_SAMPLE traces one secondary path
+// per pixel and merges it with the previous frame's reservoir at the reprojected
+// visible point; RESTIR_SHADE merges a few neighboring reservoirs, checks visibility
+// of the chosen sample and writes the pixel. frame.x counts frames since the history
+// was reset (0 = no history) and its low bit selects the current half of the state,
+// whose header holds the previous frame's camera.
+const uint RESTIR_SAMPLE = 0u;
+const uint RESTIR_SHADE = 1u;
+const uint RESTIR_TEMPORAL_MAX_M = 20u;
+const uint RESTIR_SPATIAL_SAMPLES = 4u;
+const float RESTIR_SPATIAL_RADIUS = 24.0;
+const float RESTIR_SKY_DISTANCE = 1e4;
+const float RESTIR_NORMAL_THRESHOLD = 0.9;
+const float RESTIR_PLANE_THRESHOLD = 0.01;
+const float RESTIR_JACOBIAN_MAX = 10.0;
+
+// surface is the visible point, with w = 1 when it is a diffuse vertex that owns a
+// reservoir. surfaceData packs its normal, albedo and the radiance the reservoir does
+// not cover (half rgb): the direct term, or the whole path for other pixels.
+// samplePoint is the reservoir's secondary hit with W in w; sampleData packs the
+// radiance leaving it toward the visible point (half rgb), its normal and M.
+struct RestirPixel {
+    vec4 surface;
+    uvec4 surfaceData;
+    vec4 samplePoint;
+    uvec4 sampleData;
+};
+
+layout(std430, binding = 12) buffer RestirState {
+    ViewCamera previousCamera;
+    RestirPixel pixels[];
+} restir;
+
+struct Reservoir {
+    vec3 point;
+    vec3 normal;
+    vec3 radiance;
+    float target;
+    float weightSum;
+    uint M;
+};
+
+vec2 signNotZero(vec2 v)
+{
+    return vec2((v.x >= 0.0) ? 1.0 : -1.0, (v.y >= 0.0) ? 1.0 : -1.0);
+}
+
+// Octahedral encoding, 16 bits per component.
+uint packNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = (n.z >= 0.0) ? n.xy : (1.0 - abs(n.yx)) * signNotZero(n.xy);
+    return packSnorm2x16(e);
+}
+
+vec3 unpackNormal(uint bits)
+{
+    vec2 e = unpackSnorm2x16(bits);
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+    return normalize(n);
+}
+
+uvec2 packRadiance(vec3 radiance)
+{
+    return uvec2(packHalf2x16(radiance.rg), packHalf2x16(vec2(radiance.b, 0.0)));
+}
+
+vec3 unpackRadiance(uvec2 bits)
+{
+    return vec3(unpackHalf2x16(bits.x), unpackHalf2x16(bits.y).x);
+}
+
+uint restirPixelIndex(ivec2 pixel, uint slot)
+{
+    uvec2 sz = pc.view.xy;
+    return slot * sz.x * sz.y + uint(pixel.x) + sz.x * uint(pixel.y);
+}
+
+// p-hat: luminance of the incoming radiance times the cosine at the visible point.
+// Diffuse reflection is albedo / pi times this in color, so a single cosine-distributed
+// sample (W = pi / cos) shades to albedo * radiance like a plain path.
+float restirTarget(vec3 visiblePos, vec3 visibleNormal, vec3 point, vec3 radiance)
+{
+    vec3 dir = normalize(point - visiblePos);
+    return dot(radiance, vec3(0.2126, 0.7152, 0.0722)) * max(dot(visibleNormal, dir), 0.0);
+}
+
+// Reconnection shift of a sample from the visible point fromPos to toPos: the ratio
+// of solid-angle densities at the sample point, clamped to keep grazing reuse quiet.
+float restirJacobian(vec3 fromPos, vec3 toPos, vec3 point, vec3 normal)
+{
+    vec3 fromDir = fromPos - point;
+    vec3 toDir = toPos - point;
+    float fromDist2 = dot(fromDir, fromDir);
+    float toDist2 = dot(toDir, toDir);
+    float fromCos = abs(dot(normal, fromDir)) * inversesqrt(max(fromDist2, 1e-8));
+    float toCos = abs(dot(normal, toDir)) * inversesqrt(max(toDist2, 1e-8));
+    return min((toCos * fromDist2) / max(fromCos * toDist2, 1e-8), RESTIR_JACOBIAN_MAX);
+}
+
+bool updateReservoir(inout Reservoir r, vec3 point, vec3 normal, vec3 radiance, float target, float weight, uint m, inout uint seed)
+{
+    r.weightSum += weight;
+    r.M += m;
+    if ((weight <= 0.0) || (random01(seed) * r.weightSum >= weight)) return false;
+    r.point = point;
+    r.normal = normal;
+    r.radiance = radiance;
+    r.target = target;
+    return true;
+}
+
+float reservoirW(Reservoir r)
+{
+    return ((r.target > 0.0) && (r.M > 0u)) ? (r.weightSum / (float(r.M) * r.target)) : 0.0;
+}
+
+// Streams the stored reservoir of another visible point into r when the two surfaces
+// are alike, reweighting its sample for this point; M is clamped to maxM.
+void mergeStoredReservoir(inout Reservoir r, RestirPixel other, vec3 pos, vec3 normal, uint maxM, inout uint seed)
+{
+    if (other.surface.w <= 0.0) return;
+    vec3 otherNormal = unpackNormal(other.surfaceData.x);
+    if (dot(otherNormal, normal) < RESTIR_NORMAL_THRESHOLD) return;
+    float planeDistance = abs(dot(normal, other.surface.xyz - pos));
+    if (planeDistance > RESTIR_PLANE_THRESHOLD * distance(pos, pc.origin.xyz)) return;
+
+    uint m = min(other.sampleData.w, maxM);
+    if (m == 0u) return;
+    // Reservoirs whose samples all carried no light still count towards M.
+    float otherW = other.samplePoint.w;
+    vec3 point = other.samplePoint.xyz;
+    vec3 pointNormal = unpackNormal(other.sampleData.z);
+    vec3 radiance = unpackRadiance(other.sampleData.xy);
+    float target = restirTarget(pos, normal, point, radiance);
+    float weight = 0.0;
+    if (otherW > 0.0)
+    {
+        weight = target * otherW * float(m) * restirJacobian(other.surface.xyz, pos, point, pointNormal);
+    }
+    updateReservoir(r, point, pointNormal, radiance, target, weight, m, seed);
+}
+
+bool restirGridAvailable()
+{
+    return (pc.counts.y > 0u) &&
+           (pc.counts.z > 0u) &&
+           all(greaterThan(pc.grid_dims.xyz, uvec3(0u)));
+}
+
+// Pixel of the view-sized frame that sees pos from the given camera, if any.
+bool projectToPixel(vec3 pos, vec3 cameraOrigin, vec4 forwardFov, out ivec2 pixel)
+{
+    pixel = ivec2(0);
+    vec3 forward = normalize(forwardFov.xyz);
+    vec3 right = normalize(cross(forward, WORLD_UP));
+    vec3 up = cross(right, forward);
+    vec3 rel = pos - cameraOrigin;
+    float z = dot(rel, forward);
+    if (z <= 1e-4) return false;
+    vec2 sz = vec2(pc.view.xy);
+    float halfFovTan = tan(forwardFov.w * 0.5);
+    vec2 uv = vec2(dot(rel, right) / (halfFovTan * sz.x / sz.y), dot(rel, up) / halfFovTan) / z;
+    vec2 texel = vec2(uv.x + 1.0, 1.0 - uv.y) * 0.5 * sz;
+    pixel = ivec2(floor(texel));
+    return all(greaterThanEqual(pixel, ivec2(0))) && all(lessThan(pixel, ivec2(pc.view.xy)));
+}
+
+void restirSample(ivec2 pixel, Ray ray, uint seed, bool haveFirstHit, SceneHit first)
+{
+    bool gridAvailable = restirGridAvailable();
+    vec3 cameraOrigin = ray.origin;
+    SceneHit hit = first;
+    if (!haveFirstHit)
+    {
+        traceScene(ray, gridAvailable, false, hit.type, hit.t, hit.normal, hit.pos, hit.material);
+    }
+
+    vec3 albedo = vec3(1.0);
+    vec3 direct = vec3(0.0);
+    bool diffuse = false;
+    if (hit.type == 2)
+    {
+        albedo = checkerAlbedo(hit.pos);
+        direct = albedo * (0.08 + 0.12 * max(dot(hit.normal, SUN_DIR), 0.0));
+        diffuse = true;
+    }
+    else if (hit.type == 1)
+    {
+        float metalness = 0.0;
+        float ior = 1.0;
+        getSphereMaterial(hit.material, albedo, metalness, ior);
+        direct = albedo * (0.04 + 0.16 * max(dot(hit.normal, SUN_DIR), 0.0));
+        diffuse = (ior <= 1.01) && (metalness <= 0.5) && (dot(hit.normal, ray.dir) < 0.0);
+    }
+
+    uint current = pc.frame.x & 1u;
+    uint index = restirPixelIndex(pixel, current);
+    if (!diffuse)
+    {
+        // Sky, mirrors and glass keep their plain path sample.
+        vec3 radiance = tracePath(ray, cameraOrigin, 0, seed, true, hit);
+        restir.pixels[index].surface = vec4(hit.pos, 0.0);
+        restir.pixels[index].surfaceData = uvec4(0u, 0u, packRadiance(radiance));
+        restir.pixels[index].sampleData = uvec4(0u);
+        restir.pixels[index].samplePoint = vec4(0.0);
+        return;
+    }
+
+    // Initial candidate: one cosine-distributed secondary path, so the source pdf is
+    // cos / pi and its resampling weight p-hat / pdf is pi times the luminance.
+    Ray bounceRay = Ray(hit.pos + hit.normal * 0.001, sampleHemisphere(hit.normal, seed));
+    SceneHit bounceHit = SceneHit(0, 0.0, vec3(0.0), vec3(0.0), 0u);
+    bool bounceUsesProxies = bounceUsesLod(1, bounceRay.origin, cameraOrigin);
+    Reservoir r = Reservoir(vec3(0.0), vec3(0.0), vec3(0.0), 0.0, 0.0, 0u);
+    vec3 point = bounceRay.origin + bounceRay.dir * RESTIR_SKY_DISTANCE;
+    vec3 pointNormal = -bounceRay.dir;
+    vec3 radiance = skyColor(bounceRay.dir);
+    if (traceScene(bounceRay, gridAvailable, bounceUsesProxies, bounceHit.type, bounceHit.t, bounceHit.normal, bounceHit.pos, bounceHit.material))
+    {
+        point = bounceHit.pos;
+        pointNormal = bounceHit.normal;
+        radiance = tracePath(bounceRay, cameraOrigin, 1, seed, true, bounceHit);
+    }
+    float target = restirTarget(hit.pos, hit.normal, point, radiance);
+    updateReservoir(r, point, pointNormal, radiance, target, 3.14159265 * dot(radiance, vec3(0.2126, 0.7152, 0.0722)), 1u, seed);
+
+    ivec2 previousPixel;
+    ViewCamera previousCamera = restir.previousCamera;
+    if ((pc.frame.x > 0u) && projectToPixel(hit.pos, previousCamera.origin.xyz, previousCamera.forward_fov, previousPixel))
+    {
+        RestirPixel previous = restir.pixels[restirPixelIndex(previousPixel, current ^ 1u)];
+        mergeStoredReservoir(r, previous, hit.pos, hit.normal, RESTIR_TEMPORAL_MAX_M, seed);
+    }
+
+    restir.pixels[index].surface = vec4(hit.pos, 1.0);
+    restir.pixels[index].surfaceData = uvec4(packNormal(hit.normal), packUnorm4x8(vec4(albedo, 0.0)), packRadiance(direct));
+    restir.pixels[index].samplePoint = vec4(r.point, reservoirW(r));
+    restir.pixels[index].sampleData = uvec4(packRadiance(r.radiance), packNormal(r.normal), r.M);
+}
+
+void restirShade(ivec2 pixel, ivec2 p)
+{
+    uint current = pc.frame.x & 1u;
+    RestirPixel self = restir.pixels[restirPixelIndex(pixel, current)];
+    vec3 baseRadiance = unpackRadiance(self.surfaceData.zw);
+    if (self.surface.w <= 0.0)
+    {
+        imageStore(outImage, p, vec4(baseRadiance, 1.0));
+        return;
+    }
+
+    vec3 pos = self.surface.xyz;
+    vec3 normal = unpackNormal(self.surfaceData.x);
+    uint seed = hash32((uint(pixel.x) * 1973u) ^ (uint(pixel.y) * 9277u) ^ (pc.frame.x * 0x9e3779b9u) ^ 0x2c1b3c6du);
+    Reservoir r = Reservoir(vec3(0.0), vec3(0.0), vec3(0.0), 0.0, 0.0, 0u);
+    mergeStoredReservoir(r, self, pos, normal, 0xffffffffu, seed);
+    for (uint i = 0u; i < RESTIR_SPATIAL_SAMPLES; ++i)
+    {
+        float radius = RESTIR_SPATIAL_RADIUS * sqrt(random01(seed));
+        float angle = 6.2831853 * random01(seed);
+        ivec2 neighbor = pixel + ivec2(round(radius * vec2(cos(angle), sin(angle))));
+        if (any(lessThan(neighbor, ivec2(0))) || any(greaterThanEqual(neighbor, ivec2(pc.view.xy))) ||
+            all(equal(neighbor, pixel)))
+        {
+            continue;
+        }
+        mergeStoredReservoir(r, restir.pixels[restirPixelIndex(neighbor, current)], pos, normal, 0xffffffffu, seed);
+    }
+
+    // Reused samples are only trusted once the visible point can see them.
+    vec3 indirect = vec3(0.0);
+    float W = reservoirW(r);
+    if (W > 0.0)
+    {
+        vec3 toPoint = r.point - pos;
+        float pointDistance = length(toPoint);
+        Ray shadowRay = Ray(pos + normal * 0.001, toPoint / pointDistance);
+        int hitType = 0;
+        float hitT = 0.0;
+        vec3 hitNormal = vec3(0.0);
+        vec3 hitPos = vec3(0.0);
+        uint hitMaterial = 0u;
+        bool occluded = traceScene(shadowRay, restirGridAvailable(), false, hitType, hitT, hitNormal, hitPos, hitMaterial) &&
+                        (hitT < pointDistance * 0.999);
+        if (!occluded)
+        {
+            vec3 albedo = unpackUnorm4x8(self.surfaceData.y).rgb;
+            indirect = albedo * (1.0 / 3.14159265) * r.radiance * max(dot(normal, shadowRay.dir), 0.0) * W;
+        }
+    }
+    imageStore(outImage, p, vec4(baseRadiance + indirect, 1.0));
+}
@@ -0,0 +1,561 @@
+// Scene bindings, push constants and ray traversal shared by the compute shaders.
+layout(std430, binding = 1) readonly buffer PackedSpheres {
+    uint words[];
+} spheres;
+layout(std430, binding = 2) readonly buffer GridCells {
+    uvec2 cells[];
+} gridCells;
+layout(std430, binding = 3) readonly buffer GridIndices {
+    uint indices[];
+} gridIndices;
+// Bit-packed copy of the flat scene's grid (CompactGrid in scene.h), traced instead of
+// bindings 2 and 3 when FRAME_COMPACT_GRID is set.
+layout(std430, binding = 13) readonly buffer CompactGrid {
+    uint words[];
+} compactGrid;
+
+struct SphereBlock {
+    vec4 bounds_min;
+    vec4 bounds_extent;
+    uvec4 counts;
+    uvec4 dims;
+    uvec4 base;
+};
+
+struct SphereInstance {
+    vec4 world_to_local[3];
+    uvec4 block;
+};
+
+layout(std430, binding = 4) readonly buffer SphereBlocks {
+    SphereBlock blocks[];
+} sphereBlocks;
+layout(std430, binding = 5) readonly buffer SphereInstances {
+    SphereInstance instances[];
+} sphereInstances;
+// Irradiance probes on a grid spanning the scene bounds. Each probe holds an ambient
+// cube: the cosine-weighted average incoming radiance for normals along +x, -x, +y,
+// -y, +z and -z, with w counting the updates blended in so far (0 = never traced).
+layout(std430, binding = 7) buffer ProbeCache {
+    vec4 faces[];
+} probes;
+// scene_min.w / scene_extent.w hold the sphere radius range. view is the full frame
+// size and the origin of the tile covered by outImage; frame is the sample index and
+// FRAME_* flags. grid_dims.w is the first bounce that traces the LOD proxies described
+// by block 0 of a flat scene (0 = exact); origin.w, when positive, also sends secondary
+// rays starting farther than that from the camera to the proxies. With FRAME_FULL_IMAGE
+// the images span the full frame and the dispatch only covers the tile, so they are
+// addressed by frame pixel instead of tile texel.
+// frame.z packs the probe grid dims (10 bits per axis); FRAME_PROBES lets diffuse
+// vertices after the first hit end on a probe lookup. With FRAME_MULTI_VIEW,
+// gradient.comp takes the camera from binding 9 by gl_GlobalInvocationID.z instead
+// of origin/forward_fov, and frame.w is the sample count per pixel. FRAME_TILE_BINS
+// resolves primary hits from the tile lists below instead of the grid, and
+// FRAME_FIRST_HIT stops every path after its first hit. FRAME_RESTIR runs the
+// reservoir pass of restir.glsl selected by frame.w. FRAME_COMPACT_GRID traces the flat
+// scene from binding 13.
+layout(push_constant) uniform Scene {
+    vec4 origin;
+    vec4 forward_fov;
+    vec4 scene_min;
+    vec4 scene_extent;
+    uvec4 view;
+    uvec4 counts;
+    uvec4 grid_dims;
+    uvec4 frame;
+} pc;
+
+const uint FRAME_ACCUMULATE = 1u;
+const uint FRAME_RESOLVE = 2u;
+const uint FRAME_FULL_IMAGE = 4u;
+const uint FRAME_PROBES = 8u;
+const uint FRAME_MULTI_VIEW = 16u;
+const uint FRAME_TILE_BINS = 32u;
+const uint FRAME_FIRST_HIT = 64u;
+const uint FRAME_RESTIR = 128u;
+const uint FRAME_COMPACT_GRID = 256u;
+const uint COMPACT_GRID_HEADER_WORDS = 4u;
+const uint COMPACT_GRID_GROUP = 16u;
+
+// Primary-ray candidate lists per BIN_TILE_SIZE screen tile of the view.xy frame,
+// built by tile_bin.comp. For T tiles, values holds T sphere counts, T offsets into
+// entries and T fill cursors.
+const uint BIN_TILE_SIZE = 8u;
+layout(std430, binding = 10) buffer TileBins {
+    uint values[];
+} tileBins;
+layout(std430, binding = 11) buffer TileEntries {
+    uint entries[];
+} tileEntries;
+
+uint binTileCount()
+{
+    uvec2 tiles = (pc.view.xy + BIN_TILE_SIZE - 1u) / BIN_TILE_SIZE;
+    return tiles.x * tiles.y;
+}
+
+struct Ray {
+    vec3 origin;
+    vec3 dir;
+};
+
+// Sphere and grid data for one packed-sphere block. Offsets index the shared
+// sphere, cell and index buffers; cell offsets are relative to indexBase.
+struct GridDesc {
+    vec3 boundsMin;
+    vec3 boundsExtent;
+    vec2 radiusRange;
+    ivec3 dims;
+    uint sphereCount;
+    uint cellCount;
+    uint indexCount;
+    uint sphereBase;
+    uint cellBase;
+    uint indexBase;
+    bool compact;
+};
+
+struct GridDda {
+    ivec3 cell;
+    ivec3 step;
+    vec3 tMax;
+    vec3 tDelta;
+    float t;
+    float tExit;
+};
+
+const vec3 WORLD_UP = vec3(0.0, 1.0, 0.0);
+const vec3 SUN_DIR = normalize(vec3(0.55, 0.85, 0.25));
+const int MAX_BOUNCES = 3;
+
+vec3 skyColor(vec3 dir)
+{
+    float t = 0.5 * (dir.y + 1.0);
+    return mix(vec3(1.0), vec3(0.5, 0.7, 1.0), clamp(t, 0.0, 1.0));
+}
+
+bool hitSphere(vec3 center, float radius, Ray r, out float t)
+{
+    vec3 oc = r.origin - center;
+    float a = dot(r.dir, r.dir);
+    float h = dot(oc, r.dir);
+    float c = dot(oc, oc) - radius * radius;
+    float disc = h * h - a * c;
+    if (disc <= 0.0) return false;
+    float root = sqrt(disc);
+    float t0 = (-h - root) / a;
+    if (t0 > 0.001) { t = t0; return true; }
+    float t1 = (-h + root) / a;
+    if (t1 > 0.001) { t = t1; return true; }
+    return false;
+}
+
+GridDesc flatGridDesc()
+{
+    GridDesc g;
+    g.boundsMin = pc.scene_min.xyz;
+    g.boundsExtent = pc.scene_extent.xyz;
+    g.radiusRange = vec2(pc.scene_min.w, pc.scene_extent.w);
+    g.dims = ivec3(pc.grid_dims.xyz);
+    g.sphereCount = pc.counts.x;
+    g.cellCount = pc.counts.y;
+    g.indexCount = pc.counts.z;
+    g.sphereBase = 0u;
+    g.cellBase = 0u;
+    g.indexBase = 0u;
+    g.compact = (pc.frame.y & FRAME_COMPACT_GRID) != 0u;
+    return g;
+}
+
+GridDesc blockGridDesc(uint blockIndex)
+{
+    SphereBlock block = sphereBlocks.blocks[blockIndex];
+    GridDesc g;
+    g.boundsMin = block.bounds_min.xyz;
+    g.boundsExtent = block.bounds_extent.xyz;
+    g.radiusRange = vec2(block.bounds_min.w, block.bounds_extent.w);
+    g.dims = ivec3(block.dims.xyz);
+    g.sphereCount = block.counts.x;
+    g.cellCount = block.counts.y;
+    g.indexCount = block.counts.z;
+    g.sphereBase = block.base.x;
+    g.cellBase = block.base.y;
+    g.indexBase = block.base.z;
+    g.compact = false;
+    return g;
+}
+
+void decodeSphere(GridDesc g, uint sphereIndex, out vec3 center, out float radius, out uint materialId)
+{
+    uint w0 = spheres.words[(g.sphereBase + sphereIndex) * 2u + 0u];
+    uint w1 = spheres.words[(g.sphereBase + sphereIndex) * 2u + 1u];
+
+    uint qx = w0 & 0xffffu;
+    uint qy = (w0 >> 16u) & 0xffffu;
+    uint qz = w1 & 0xffffu;
+    uint qRadius = (w1 >> 16u) & 0x0fffu;
+    materialId = min((w1 >> 28u) & 0x0fu, 2u);
+
+    vec3 q = vec3(float(qx), float(qy), float(qz)) * (1.0 / 65535.0);
+    center = g.boundsMin + q * g.boundsExtent;
+
+    float encoded = float(qRadius) * (1.0 / 4095.0);
+    float radiusNorm = encoded * encoded;
+    radius = mix(g.radiusRange.x, g.radiusRange.y, radiusNorm);
+}
+
+uint hash32(uint x)
+{
+    x ^= x >> 16u;
+    x *= 0x7feb352du;
+    x ^= x >> 15u;
+    x *= 0x846ca68bu;
+    x ^= x >> 16u;
+    return x;
+}
+
+float random01(inout uint state)
+{
+    state = hash32(state);
+    return float(state) * (1.0 / 4294967296.0);
+}
+
+vec3 checkerAlbedo(vec3 hitPos)
+{
+    vec2 checkerCoord = floor(hitPos.xz);
+    float checker = abs(mod(checkerCoord.x + checkerCoord.y, 2.0));
+    vec3 floorA = vec3(0.11, 0.12, 0.13);
+    vec3 floorB = vec3(0.18, 0.19, 0.20);
+    return mix(floorA, floorB, checker);
+}
+
+vec3 sampleHemisphere(vec3 n, inout uint seed)
+{
+    float u1 = random01(seed);
+    float u2 = random01(seed);
+    float r = sqrt(u1);
+    float theta = 6.2831853 * u2;
+
+    vec3 tangent = normalize(abs(n.y) > 0.999 ? cross(n, vec3(1.0, 0.0, 0.0)) : cross(WORLD_UP, n));
+    vec3 bitangent = cross(n, tangent);
+    vec3 local = vec3(r * cos(theta), sqrt(max(0.0, 1.0 - u1)), r * sin(theta));
+    return normalize(tangent * local.x + n * local.y + bitangent * local.z);
+}
+
+void getSphereMaterial(uint materialId, out vec3 albedo, out float metalness, out float ior)
+{
+    if (materialId == 0u)
+    {
+        albedo = vec3(0.78, 0.44, 0.22);
+        metalness = 0.0;
+        ior = 1.0;
+        return;
+    }
+    if (materialId == 1u)
+    {
+        albedo = vec3(0.56, 0.58, 0.62);
+        metalness = 1.0;
+        ior = 1.0;
+        return;
+    }
+    albedo = vec3(0.97, 0.99, 1.0);
+    metalness = 0.0;
+    ior = 1.45;
+}
+
+bool beginGridDda(vec3 boundsMin, vec3 boundsExtent, ivec3 dims, Ray ray, out GridDda dda)
+{
+    dda = GridDda(ivec3(0), ivec3(0), vec3(1e30), vec3(1e30), 0.0, -1.0);
+    vec3 boundsMax = boundsMin + boundsExtent;
+    vec3 dir = ray.dir;
+    vec3 invDir = vec3(
+        (abs(dir.x) > 1e-6) ? (1.0 / dir.x) : ((dir.x >= 0.0) ? 1e30 : -1e30),
+        (abs(dir.y) > 1e-6) ? (1.0 / dir.y) : ((dir.y >= 0.0) ? 1e30 : -1e30),
+        (abs(dir.z) > 1e-6) ? (1.0 / dir.z) : ((dir.z >= 0.0) ? 1e30 : -1e30));
+
+    vec3 t0 = (boundsMin - ray.origin) * invDir;
+    vec3 t1 = (boundsMax - ray.origin) * invDir;
+    vec3 tNear = min(t0, t1);
+    vec3 tFar = max(t0, t1);
+    float tEnter = max(max(tNear.x, tNear.y), max(tNear.z, 0.0));
+    float tExit = min(min(tFar.x, tFar.y), tFar.z);
+    if (tExit < tEnter) return false;
+
+    vec3 cellSize = boundsExtent / vec3(dims);
+    vec3 safeCellSize = max(cellSize, vec3(1e-5));
+    vec3 startPos = ray.origin + dir * tEnter;
+    vec3 rel = (startPos - boundsMin) / safeCellSize;
+    rel = clamp(rel, vec3(0.0), vec3(dims) - vec3(1e-4));
+    ivec3 cell = ivec3(floor(rel));
+
+    ivec3 step = ivec3(
+        (dir.x > 0.0) ? 1 : ((dir.x < 0.0) ? -1 : 0),
+        (dir.y > 0.0) ? 1 : ((dir.y < 0.0) ? -1 : 0),
+        (dir.z > 0.0) ? 1 : ((dir.z < 0.0) ? -1 : 0));
+
+    vec3 cellMin = boundsMin + vec3(cell) * safeCellSize;
+    vec3 cellMax = cellMin + safeCellSize;
+    vec3 tMax;
+    tMax.x = (step.x > 0) ? (cellMax.x - ray.origin.x) * invDir.x : ((step.x < 0) ? (cellMin.x - ray.origin.x) * invDir.x : 1e30);
+    tMax.y = (step.y > 0) ? (cellMax.y - ray.origin.y) * invDir.y : ((step.y < 0) ? (cellMin.y - ray.origin.y) * invDir.y : 1e30);
+    tMax.z = (step.z > 0) ? (cellMax.z - ray.origin.z) * invDir.z : ((step.z < 0) ? (cellMin.z - ray.origin.z) * invDir.z : 1e30);
+    vec3 tDelta = vec3(
+        (step.x != 0) ? abs(safeCellSize.x * invDir.x) : 1e30,
+        (step.y != 0) ? abs(safeCellSize.y * invDir.y) : 1e30,
+        (step.z != 0) ? abs(safeCellSize.z * invDir.z) : 1e30);
+
+    dda = GridDda(cell, step, tMax, tDelta, tEnter, tExit);
+    return true;
+}
+
+bool gridDdaInside(GridDda dda, ivec3 dims, float minT)
+{
+    return (dda.cell.x >= 0) && (dda.cell.x < dims.x) &&
+           (dda.cell.y >= 0) && (dda.cell.y < dims.y) &&
+           (dda.cell.z >= 0) && (dda.cell.z < dims.z) &&
+           (dda.t <= dda.tExit) && (dda.t <= minT);
+}
+
+// Returns false once the closest hit lies before the next cell boundary.
+bool advanceGridDda(inout GridDda dda, float minT)
+{
+    float nextT = min(dda.tMax.x, min(dda.tMax.y, dda.tMax.z));
+    if (minT <= nextT) return false;
+    if (dda.tMax.x <= dda.tMax.y && dda.tMax.x <= dda.tMax.z)
+    {
+        dda.cell.x += dda.step.x;
+        dda.tMax.x += dda.tDelta.x;
+    }
+    else if (dda.tMax.y <= dda.tMax.z)
+    {
+        dda.cell.y += dda.step.y;
+        dda.tMax.y += dda.tDelta.y;
+    }
+    else
+    {
+        dda.cell.z += dda.step.z;
+        dda.tMax.z += dda.tDelta.z;
+    }
+    dda.t = nextT;
+    return true;
+}
+
+uint gridDdaLinearIndex(GridDda dda, ivec3 dims)
+{
+    return uint(dda.cell.x) + uint(dims.x) * uint(dda.cell.y) + uint(dims.x * dims.y) * uint(dda.cell.z);
+}
+
+// width bits starting bit bits into the compact grid stream that begins at word.
+uint readCompactBits(uint word, uint bit, uint width)
+{
+    uint shift = bit & 31u;
+    uint value = compactGrid.words[word + (bit >> 5u)] >> shift;
+    if (shift + width > 32u) value |= compactGrid.words[word + (bit >> 5u) + 1u] << (32u - shift);
+    return (width >= 32u) ? value : (value & ((1u << width) - 1u));
+}
+
+bool traceSpheresGrid(GridDesc g, Ray ray, inout float minT, inout vec3 hitCenter, inout uint hitMaterial)
+{
+    if (any(lessThanEqual(g.dims, ivec3(0)))) return false;
+    if ((g.cellCount == 0u) || (g.indexCount == 0u)) return false;
+
+    GridDda dda;
+    if (!beginGridDda(g.boundsMin, g.boundsExtent, g.dims, ray, dda)) return false;
+
+    // Compact header: reference, count and delta widths, the cell and index stream
+    // starts and the reference count.
+    uvec4 header = g.compact ? uvec4(compactGrid.words[0], compactGrid.words[1], compactGrid.words[2], compactGrid.words[3])
+                             : uvec4(0u);
+    uint indexBits = header.x & 0xffu;
+    uint countBits = (header.x >> 8u) & 0xffu;
+    uint cellBits = countBits + ((header.x >> 16u) & 0xffu);
+
+    bool hit = false;
+    while (gridDdaInside(dda, g.dims, minT))
+    {
+        uint linearIndex = gridDdaLinearIndex(dda, g.dims);
+        if (linearIndex < g.cellCount)
+        {
+            uint offset = 0u;
+            uint end = 0u;
+            if (g.compact)
+            {
+                uint cellWord = readCompactBits(header.y, linearIndex * cellBits, cellBits);
+                offset = compactGrid.words[COMPACT_GRID_HEADER_WORDS + linearIndex / COMPACT_GRID_GROUP] + (cellWord >> countBits);
+                end = min(offset + (cellWord & ((1u << countBits) - 1u)), header.w);
+            }
+            else
+            {
+                uvec2 cellInfo = gridCells.cells[g.cellBase + linearIndex];
+                offset = cellInfo.x;
+                end = min(offset + cellInfo.y, g.indexCount);
+            }
+            for (uint idx = offset; idx < end; ++idx)
+            {
+                uint sphereIndex = g.compact ? readCompactBits(header.z, idx * indexBits, indexBits)
+                                             : gridIndices.indices[g.indexBase + idx];
+                if (sphereIndex >= g.sphereCount) continue;
+                vec3 center;
+                float radius;
+                uint materialId;
+                decodeSphere(g, sphereIndex, center, radius, materialId);
+                float t = 0.0;
+                if (hitSphere(center, radius, ray, t) && (t < minT))
+                {
+                    minT = t;
+                    hitCenter = center;
+                    hitMaterial = materialId;
+                    hit = true;
+                }
+            }
+        }
+
+        if (!advanceGridDda(dda, minT)) break;
+    }
+    return hit;
+}
+
+// Walks the top-level grid of instances (stored at the start of the cell and index
+// buffers) and traces each instance's block with the ray moved into block space.
+// Directions are not renormalised, so t stays comparable across instances.
+bool traceInstances(Ray ray, inout float minT, inout vec3 hitNormal, inout uint hitMaterial)
+{
+    ivec3 dims = ivec3(pc.grid_dims.xyz);
+    GridDda dda;
+    if (!beginGridDda(pc.scene_min.xyz, pc.scene_extent.xyz, dims, ray, dda)) return false;
+
+    bool hit = false;
+    while (gridDdaInside(dda, dims, minT))
+    {
+        uint linearIndex = gridDdaLinearIndex(dda, dims);
+        if (linearIndex < pc.counts.y)
+        {
+            uvec2 cellInfo = gridCells.cells[linearIndex];
+            uint end = min(cellInfo.x + cellInfo.y, pc.counts.z);
+            for (uint idx = cellInfo.x; idx < end; ++idx)
+            {
+                uint instanceIndex = gridIndices.indices[idx];
+                if (instanceIndex >= pc.counts.x) continue;
+                SphereInstance inst = sphereInstances.instances[instanceIndex];
+                Ray localRay = Ray(
+                    vec3(dot(inst.world_to_local[0].xyz, ray.origin) + inst.world_to_local[0].w,
+                         dot(inst.world_to_local[1].xyz, ray.origin) + inst.world_to_local[1].w,
+                         dot(inst.world_to_local[2].xyz, ray.origin) + inst.world_to_local[2].w),
+                    vec3(dot(inst.world_to_local[0].xyz, ray.dir),
+                         dot(inst.world_to_local[1].xyz, ray.dir),
+                         dot(inst.world_to_local[2].xyz, ray.dir)));
+                vec3 center = vec3(0.0);
+                if (traceSpheresGrid(blockGridDesc(inst.block.x), localRay, minT, center, hitMaterial))
+                {
+                    vec3 localNormal = normalize(localRay.origin + localRay.dir * minT - center);
+                    hitNormal = normalize(inst.world_to_local[0].xyz * localNormal.x +
+                                          inst.world_to_local[1].xyz * localNormal.y +
+                                          inst.world_to_local[2].xyz * localNormal.z);
+                    hit = true;
+                }
+            }
+        }
+
+        if (!advanceGridDda(dda, minT)) break;
+    }
+    return hit;
+}
+
+bool traceScene(Ray ray, bool gridAvailable, bool useLod, out int hitType, out float hitT, out vec3 hitNormal, out vec3 hitPos, out uint hitMaterial)
+{
+    hitType = 0;
+    hitT = 1e30;
+    hitNormal = vec3(0.0);
+    hitPos = vec3(0.0);
+    hitMaterial = 0u;
+
+    if (abs(ray.dir.y) > 1e-5)
+    {
+        float planeT = -ray.origin.y / ray.dir.y;
+        if ((planeT > 0.001) && (planeT < hitT))
+        {
+            hitType = 2;
+            hitT = planeT;
+            hitNormal = WORLD_UP;
+            hitPos = ray.origin + ray.dir * hitT;
+        }
+    }
+
+    if (gridAvailable && (pc.counts.w > 0u))
+    {
+        float sphereT = hitT;
+        vec3 sphereNormal = vec3(0.0);
+        uint sphereMaterial = 0u;
+        if (traceInstances(ray, sphereT, sphereNormal, sphereMaterial) && (sphereT < hitT))
+        {
+            hitType = 1;
+            hitT = sphereT;
+            hitPos = ray.origin + ray.dir * hitT;
+            hitNormal = sphereNormal;
+            hitMaterial = sphereMaterial;
+        }
+    }
+    else if (gridAvailable)
+    {
+        float sphereT = hitT;
+        vec3 sphereCenter = vec3(0.0);
+        uint sphereMaterial = 0u;
+        GridDesc g = useLod ? blockGridDesc(0u) : flatGridDesc();
+        if (traceSpheresGrid(g, ray, sphereT, sphereCenter, sphereMaterial) && (sphereT < hitT))
+        {
+            hitType = 1;
+            hitT = sphereT;
+            hitPos = ray.origin + ray.dir * hitT;
+            hitNormal = normalize(hitPos - sphereCenter);
+            hitMaterial = sphereMaterial;
+        }
+    }
+
+    return hitType != 0;
+}
+
+uvec3 probeDims()
+{
+    return uvec3(pc.frame.z & 0x3ffu, (pc.frame.z >> 10u) & 0x3ffu, (pc.frame.z >> 20u) & 0x3ffu);
+}
+
+vec3 probePosition(uvec3 probe, uvec3 dims)
+{
+    return pc.scene_min.xyz + (vec3(probe) + 0.5) * pc.scene_extent.xyz / vec3(dims);
+}
+
+vec3 probeIrradiance(uint probeIndex, vec3 n)
+{
+    vec3 n2 = n * n;
+    uint base = probeIndex * 6u;
+    return n2.x * probes.faces[base + ((n.x >= 0.0) ? 0u : 1u)].rgb +
+           n2.y * probes.faces[base + ((n.y >= 0.0) ? 2u : 3u)].rgb +
+           n2.z * probes.faces[base + ((n.z >= 0.0) ? 4u : 5u)].rgb;
+}
+
+// Trilinear blend of the eight probes around pos. Probes that were never traced are
+// left out, so the cache fades in rather than darkening the first frames.
+vec3 sampleProbes(vec3 pos, vec3 n)
+{
+    uvec3 dims = probeDims();
+    if (any(equal(dims, uvec3(0u)))) return vec3(0.0);
+    vec3 g = (pos - pc.scene_min.xyz) / max(pc.scene_extent.xyz, vec3(1e-5)) * vec3(dims) - 0.5;
+    g = clamp(g, vec3(0.0), vec3(dims - 1u));
+    uvec3 base = min(uvec3(g), dims - 1u);
+    vec3 f = g - vec3(base);
+
+    vec3 sum = vec3(0.0);
+    float weightSum = 0.0;
+    for (uint i = 0u; i < 8u; ++i)
+    {
+        uvec3 offset = uvec3(i & 1u, (i >> 1u) & 1u, (i >> 2u) & 1u);
+        uvec3 probe = min(base + offset, dims - 1u);
+        vec3 w3 = mix(1.0 - f, f, vec3(offset));
+        uint probeIndex = probe.x + dims.x * (probe.y + dims.y * probe.z);
+        float w = w3.x * w3.y * w3.z;
+        if ((w <= 0.0) || (probes.faces[probeIndex * 6u].w <= 0.0)) continue;
+        sum += w * probeIrradiance(probeIndex, n);
+        weightSum += w;
+    }
+    return (weightSum > 0.0) ? (sum / weightSum) : vec3(0.0);
+}
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+#define BENCH_LINE_MAX 1024
+
+// Timings below this many milliseconds of change are treated as noise.
+static const double BENCH_MIN_DELTA_MS = 0.1;
+
+static const char *BENCH_CASE_FORMAT =
+    " {\"name\": \"%63[^\"]\", \"spheres\": %u, \"distribution\": \"%15[^\"]\", \"grid\": [%u, %u, %u], "
+    "\"pose\": \"%15[^\"]\", \"gen_ms\": %lf, \"build_ms\": %lf, \"gpu_ms\": %lf, \"mrays_per_s\": %lf, "
+    "\"memory_bytes\": %llu}";
+
+int gbbWriteBenchReport(const char* path, const BenchReport* report)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) return 1;
+    fprintf(file, "{\n");
+    fprintf(file, "  \"device\": \"%s\",\n", report->device);
+    fprintf(file, "  \"width\": %u,\n", report->width);
+    fprintf(file, "  \"height\": %u,\n", report->height);
+    fprintf(file, "  \"frames\": %u,\n", report->frames);
+    fprintf(file, "  \"cases\": [\n");
+    for (uint32_t i = 0u; i < report->count; ++i)
+    {
+        const BenchResult* r = &report->results[i];
+        fprintf(file,
+                "    {\"name\": \"%s\", \"spheres\": %u, \"distribution\": \"%s\", \"grid\": [%u, %u, %u], "
+                "\"pose\": \"%s\", \"gen_ms\": %.4f, \"build_ms\": %.4f, \"gpu_ms\": %.4f, \"mrays_per_s\": %.3f, "
+                "\"memory_bytes\": %llu}%s\n",
+                r->name, r->sphereCount, r->distribution, r->gridDims[0], r->gridDims[1], r->gridDims[2],
+                r->pose, r->genMs, r->buildMs, r->gpuMs, r->mraysPerSecond,
+                (unsigned long long)r->memoryBytes, (i + 1u < report->count) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return (fclose(file) != 0) ? 1 : 0;
+}
+
+int gbbReadBenchReport(const char* path, BenchReport* report)
+{
+    memset(report, 0, sizeof(*report));
+    FILE *file = fopen(path, "r");
+    if (!file) return 1;
+
+    uint32_t capacity = 0u;
+    char line[BENCH_LINE_MAX];
+    while (fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, " \"device\": \"%255[^\"]\"", report->device) == 1) continue;
+        if (sscanf(line, " \"width\": %u", &report->width) == 1) continue;
+        if (sscanf(line, " \"height\": %u", &report->height) == 1) continue;
+        if (sscanf(line, " \"frames\": %u", &report->frames) == 1) continue;
+
+        BenchResult r;
+        unsigned long long memoryBytes = 0u;
+        memset(&r, 0, sizeof(r));
+        if (sscanf(line, BENCH_CASE_FORMAT, r.name, &r.sphereCount, r.distribution,
+                   &r.gridDims[0], &r.gridDims[1], &r.gridDims[2], r.pose,
+                   &r.genMs, &r.buildMs, &r.gpuMs, &r.mraysPerSecond, &memoryBytes) != 12)
+        {
+            continue;
+        }
+        r.memoryBytes = (uint64_t)memoryBytes;
+        if (report->count >= capacity)
+        {
+            capacity = (capacity > 0u) ? (capacity * 2u) : 64u;
+            BenchResult *results = (BenchResult *)realloc(report->results, (size_t)capacity * sizeof(BenchResult));
+            if (!results)
+            {
+                fclose(file);
+                return 1;
+            }
+            report->results = results;
+        }
+        report->results[report->count++] = r;
+    }
+    fclose(file);
+    return (report->count > 0u) ? 0 : 1;
+}
+
+void gbbFreeBenchReport(BenchReport* report)
+{
+    free(report->results);
+    memset(report, 0, sizeof(*report));
+}
+
+static uint32_t checkMetric(const char* caseName, const char* metric, double baseline, double current,
+                            double tolerance, double minDelta)
+{
+    if ((current <= baseline * (1.0 + tolerance)) || ((current - baseline) <= minDelta)) return 0u;
+    printf("REGRESSION %-40s %-12s %12.4f -> %12.4f (%+.1f%%)\n", caseName, metric, baseline, current,
+           (baseline > 0.0) ? ((current / baseline - 1.0) * 100.0) : 100.0);
+    return 1u;
+}
+
+// Flags GPU time, scene build time and memory that grew by more than tolerance.
+// Cases are matched by name; results from a different resolution are not comparable.
+uint32_t gbbCompareBenchReports(const BenchReport* baseline, const BenchReport* current, double tolerance)
+{
+    if ((baseline->width != current->width) || (baseline->height != current->height))
+    {
+        printf("baseline is %ux%u, current run is %ux%u; GPU timings are not comparable\n",
+               baseline->width, baseline->height, current->width, current->height);
+    }
+
+    uint32_t regressions = 0u;
+    uint32_t compared = 0u;
+    uint32_t missing = 0u;
+    for (uint32_t i = 0u; i < current->count; ++i)
+    {
+        const BenchResult* cur = &current->results[i];
+        const BenchResult* base = NULL;
+        for (uint32_t j = 0u; j < baseline->count; ++j)
+        {
+            if (strcmp(baseline->results[j].name, cur->name) == 0)
+            {
+                base = &baseline->results[j];
+                break;
+            }
+        }
+        if (!base)
+        {
+            missing += 1u;
+            continue;
+        }
+        compared += 1u;
+        uint32_t flagged = 0u;
+        if ((baseline->width == current->width) && (baseline->height == current->height))
+        {
+            flagged |= checkMetric(cur->name, "gpu_ms", base->gpuMs, cur->gpuMs, tolerance, BENCH_MIN_DELTA_MS);
+        }
+        flagged |= checkMetric(cur->name, "gen+build_ms", base->genMs + base->buildMs, cur->genMs + cur->buildMs,
+                               tolerance, BENCH_MIN_DELTA_MS);
+        flagged |= checkMetric(cur->name, "memory_bytes", (double)base->memoryBytes, (double)cur->memoryBytes, tolerance, 0.0);
+        regressions += flagged;
+    }
+    printf("compared %u cases against baseline (%u not in baseline): %u regressed beyond %.0f%%\n",
+           compared, missing, regressions, tolerance * 100.0);
+    return regressions;
+}
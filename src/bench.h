@@ -0,0 +1,42 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct BenchResult {
+    char name[64];
+    char distribution[16];
+    char pose[16];
+    uint32_t sphereCount;
+    uint32_t gridDims[3];
+    double genMs;
+    double buildMs;
+    double gpuMs;
+    double mraysPerSecond;
+    uint64_t memoryBytes;
+} BenchResult;
+
+typedef struct BenchReport {
+    char device[256];
+    uint32_t width;
+    uint32_t height;
+    uint32_t frames;
+    BenchResult *results;
+    uint32_t count;
+} BenchReport;
+
+// One case per line, so the reader only has to understand files this writer produced.
+int gbbWriteBenchReport(const char* path, const BenchReport* report);
+int gbbReadBenchReport(const char* path, BenchReport* report);
+void gbbFreeBenchReport(BenchReport* report);
+uint32_t gbbCompareBenchReports(const BenchReport* baseline, const BenchReport* current, double tolerance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
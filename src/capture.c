@@ -0,0 +1,311 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "capture.h"
+#include "platform.h"
+
+#define CAPTURE_STOP_FRAME 0xffffffffu
+#define PNG_STORED_BLOCK 65535u
+
+static uint32_t captureFormat(const char* path)
+{
+    const char* ext = strrchr(path, '.');
+    if (ext && ((strcmp(ext, ".png") == 0) || (strcmp(ext, ".PNG") == 0))) return CAPTURE_PNG;
+    if (ext && ((strcmp(ext, ".ppm") == 0) || (strcmp(ext, ".PPM") == 0))) return CAPTURE_PPM;
+    return CAPTURE_Y4M;
+}
+
+static void captureFramePath(const Capture* capture, uint32_t frameIndex, char* out, size_t outSize)
+{
+    const char* ext = strrchr(capture->path, '.');
+    const int stemLength = ext ? (int)(ext - capture->path) : (int)strlen(capture->path);
+    snprintf(out, outSize, "%.*s_%06u%s", stemLength, capture->path, frameIndex, ext ? ext : "");
+}
+
+static void captureRgb(const Capture* capture, const uint8_t* texel, uint32_t rgb[3])
+{
+    rgb[0] = texel[(capture->swapRedBlue != 0u) ? 2u : 0u];
+    rgb[1] = texel[1];
+    rgb[2] = texel[(capture->swapRedBlue != 0u) ? 0u : 2u];
+}
+
+// BT.601 studio range at full chroma resolution (C444), which every Y4M reader accepts.
+static int writeY4mFrame(Capture* capture, const uint8_t* pixels)
+{
+    const size_t planeSize = (size_t)capture->width * capture->height;
+    uint8_t* y = capture->scratch;
+    uint8_t* u = y + planeSize;
+    uint8_t* v = u + planeSize;
+    for (size_t i = 0u; i < planeSize; ++i)
+    {
+        uint32_t rgb[3];
+        captureRgb(capture, &pixels[i * 4u], rgb);
+        const int r = (int)rgb[0];
+        const int g = (int)rgb[1];
+        const int b = (int)rgb[2];
+        y[i] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        u[i] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        v[i] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+    if (fputs("FRAME\n", capture->stream) < 0) return 1;
+    return (fwrite(capture->scratch, 1u, planeSize * 3u, capture->stream) == planeSize * 3u) ? 0 : 1;
+}
+
+static int writePpmFrame(Capture* capture, const uint8_t* pixels, const char* path)
+{
+    const size_t texelCount = (size_t)capture->width * capture->height;
+    for (size_t i = 0u; i < texelCount; ++i)
+    {
+        uint32_t rgb[3];
+        captureRgb(capture, &pixels[i * 4u], rgb);
+        capture->scratch[i * 3u + 0u] = (uint8_t)rgb[0];
+        capture->scratch[i * 3u + 1u] = (uint8_t)rgb[1];
+        capture->scratch[i * 3u + 2u] = (uint8_t)rgb[2];
+    }
+    FILE* file = fopen(path, "wb");
+    if (!file) return 1;
+    int result = (fprintf(file, "P6\n%u %u\n255\n", capture->width, capture->height) > 0) ? 0 : 1;
+    if ((result == 0) && (fwrite(capture->scratch, 1u, texelCount * 3u, file) != texelCount * 3u)) result = 1;
+    if (fclose(file) != 0) result = 1;
+    return result;
+}
+
+static uint32_t pngCrc(uint32_t crc, const uint8_t* data, size_t size)
+{
+    static uint32_t table[256];
+    if (table[1] == 0u)
+    {
+        for (uint32_t n = 0u; n < 256u; ++n)
+        {
+            uint32_t c = n;
+            for (uint32_t k = 0u; k < 8u; ++k)
+            {
+                c = (c & 1u) ? (0xedb88320u ^ (c >> 1u)) : (c >> 1u);
+            }
+            table[n] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0u; i < size; ++i)
+    {
+        crc = table[(crc ^ data[i]) & 0xffu] ^ (crc >> 8u);
+    }
+    return ~crc;
+}
+
+static void putBe32(uint8_t* out, uint32_t value)
+{
+    out[0] = (uint8_t)(value >> 24u);
+    out[1] = (uint8_t)(value >> 16u);
+    out[2] = (uint8_t)(value >> 8u);
+    out[3] = (uint8_t)value;
+}
+
+static int writePngChunk(FILE* file, const char type[4], const uint8_t* data, uint32_t size)
+{
+    uint8_t header[8];
+    putBe32(header, size);
+    memcpy(&header[4], type, 4u);
+    uint8_t crc[4];
+    putBe32(crc, pngCrc(pngCrc(0u, &header[4], 4u), data, size));
+    if (fwrite(header, 1u, 8u, file) != 8u) return 1;
+    if ((size > 0u) && (fwrite(data, 1u, size, file) != size)) return 1;
+    return (fwrite(crc, 1u, 4u, file) == 4u) ? 0 : 1;
+}
+
+static size_t pngRawSize(uint32_t width, uint32_t height)
+{
+    return (size_t)height * (1u + (size_t)width * 3u);
+}
+
+static size_t pngZlibSize(size_t rawSize)
+{
+    return 2u + rawSize + 5u * ((rawSize + PNG_STORED_BLOCK - 1u) / PNG_STORED_BLOCK) + 4u;
+}
+
+// Stored (uncompressed) deflate blocks keep the writer thread far ahead of the renderer;
+// recompress offline if disk space matters more than capture rate.
+static int writePngFrame(Capture* capture, const uint8_t* pixels, const char* path)
+{
+    const size_t rawSize = pngRawSize(capture->width, capture->height);
+    uint8_t* raw = capture->scratch;
+    uint8_t* zlib = raw + rawSize;
+    for (uint32_t y = 0u; y < capture->height; ++y)
+    {
+        uint8_t* row = &raw[(size_t)y * (1u + (size_t)capture->width * 3u)];
+        row[0] = 0u;
+        for (uint32_t x = 0u; x < capture->width; ++x)
+        {
+            uint32_t rgb[3];
+            captureRgb(capture, &pixels[((size_t)y * capture->width + x) * 4u], rgb);
+            row[1u + x * 3u + 0u] = (uint8_t)rgb[0];
+            row[1u + x * 3u + 1u] = (uint8_t)rgb[1];
+            row[1u + x * 3u + 2u] = (uint8_t)rgb[2];
+        }
+    }
+
+    size_t zlibSize = 0u;
+    zlib[zlibSize++] = 0x78u;
+    zlib[zlibSize++] = 0x01u;
+    uint32_t adlerA = 1u;
+    uint32_t adlerB = 0u;
+    for (size_t offset = 0u; offset < rawSize; offset += PNG_STORED_BLOCK)
+    {
+        const uint32_t length = (uint32_t)(((rawSize - offset) < PNG_STORED_BLOCK) ? (rawSize - offset) : PNG_STORED_BLOCK);
+        zlib[zlibSize++] = (uint8_t)((offset + length == rawSize) ? 1u : 0u);
+        zlib[zlibSize++] = (uint8_t)length;
+        zlib[zlibSize++] = (uint8_t)(length >> 8u);
+        zlib[zlibSize++] = (uint8_t)~length;
+        zlib[zlibSize++] = (uint8_t)(~length >> 8u);
+        memcpy(&zlib[zlibSize], &raw[offset], length);
+        zlibSize += length;
+        for (uint32_t i = 0u; i < length; ++i)
+        {
+            adlerA += raw[offset + i];
+            if (adlerA >= 65521u) adlerA -= 65521u;
+            adlerB += adlerA;
+            if (adlerB >= 65521u) adlerB -= 65521u;
+        }
+    }
+    putBe32(&zlib[zlibSize], (adlerB << 16u) | adlerA);
+    zlibSize += 4u;
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return 1;
+    static const uint8_t signature[8] = {0x89u, 'P', 'N', 'G', '\r', '\n', 0x1au, '\n'};
+    uint8_t ihdr[13];
+    putBe32(&ihdr[0], capture->width);
+    putBe32(&ihdr[4], capture->height);
+    ihdr[8] = 8u;
+    ihdr[9] = 2u;
+    ihdr[10] = 0u;
+    ihdr[11] = 0u;
+    ihdr[12] = 0u;
+    int result = (fwrite(signature, 1u, sizeof(signature), file) == sizeof(signature)) ? 0 : 1;
+    if (result == 0) result = writePngChunk(file, "IHDR", ihdr, sizeof(ihdr));
+    if (result == 0) result = writePngChunk(file, "IDAT", zlib, (uint32_t)zlibSize);
+    if (result == 0) result = writePngChunk(file, "IEND", NULL, 0u);
+    if (fclose(file) != 0) result = 1;
+    return result;
+}
+
+static void captureWriterMain(void* user)
+{
+    Capture* capture = (Capture*)user;
+    for (;;)
+    {
+        gbbWaitSemaphore(capture->filledSlots);
+        const uint32_t slot = capture->tail % capture->slotCount;
+        const uint32_t frameIndex = capture->slotFrames[slot];
+        if (frameIndex == CAPTURE_STOP_FRAME) break;
+
+        int result = 0;
+        if (capture->format == CAPTURE_Y4M)
+        {
+            result = writeY4mFrame(capture, capture->slotPixels[slot]);
+        }
+        else
+        {
+            char path[600];
+            captureFramePath(capture, frameIndex, path, sizeof(path));
+            result = (capture->format == CAPTURE_PNG)
+                ? writePngFrame(capture, capture->slotPixels[slot], path)
+                : writePpmFrame(capture, capture->slotPixels[slot], path);
+        }
+        if (result == 0) capture->written += 1u;
+        else capture->failed += 1u;
+
+        capture->tail += 1u;
+        gbbSignalSemaphore(capture->freeSlots);
+    }
+}
+
+int gbbStartCapture(Capture* capture, const char* path, uint32_t width, uint32_t height, uint32_t swapRedBlue,
+                    void* const* slotPixels, uint32_t slotCount)
+{
+    memset(capture, 0, sizeof(*capture));
+    if ((slotCount == 0u) || (slotCount > CAPTURE_MAX_SLOTS)) return 1;
+    if (strlen(path) >= sizeof(capture->path)) return 1;
+    memcpy(capture->path, path, strlen(path) + 1u);
+    capture->format = captureFormat(path);
+    capture->width = width;
+    capture->height = height;
+    capture->swapRedBlue = swapRedBlue;
+    capture->slotCount = slotCount;
+    for (uint32_t i = 0u; i < slotCount; ++i)
+    {
+        capture->slotPixels[i] = (const uint8_t*)slotPixels[i];
+    }
+
+    const size_t rawSize = pngRawSize(width, height);
+    capture->scratchSize = (capture->format == CAPTURE_PNG) ? (rawSize + pngZlibSize(rawSize))
+                                                            : ((size_t)width * height * 3u);
+    capture->scratch = (uint8_t*)malloc(capture->scratchSize);
+    if (!capture->scratch) return 1;
+
+    if (capture->format == CAPTURE_Y4M)
+    {
+        capture->stream = fopen(path, "wb");
+        if (!capture->stream ||
+            (fprintf(capture->stream, "YUV4MPEG2 W%u H%u F60:1 Ip A1:1 C444\n", width, height) <= 0))
+        {
+            if (capture->stream) fclose(capture->stream);
+            free(capture->scratch);
+            memset(capture, 0, sizeof(*capture));
+            return 1;
+        }
+    }
+
+    capture->freeSlots = gbbCreateSemaphore(slotCount);
+    capture->filledSlots = gbbCreateSemaphore(0u);
+    capture->thread = (capture->freeSlots && capture->filledSlots) ? gbbCreateThread(captureWriterMain, capture) : NULL;
+    if (!capture->thread)
+    {
+        gbbDestroySemaphore(capture->freeSlots);
+        gbbDestroySemaphore(capture->filledSlots);
+        if (capture->stream) fclose(capture->stream);
+        free(capture->scratch);
+        memset(capture, 0, sizeof(*capture));
+        return 1;
+    }
+    return 0;
+}
+
+// Slots are handed out in ring order and must be submitted in the same order.
+int gbbAcquireCaptureSlot(Capture* capture, uint32_t* slot)
+{
+    if (!capture->thread) return 0;
+    if (gbbTryWaitSemaphore(capture->freeSlots) == 0)
+    {
+        capture->dropped += 1u;
+        return 0;
+    }
+    *slot = capture->head % capture->slotCount;
+    capture->head += 1u;
+    return 1;
+}
+
+// Call once the GPU copy into the slot has completed (its fence has signaled).
+void gbbSubmitCaptureSlot(Capture* capture, uint32_t slot, uint32_t frameIndex)
+{
+    capture->slotFrames[slot] = frameIndex;
+    gbbSignalSemaphore(capture->filledSlots);
+}
+
+// Drains every submitted frame before joining the writer.
+void gbbStopCapture(Capture* capture)
+{
+    if (!capture->thread) return;
+    gbbWaitSemaphore(capture->freeSlots);
+    capture->slotFrames[capture->head % capture->slotCount] = CAPTURE_STOP_FRAME;
+    capture->head += 1u;
+    gbbSignalSemaphore(capture->filledSlots);
+    gbbJoinThread(capture->thread);
+    gbbDestroySemaphore(capture->freeSlots);
+    gbbDestroySemaphore(capture->filledSlots);
+    if (capture->stream) fclose(capture->stream);
+    free(capture->scratch);
+    capture->thread = NULL;
+    capture->stream = NULL;
+    capture->scratch = NULL;
+}
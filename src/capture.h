@@ -0,0 +1,58 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    CAPTURE_Y4M = 0u,
+    CAPTURE_PNG = 1u,
+    CAPTURE_PPM = 2u,
+};
+
+#define CAPTURE_MAX_SLOTS 8u
+
+// Hands rendered frames to a writer thread through a ring of caller-owned buffers
+// (host-visible readback memory in practice). The render thread never blocks: when the
+// writer is behind and every slot is queued, the frame is dropped and counted.
+// .y4m paths get one 4:4:4 stream; .png and .ppm paths get one file per frame with the
+// frame number inserted before the extension.
+typedef struct Capture {
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t swapRedBlue;
+    char path[512];
+    FILE *stream;
+    uint8_t *scratch;
+    size_t scratchSize;
+    const uint8_t *slotPixels[CAPTURE_MAX_SLOTS];
+    uint32_t slotFrames[CAPTURE_MAX_SLOTS];
+    uint32_t slotCount;
+    uint32_t head;
+    uint32_t tail;
+    void *freeSlots;
+    void *filledSlots;
+    void *thread;
+    uint32_t written;
+    uint32_t dropped;
+    uint32_t failed;
+} Capture;
+
+// pixels are width * height tightly packed 8-bit RGBA (BGRA when swapRedBlue is set).
+int gbbStartCapture(Capture* capture, const char* path, uint32_t width, uint32_t height, uint32_t swapRedBlue,
+                    void* const* slotPixels, uint32_t slotCount);
+int gbbAcquireCaptureSlot(Capture* capture, uint32_t* slot);
+void gbbSubmitCaptureSlot(Capture* capture, uint32_t slot, uint32_t frameIndex);
+void gbbStopCapture(Capture* capture);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
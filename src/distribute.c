@@ -0,0 +1,508 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "distribute.h"
+#include "image_file.h"
+#include "platform.h"
+
+#define DISTRIBUTE_ACCEPT_POLL_MS 250u
+#define DISTRIBUTE_CONNECT_TIMEOUT_NS 60000000000ull
+#define DISTRIBUTE_RETRY_CAPACITY (DISTRIBUTE_WINDOW * DISTRIBUTE_MAX_WORKERS)
+
+// Work items are (tile, sample chunk) pairs numbered tile-major. Each worker owns a
+// contiguous item range and takes from its front; a worker whose range runs dry steals
+// the back half of the largest range left, the unclaimed range 0 included, so early
+// finishers pick up the slow workers' tails while most tiles stay with one worker.
+// Items a failed worker had in flight go to the retry list, which is served first; a
+// worker with nothing left to take waits on wake until a retry appears or the image is
+// done, and only then is it sent the done marker.
+typedef struct Coordinator {
+    const CoordinatorDesc *desc;
+    ImageFile file;
+    uint32_t floatOutput;
+    uint32_t tilesX;
+    uint32_t tileCount;
+    uint32_t chunksPerTile;
+    uint32_t itemCount;
+    void *lock;
+    void *wake;
+    uint32_t waiting;
+    uint32_t ranges[DISTRIBUTE_MAX_WORKERS + 1u][2];
+    uint32_t retry[DISTRIBUTE_RETRY_CAPACITY];
+    uint32_t retryCount;
+    float **partials;
+    uint32_t *chunksDone;
+    uint8_t *texels;
+    uint32_t itemsDone;
+    uint32_t writeFailed;
+    uint32_t sceneHash[2];
+    uint32_t haveSceneHash;
+} Coordinator;
+
+typedef struct CoordinatorWorker {
+    Coordinator *coordinator;
+    void *stream;
+    void *thread;
+    uint32_t index;
+    uint32_t items;
+    uint32_t stolen;
+    uint32_t inFlight[DISTRIBUTE_WINDOW];
+    uint32_t inFlightCount;
+    int result;
+    char device[64];
+} CoordinatorWorker;
+
+static void lockCoordinator(Coordinator* coordinator)
+{
+    gbbWaitSemaphore(coordinator->lock);
+}
+
+static void unlockCoordinator(Coordinator* coordinator)
+{
+    gbbSignalSemaphore(coordinator->lock);
+}
+
+// Called with the lock held.
+static void wakeWaitingWorkers(Coordinator* coordinator)
+{
+    for (; coordinator->waiting > 0u; --coordinator->waiting)
+    {
+        gbbSignalSemaphore(coordinator->wake);
+    }
+}
+
+// Called with the lock held.
+static int takeItem(Coordinator* coordinator, CoordinatorWorker* worker, uint32_t* item)
+{
+    if (coordinator->retryCount > 0u)
+    {
+        *item = coordinator->retry[--coordinator->retryCount];
+        return 1;
+    }
+    uint32_t* own = coordinator->ranges[worker->index + 1u];
+    if (own[0] == own[1])
+    {
+        uint32_t victim = 0u;
+        uint32_t victimSize = 0u;
+        for (uint32_t i = 0u; i <= DISTRIBUTE_MAX_WORKERS; ++i)
+        {
+            const uint32_t size = coordinator->ranges[i][1] - coordinator->ranges[i][0];
+            if (size > victimSize)
+            {
+                victim = i;
+                victimSize = size;
+            }
+        }
+        if (victimSize == 0u) return 0;
+        uint32_t* range = coordinator->ranges[victim];
+        const uint32_t middle = range[0] + victimSize / 2u;
+        own[0] = middle;
+        own[1] = range[1];
+        range[1] = middle;
+        if (victim != 0u) worker->stolen += own[1] - own[0];
+    }
+    *item = own[0]++;
+    return 1;
+}
+
+static void describeItem(const Coordinator* coordinator, uint32_t item, DistributeAssignment* assignment)
+{
+    const uint32_t chunk = item % coordinator->chunksPerTile;
+    const uint32_t sampleChunk = coordinator->desc->sampleChunk;
+    assignment->tile = item / coordinator->chunksPerTile;
+    assignment->sampleBegin = chunk * sampleChunk;
+    assignment->sampleEnd = (coordinator->desc->samples - assignment->sampleBegin < sampleChunk)
+                                ? coordinator->desc->samples
+                                : (assignment->sampleBegin + sampleChunk);
+}
+
+static void tileRect(const Coordinator* coordinator, uint32_t tile, uint32_t rect[4])
+{
+    const uint32_t tileSize = coordinator->desc->tileSize;
+    rect[0] = (tile % coordinator->tilesX) * tileSize;
+    rect[1] = (tile / coordinator->tilesX) * tileSize;
+    rect[2] = (coordinator->desc->width - rect[0] < tileSize) ? (coordinator->desc->width - rect[0]) : tileSize;
+    rect[3] = (coordinator->desc->height - rect[1] < tileSize) ? (coordinator->desc->height - rect[1]) : tileSize;
+}
+
+// Called with the lock held. PPM tiles are resolved the way the shader resolves them:
+// sum / count, clamped and rounded to 8 bits.
+static void writeTile(Coordinator* coordinator, uint32_t tile, const float* texels)
+{
+    uint32_t rect[4];
+    tileRect(coordinator, tile, rect);
+    const size_t texelCount = (size_t)rect[2] * rect[3];
+    int result = 0;
+    if (coordinator->floatOutput != 0u)
+    {
+        result = gbbWriteImageTile(&coordinator->file, rect[0], rect[1], rect[2], rect[3], texels, (size_t)rect[2] * 16u);
+    }
+    else
+    {
+        for (size_t i = 0u; i < texelCount; ++i)
+        {
+            const float weight = texels[i * 4u + 3u];
+            for (uint32_t c = 0u; c < 4u; ++c)
+            {
+                float value = (c == 3u) ? 1.0f : ((weight > 0.0f) ? (texels[i * 4u + c] / weight) : 0.0f);
+                value = (value < 0.0f) ? 0.0f : ((value > 1.0f) ? 1.0f : value);
+                coordinator->texels[i * 4u + c] = (uint8_t)(value * 255.0f + 0.5f);
+            }
+        }
+        result = gbbWriteImageTile(&coordinator->file, rect[0], rect[1], rect[2], rect[3], coordinator->texels, (size_t)rect[2] * 4u);
+    }
+    if (result != 0) coordinator->writeFailed = 1u;
+}
+
+// Called with the lock held; takes ownership of texels.
+static void storeResult(Coordinator* coordinator, uint32_t item, float* texels)
+{
+    const uint32_t tile = item / coordinator->chunksPerTile;
+    coordinator->itemsDone += 1u;
+    if (coordinator->itemsDone == coordinator->itemCount) wakeWaitingWorkers(coordinator);
+    if (coordinator->chunksPerTile == 1u)
+    {
+        writeTile(coordinator, tile, texels);
+        free(texels);
+        return;
+    }
+    coordinator->partials[item] = texels;
+    coordinator->chunksDone[tile] += 1u;
+    if (coordinator->chunksDone[tile] < coordinator->chunksPerTile) return;
+
+    uint32_t rect[4];
+    tileRect(coordinator, tile, rect);
+    const size_t floatCount = (size_t)rect[2] * rect[3] * 4u;
+    float* sum = coordinator->partials[tile * coordinator->chunksPerTile];
+    for (uint32_t chunk = 1u; chunk < coordinator->chunksPerTile; ++chunk)
+    {
+        float* partial = coordinator->partials[tile * coordinator->chunksPerTile + chunk];
+        for (size_t i = 0u; i < floatCount; ++i)
+        {
+            sum[i] += partial[i];
+        }
+        free(partial);
+        coordinator->partials[tile * coordinator->chunksPerTile + chunk] = NULL;
+    }
+    writeTile(coordinator, tile, sum);
+    free(sum);
+    coordinator->partials[tile * coordinator->chunksPerTile] = NULL;
+}
+
+// Sends the done marker only once every item is rendered. Until then a worker that finds
+// nothing to take is told to idle, and once its results are in waits for another worker
+// to fail or for the last result to arrive.
+static int sendNextAssignments(CoordinatorWorker* worker, uint32_t* doneSent, uint32_t* idleSent)
+{
+    Coordinator* coordinator = worker->coordinator;
+    while ((*doneSent == 0u) && (worker->inFlightCount < DISTRIBUTE_WINDOW))
+    {
+        if (*idleSent != 0u)
+        {
+            if (worker->inFlightCount > 0u) return 0;
+            *idleSent = 0u;
+        }
+        DistributeAssignment assignment = {DISTRIBUTE_DONE, 0u, 0u};
+        uint32_t item = 0u;
+        lockCoordinator(coordinator);
+        const int haveItem = takeItem(coordinator, worker, &item);
+        const uint32_t finished = (uint32_t)(coordinator->itemsDone == coordinator->itemCount);
+        if (haveItem != 0)
+        {
+            worker->inFlight[worker->inFlightCount++] = item;
+        }
+        else if ((finished == 0u) && (worker->inFlightCount == 0u))
+        {
+            coordinator->waiting += 1u;
+        }
+        unlockCoordinator(coordinator);
+        if ((haveItem == 0) && (finished == 0u))
+        {
+            if (worker->inFlightCount == 0u)
+            {
+                gbbWaitSemaphore(coordinator->wake);
+                continue;
+            }
+            assignment.tile = DISTRIBUTE_IDLE;
+            *idleSent = 1u;
+        }
+        else if (haveItem != 0)
+        {
+            describeItem(coordinator, item, &assignment);
+        }
+        else
+        {
+            *doneSent = 1u;
+        }
+        if (gbbSendAll(worker->stream, &assignment, sizeof(assignment)) != 0) return 1;
+    }
+    return 0;
+}
+
+static int serveWorker(CoordinatorWorker* worker)
+{
+    Coordinator* coordinator = worker->coordinator;
+    DistributeHello hello;
+    if (gbbRecvAll(worker->stream, &hello, sizeof(hello)) != 0) return 1;
+    hello.device[sizeof(hello.device) - 1u] = '\0';
+    memcpy(worker->device, hello.device, sizeof(worker->device));
+    if ((hello.magic != DISTRIBUTE_MAGIC) || (hello.version != DISTRIBUTE_VERSION))
+    {
+        fprintf(stderr, "distribute: worker %u speaks a different protocol, rejected\n", worker->index);
+        return 1;
+    }
+    lockCoordinator(coordinator);
+    if (coordinator->haveSceneHash == 0u)
+    {
+        memcpy(coordinator->sceneHash, hello.sceneHash, sizeof(coordinator->sceneHash));
+        coordinator->haveSceneHash = 1u;
+    }
+    const int sameScene = (memcmp(coordinator->sceneHash, hello.sceneHash, sizeof(coordinator->sceneHash)) == 0);
+    unlockCoordinator(coordinator);
+    if (sameScene == 0)
+    {
+        fprintf(stderr, "distribute: worker %u (%s) loaded a different scene, rejected\n", worker->index, worker->device);
+        return 1;
+    }
+
+    const CoordinatorDesc* desc = coordinator->desc;
+    const DistributeJob job = {
+        .magic = DISTRIBUTE_MAGIC,
+        .width = desc->width,
+        .height = desc->height,
+        .samples = desc->samples,
+        .tileSize = desc->tileSize,
+        .sampleChunk = desc->sampleChunk,
+    };
+    if (gbbSendAll(worker->stream, &job, sizeof(job)) != 0) return 1;
+
+    uint32_t doneSent = 0u;
+    uint32_t idleSent = 0u;
+    if (sendNextAssignments(worker, &doneSent, &idleSent) != 0) return 1;
+    while (worker->inFlightCount > 0u)
+    {
+        DistributeResult header;
+        if (gbbRecvAll(worker->stream, &header, sizeof(header)) != 0) return 1;
+        DistributeAssignment expected;
+        describeItem(coordinator, worker->inFlight[0], &expected);
+        uint32_t rect[4];
+        tileRect(coordinator, expected.tile, rect);
+        if ((header.tile != expected.tile) || (header.sampleBegin != expected.sampleBegin) ||
+            (header.sampleEnd != expected.sampleEnd) || (header.width != rect[2]) || (header.height != rect[3]))
+        {
+            fprintf(stderr, "distribute: worker %u returned tile %u, expected %u\n", worker->index, header.tile, expected.tile);
+            return 1;
+        }
+        const size_t size = (size_t)rect[2] * rect[3] * 16u;
+        float* texels = (float*)malloc(size);
+        if (!texels) return 1;
+        if (gbbRecvAll(worker->stream, texels, size) != 0)
+        {
+            free(texels);
+            return 1;
+        }
+
+        lockCoordinator(coordinator);
+        storeResult(coordinator, worker->inFlight[0], texels);
+        unlockCoordinator(coordinator);
+        worker->items += 1u;
+        worker->inFlightCount -= 1u;
+        memmove(&worker->inFlight[0], &worker->inFlight[1], worker->inFlightCount * sizeof(uint32_t));
+        if (sendNextAssignments(worker, &doneSent, &idleSent) != 0) return 1;
+    }
+    return 0;
+}
+
+static void workerThreadMain(void* user)
+{
+    CoordinatorWorker* worker = (CoordinatorWorker*)user;
+    worker->result = serveWorker(worker);
+    gbbCloseSocket(worker->stream);
+    worker->stream = NULL;
+    if ((worker->result != 0) && (worker->inFlightCount > 0u))
+    {
+        Coordinator* coordinator = worker->coordinator;
+        lockCoordinator(coordinator);
+        for (uint32_t i = 0u; i < worker->inFlightCount; ++i)
+        {
+            coordinator->retry[coordinator->retryCount++] = worker->inFlight[i];
+        }
+        wakeWaitingWorkers(coordinator);
+        unlockCoordinator(coordinator);
+        fprintf(stderr, "distribute: worker %u failed, %u items requeued\n", worker->index, worker->inFlightCount);
+        worker->inFlightCount = 0u;
+    }
+}
+
+static uint32_t coordinatorFinished(Coordinator* coordinator)
+{
+    lockCoordinator(coordinator);
+    const uint32_t finished = (uint32_t)(coordinator->itemsDone == coordinator->itemCount);
+    unlockCoordinator(coordinator);
+    return finished;
+}
+
+static void* spawnLocalWorker(const CoordinatorDesc* desc, uint16_t port, uint32_t index)
+{
+    char address[32];
+    char device[16];
+    snprintf(address, sizeof(address), "127.0.0.1:%u", (unsigned)port);
+    snprintf(device, sizeof(device), "%u", (desc->deviceCount > 0u) ? (index % desc->deviceCount) : 0u);
+    const char** argv = (const char**)malloc((desc->workerArgCount + 5u) * sizeof(const char*));
+    if (!argv) return NULL;
+    memcpy(argv, desc->workerArgs, desc->workerArgCount * sizeof(const char*));
+    argv[desc->workerArgCount + 0u] = "--worker";
+    argv[desc->workerArgCount + 1u] = address;
+    argv[desc->workerArgCount + 2u] = "--device";
+    argv[desc->workerArgCount + 3u] = device;
+    argv[desc->workerArgCount + 4u] = NULL;
+    void* process = gbbSpawnProcess(argv);
+    free(argv);
+    return process;
+}
+
+int gbbRunCoordinator(const CoordinatorDesc* desc)
+{
+    const uint32_t expectedWorkers = desc->localWorkers + desc->remoteWorkers;
+    if ((expectedWorkers == 0u) || (expectedWorkers > DISTRIBUTE_MAX_WORKERS))
+    {
+        fprintf(stderr, "distribute: between 1 and %u workers are supported\n", DISTRIBUTE_MAX_WORKERS);
+        return 1;
+    }
+    Coordinator* coordinator = (Coordinator*)calloc(1u, sizeof(Coordinator));
+    CoordinatorWorker* workers = (CoordinatorWorker*)calloc(expectedWorkers, sizeof(CoordinatorWorker));
+    void** processes = (void**)calloc(desc->localWorkers + 1u, sizeof(void*));
+    if (!coordinator || !workers || !processes)
+    {
+        free(coordinator);
+        free(workers);
+        free(processes);
+        return 1;
+    }
+    coordinator->desc = desc;
+    coordinator->tilesX = (desc->width + desc->tileSize - 1u) / desc->tileSize;
+    coordinator->tileCount = coordinator->tilesX * ((desc->height + desc->tileSize - 1u) / desc->tileSize);
+    coordinator->chunksPerTile = (desc->samples + desc->sampleChunk - 1u) / desc->sampleChunk;
+    coordinator->itemCount = coordinator->tileCount * coordinator->chunksPerTile;
+    coordinator->ranges[0][1] = coordinator->itemCount;
+    coordinator->lock = gbbCreateSemaphore(1u);
+    coordinator->wake = gbbCreateSemaphore(0u);
+    coordinator->texels = (uint8_t*)malloc((size_t)desc->tileSize * desc->tileSize * 4u);
+    coordinator->chunksDone = (uint32_t*)calloc(coordinator->tileCount, sizeof(uint32_t));
+    coordinator->partials = (float**)calloc(coordinator->itemCount, sizeof(float*));
+
+    int result = 0;
+    void* listener = NULL;
+    uint16_t port = 0u;
+    uint32_t fileOpen = 0u;
+    if (!coordinator->lock || !coordinator->wake || !coordinator->texels || !coordinator->chunksDone || !coordinator->partials)
+    {
+        result = 1;
+    }
+    else if (gbbOpenImageFile(&coordinator->file, desc->path, desc->width, desc->height) != 0)
+    {
+        fprintf(stderr, "failed to open %s\n", desc->path);
+        result = 1;
+    }
+    else
+    {
+        fileOpen = 1u;
+        coordinator->floatOutput = (uint32_t)(coordinator->file.format == IMAGE_FILE_PFM);
+        listener = gbbListenSocket(desc->port, (uint32_t)(desc->remoteWorkers == 0u), &port);
+        if (!listener)
+        {
+            fprintf(stderr, "distribute: cannot listen on port %u\n", (unsigned)desc->port);
+            result = 1;
+        }
+    }
+
+    const uint64_t start = gbbGetTimeNs();
+    uint32_t connected = 0u;
+    if (result == 0)
+    {
+        printf("distribute: %u tiles x %u sample chunks, waiting for %u workers on port %u\n", coordinator->tileCount,
+               coordinator->chunksPerTile, expectedWorkers, (unsigned)port);
+        for (uint32_t i = 0u; i < desc->localWorkers; ++i)
+        {
+            processes[i] = spawnLocalWorker(desc, port, i);
+            if (!processes[i]) fprintf(stderr, "distribute: failed to start local worker %u\n", i);
+        }
+        // Stops waiting once the image is done, so workers that never show up only cost
+        // the time it took the others to render it.
+        while ((connected < expectedWorkers) && (coordinatorFinished(coordinator) == 0u))
+        {
+            void* stream = gbbAcceptSocket(listener, DISTRIBUTE_ACCEPT_POLL_MS);
+            if (!stream)
+            {
+                if ((connected == 0u) && (gbbGetTimeNs() - start > DISTRIBUTE_CONNECT_TIMEOUT_NS))
+                {
+                    fprintf(stderr, "distribute: no worker connected\n");
+                    break;
+                }
+                continue;
+            }
+            CoordinatorWorker* worker = &workers[connected];
+            worker->coordinator = coordinator;
+            worker->stream = stream;
+            worker->index = connected;
+            worker->thread = gbbCreateThread(workerThreadMain, worker);
+            if (!worker->thread)
+            {
+                gbbCloseSocket(stream);
+                continue;
+            }
+            connected += 1u;
+        }
+    }
+    for (uint32_t i = 0u; i < connected; ++i)
+    {
+        gbbJoinThread(workers[i].thread);
+    }
+    gbbCloseSocket(listener);
+    for (uint32_t i = 0u; i < desc->localWorkers; ++i)
+    {
+        if (processes[i] && (gbbWaitProcess(processes[i]) != 0)) fprintf(stderr, "distribute: local worker %u failed\n", i);
+    }
+
+    if (result == 0)
+    {
+        const double seconds = (double)(gbbGetTimeNs() - start) * 1e-9;
+        for (uint32_t i = 0u; i < connected; ++i)
+        {
+            const CoordinatorWorker* worker = &workers[i];
+            printf("distribute: worker %u (%s): %u items, %u stolen%s\n", i, worker->device, worker->items, worker->stolen,
+                   (worker->result != 0) ? ", failed" : "");
+        }
+        if (coordinator->itemsDone != coordinator->itemCount)
+        {
+            fprintf(stderr, "distribute: only %u of %u items rendered\n", coordinator->itemsDone, coordinator->itemCount);
+            result = 1;
+        }
+        if (coordinator->writeFailed != 0u) result = 1;
+        if (gbbCloseImageFile(&coordinator->file) != 0) result = 1;
+        fileOpen = 0u;
+        printf("distribute %ux%u, %u spp over %u workers in %.2f s (%.1f Msamples/s) -> %s%s\n", desc->width, desc->height,
+               desc->samples, connected, seconds,
+               (seconds > 0.0) ? ((double)desc->width * desc->height * desc->samples * 1e-6 / seconds) : 0.0, desc->path,
+               (result != 0) ? " (incomplete)" : "");
+    }
+
+    if (fileOpen != 0u) gbbCloseImageFile(&coordinator->file);
+    if (coordinator->partials)
+    {
+        for (uint32_t i = 0u; i < coordinator->itemCount; ++i)
+        {
+            free(coordinator->partials[i]);
+        }
+    }
+    free(coordinator->partials);
+    free(coordinator->chunksDone);
+    free(coordinator->texels);
+    gbbDestroySemaphore(coordinator->wake);
+    gbbDestroySemaphore(coordinator->lock);
+    free(coordinator);
+    free(workers);
+    free(processes);
+    return result;
+}
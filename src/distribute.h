@@ -0,0 +1,85 @@
+#ifndef DISTRIBUTE_H
+#define DISTRIBUTE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DISTRIBUTE_MAGIC 0x44424247u
+#define DISTRIBUTE_VERSION 2u
+#define DISTRIBUTE_DONE 0xffffffffu
+#define DISTRIBUTE_IDLE 0xfffffffeu
+#define DISTRIBUTE_WINDOW 2u
+#define DISTRIBUTE_MAX_WORKERS 64u
+
+// Distributed batch render protocol. A worker connects and sends a hello; the
+// coordinator answers with the job, then keeps up to DISTRIBUTE_WINDOW assignments in
+// flight, sending one more (or the idle or done marker) per result it receives. Fields
+// are native-endian; a magic that reads back swapped rejects a mismatched peer.
+typedef struct DistributeHello {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sceneHash[2];
+    char device[64];
+} DistributeHello;
+
+typedef struct DistributeJob {
+    uint32_t magic;
+    uint32_t width;
+    uint32_t height;
+    uint32_t samples;
+    uint32_t tileSize;
+    uint32_t sampleChunk;
+} DistributeJob;
+
+// tile is DISTRIBUTE_DONE once every item of the job is rendered. DISTRIBUTE_IDLE means
+// nothing is left to take while other workers still render: the worker sends the results
+// it has in flight and only then reads its next assignment, which may be a retried item
+// or the done marker.
+typedef struct DistributeAssignment {
+    uint32_t tile;
+    uint32_t sampleBegin;
+    uint32_t sampleEnd;
+} DistributeAssignment;
+
+// Followed by width * height RGBA32F texels holding the radiance sum of the range, with
+// the sample count in alpha.
+typedef struct DistributeResult {
+    uint32_t tile;
+    uint32_t sampleBegin;
+    uint32_t sampleEnd;
+    uint32_t width;
+    uint32_t height;
+} DistributeResult;
+
+typedef struct CoordinatorDesc {
+    const char *path;
+    uint32_t width;
+    uint32_t height;
+    uint32_t samples;
+    uint32_t tileSize;
+    uint32_t sampleChunk;
+    uint32_t localWorkers;
+    uint32_t remoteWorkers;
+    uint16_t port;
+    // Arguments that make a copy of this process load the same scene; local worker i
+    // runs them with --worker 127.0.0.1:<port> --device <i % deviceCount> appended.
+    // deviceCount 0 puts every local worker on device 0.
+    const char *const *workerArgs;
+    uint32_t workerArgCount;
+    uint32_t deviceCount;
+} CoordinatorDesc;
+
+// Splits the image into tiles and each tile's samples into sampleChunk ranges, hands
+// them to the workers and writes the finished tiles to path. Partial ranges are summed
+// in sample order, so the output does not depend on how many workers took part or
+// which of them rendered what.
+int gbbRunCoordinator(const CoordinatorDesc* desc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
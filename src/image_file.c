@@ -0,0 +1,107 @@
+#if !defined(_WIN32)
+#define _FILE_OFFSET_BITS 64
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "image_file.h"
+
+static int seekImageFile(FILE *file, uint64_t offset)
+{
+#if defined(_WIN32)
+    return _fseeki64(file, (long long)offset, SEEK_SET);
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET);
+#endif
+}
+
+static uint32_t imageFileFormat(const char* path)
+{
+    const char* ext = strrchr(path, '.');
+    if (ext && ((strcmp(ext, ".pfm") == 0) || (strcmp(ext, ".PFM") == 0))) return IMAGE_FILE_PFM;
+    return IMAGE_FILE_PPM;
+}
+
+static uint32_t imageFileTexelSize(const ImageFile* image)
+{
+    return (image->format == IMAGE_FILE_PFM) ? (uint32_t)(3u * sizeof(float)) : 3u;
+}
+
+// PFM rows run bottom to top; a negative scale marks little-endian floats.
+int gbbOpenImageFile(ImageFile* image, const char* path, uint32_t width, uint32_t height)
+{
+    memset(image, 0, sizeof(*image));
+    image->format = imageFileFormat(path);
+    image->width = width;
+    image->height = height;
+    image->row = malloc((size_t)width * imageFileTexelSize(image));
+    image->file = fopen(path, "wb");
+    if (!image->file || !image->row)
+    {
+        gbbCloseImageFile(image);
+        return 1;
+    }
+
+    int headerSize = (image->format == IMAGE_FILE_PFM)
+        ? fprintf(image->file, "PF\n%u %u\n-1.0\n", width, height)
+        : fprintf(image->file, "P6\n%u %u\n255\n", width, height);
+    if (headerSize <= 0)
+    {
+        gbbCloseImageFile(image);
+        return 1;
+    }
+    image->dataOffset = (uint64_t)headerSize;
+    return 0;
+}
+
+int gbbWriteImageTile(ImageFile* image, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                      const void* pixels, size_t rowPitch)
+{
+    if ((x + width > image->width) || (y + height > image->height)) return 1;
+    const uint64_t texelSize = imageFileTexelSize(image);
+    for (uint32_t row = 0u; row < height; ++row)
+    {
+        const uint8_t *src = (const uint8_t *)pixels + (size_t)row * rowPitch;
+        uint32_t fileRow = y + row;
+        if (image->format == IMAGE_FILE_PFM)
+        {
+            const float *texels = (const float *)src;
+            float *dst = (float *)image->row;
+            for (uint32_t i = 0u; i < width; ++i)
+            {
+                const float weight = texels[i * 4u + 3u];
+                const float scale = (weight > 0.0f) ? (1.0f / weight) : 0.0f;
+                dst[i * 3u + 0u] = texels[i * 4u + 0u] * scale;
+                dst[i * 3u + 1u] = texels[i * 4u + 1u] * scale;
+                dst[i * 3u + 2u] = texels[i * 4u + 2u] * scale;
+            }
+            fileRow = image->height - 1u - fileRow;
+        }
+        else
+        {
+            uint8_t *dst = (uint8_t *)image->row;
+            for (uint32_t i = 0u; i < width; ++i)
+            {
+                dst[i * 3u + 0u] = src[i * 4u + 0u];
+                dst[i * 3u + 1u] = src[i * 4u + 1u];
+                dst[i * 3u + 2u] = src[i * 4u + 2u];
+            }
+        }
+
+        const uint64_t offset = image->dataOffset + ((uint64_t)fileRow * image->width + x) * texelSize;
+        if (seekImageFile(image->file, offset) != 0) return 1;
+        if (fwrite(image->row, (size_t)texelSize, width, image->file) != width) return 1;
+    }
+    return 0;
+}
+
+int gbbCloseImageFile(ImageFile* image)
+{
+    int result = 0;
+    if (image->file && (fclose(image->file) != 0)) result = 1;
+    free(image->row);
+    memset(image, 0, sizeof(*image));
+    return result;
+}
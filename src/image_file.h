@@ -0,0 +1,38 @@
+#ifndef IMAGE_FILE_H
+#define IMAGE_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    IMAGE_FILE_PPM = 0u,
+    IMAGE_FILE_PFM = 1u,
+};
+
+// Streams an image to disk tile by tile with 64-bit seeks, so only one tile row is
+// ever buffered. PPM takes RGBA8 tiles; PFM takes RGBA32F tiles whose alpha holds the
+// accumulated sample weight, which is divided out on write.
+typedef struct ImageFile {
+    FILE *file;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint64_t dataOffset;
+    void *row;
+} ImageFile;
+
+int gbbOpenImageFile(ImageFile* image, const char* path, uint32_t width, uint32_t height);
+int gbbWriteImageTile(ImageFile* image, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                      const void* pixels, size_t rowPitch);
+int gbbCloseImageFile(ImageFile* image);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+static uint8_t key_states[GBB_KEY_COUNT] = {0u};
+static float mouse_wheel_delta = 0.0f;
+static uint64_t pending_input_time = 0u;
+
+static const GbbInputEvent* script_events = NULL;
+static uint32_t script_count = 0u;
+static uint32_t script_cursor = 0u;
+static uint64_t script_start = 0u;
+static uint64_t script_loop = 0u;
+
+// Latency is measured from the oldest event the next frame has not seen yet.
+static void gbbStampInput(uint64_t timeNs)
+{
+    if ((pending_input_time == 0u) || (timeNs < pending_input_time)) pending_input_time = timeNs;
+}
+
+void gbbPostKeyEvent(uint32_t key, int down, uint64_t timeNs)
+{
+    if (key >= GBB_KEY_COUNT) return;
+    const uint8_t state = (down != 0) ? 1u : 0u;
+    // Auto-repeat does not change what the next frame renders, so it is not stamped.
+    if (key_states[key] == state) return;
+    key_states[key] = state;
+    gbbStampInput(timeNs);
+}
+
+void gbbPostMouseWheel(float delta, uint64_t timeNs)
+{
+    if (delta == 0.0f) return;
+    mouse_wheel_delta += delta;
+    gbbStampInput(timeNs);
+}
+
+int gbbIsKeyDown(uint32_t key)
+{
+    if (key >= GBB_KEY_COUNT) return 0;
+    return (int)key_states[key];
+}
+
+void gbbConsumeMouseWheel(float* delta)
+{
+    if (delta) *delta = mouse_wheel_delta;
+    mouse_wheel_delta = 0.0f;
+}
+
+int gbbConsumeInputTime(uint64_t* timeNs)
+{
+    if (pending_input_time == 0u) return 0;
+    if (timeNs) *timeNs = pending_input_time;
+    pending_input_time = 0u;
+    return 1;
+}
+
+void gbbSetInputScript(const GbbInputEvent* events, uint32_t count, uint64_t startNs, uint64_t loopNs)
+{
+    script_events = events;
+    script_count = (events != NULL) ? count : 0u;
+    script_cursor = 0u;
+    script_start = startNs;
+    script_loop = loopNs;
+}
+
+uint32_t gbbPlayInputScript(uint64_t nowNs)
+{
+    uint32_t delivered = 0u;
+    while (script_cursor < script_count)
+    {
+        const GbbInputEvent* event = &script_events[script_cursor];
+        const uint64_t due = script_start + event->timeNs;
+        if (due > nowNs) break;
+        // Scripted events carry the time they were due, as if the OS had queued them then.
+        if (event->key < GBB_KEY_COUNT) gbbPostKeyEvent(event->key, (int)event->down, due);
+        gbbPostMouseWheel(event->wheel, due);
+        delivered += 1u;
+        script_cursor += 1u;
+        if ((script_cursor == script_count) && (script_loop != 0u))
+        {
+            script_cursor = 0u;
+            script_start += script_loop;
+        }
+    }
+    return delivered;
+}
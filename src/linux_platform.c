@@ -0,0 +1,291 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "platform.h"
+
+extern char** environ;
+
+// Headless only: there is no window system integration, so Linux runs the batch and
+// benchmark paths (e.g. under lavapipe) and gbbInitWindow reports failure.
+int gbbInitWindow(uint32_t width, uint32_t height, const char* title)
+{
+    (void)width;
+    (void)height;
+    (void)title;
+    return 1;
+}
+
+void gbbShutdownWindow(void)
+{
+}
+
+int gbbPumpEventsOnce(void)
+{
+    return 1;
+}
+
+uint64_t gbbGetTimeNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+typedef struct GbbThreadStart {
+    GbbThreadProc proc;
+    void* user;
+} GbbThreadStart;
+
+static void* gbbThreadEntry(void* param)
+{
+    GbbThreadStart start = *(GbbThreadStart*)param;
+    free(param);
+    start.proc(start.user);
+    return NULL;
+}
+
+void* gbbCreateThread(GbbThreadProc proc, void* user)
+{
+    GbbThreadStart* start = (GbbThreadStart*)malloc(sizeof(GbbThreadStart));
+    pthread_t* thread = (pthread_t*)malloc(sizeof(pthread_t));
+    if (!start || !thread)
+    {
+        free(start);
+        free(thread);
+        return NULL;
+    }
+    start->proc = proc;
+    start->user = user;
+    if (pthread_create(thread, NULL, gbbThreadEntry, start) != 0)
+    {
+        free(start);
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void gbbJoinThread(void* thread)
+{
+    if (!thread) return;
+    pthread_join(*(pthread_t*)thread, NULL);
+    free(thread);
+}
+
+uint32_t gbbGetCpuCount(void)
+{
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (uint32_t)count : 1u;
+}
+
+typedef struct GbbSemaphore {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+} GbbSemaphore;
+
+void* gbbCreateSemaphore(uint32_t initialCount)
+{
+    GbbSemaphore* semaphore = (GbbSemaphore*)malloc(sizeof(GbbSemaphore));
+    if (!semaphore) return NULL;
+    pthread_mutex_init(&semaphore->mutex, NULL);
+    pthread_cond_init(&semaphore->cond, NULL);
+    semaphore->count = initialCount;
+    return semaphore;
+}
+
+void gbbDestroySemaphore(void* semaphore)
+{
+    if (!semaphore) return;
+    GbbSemaphore* s = (GbbSemaphore*)semaphore;
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->mutex);
+    free(s);
+}
+
+void gbbWaitSemaphore(void* semaphore)
+{
+    GbbSemaphore* s = (GbbSemaphore*)semaphore;
+    pthread_mutex_lock(&s->mutex);
+    while (s->count == 0u)
+    {
+        pthread_cond_wait(&s->cond, &s->mutex);
+    }
+    s->count -= 1u;
+    pthread_mutex_unlock(&s->mutex);
+}
+
+int gbbTryWaitSemaphore(void* semaphore)
+{
+    GbbSemaphore* s = (GbbSemaphore*)semaphore;
+    pthread_mutex_lock(&s->mutex);
+    const int acquired = (s->count > 0u) ? 1 : 0;
+    if (acquired != 0) s->count -= 1u;
+    pthread_mutex_unlock(&s->mutex);
+    return acquired;
+}
+
+void gbbSignalSemaphore(void* semaphore)
+{
+    GbbSemaphore* s = (GbbSemaphore*)semaphore;
+    pthread_mutex_lock(&s->mutex);
+    s->count += 1u;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->mutex);
+}
+
+typedef struct GbbSocket {
+    int fd;
+} GbbSocket;
+
+static void* gbbWrapSocket(int fd)
+{
+    if (fd < 0) return NULL;
+    GbbSocket* handle = (GbbSocket*)malloc(sizeof(GbbSocket));
+    if (!handle)
+    {
+        close(fd);
+        return NULL;
+    }
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    handle->fd = fd;
+    return handle;
+}
+
+void* gbbListenSocket(uint16_t port, uint32_t loopbackOnly, uint16_t* boundPort)
+{
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return NULL;
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl((loopbackOnly != 0u) ? INADDR_LOOPBACK : INADDR_ANY);
+    socklen_t addressSize = sizeof(address);
+    if ((bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0) || (listen(fd, 16) != 0) ||
+        (getsockname(fd, (struct sockaddr*)&address, &addressSize) != 0))
+    {
+        close(fd);
+        return NULL;
+    }
+    if (boundPort) *boundPort = ntohs(address.sin_port);
+    GbbSocket* listener = (GbbSocket*)malloc(sizeof(GbbSocket));
+    if (!listener)
+    {
+        close(fd);
+        return NULL;
+    }
+    listener->fd = fd;
+    return listener;
+}
+
+void* gbbAcceptSocket(void* listener, uint32_t timeoutMs)
+{
+    struct pollfd ready = {.fd = ((GbbSocket*)listener)->fd, .events = POLLIN};
+    if (poll(&ready, 1, (int)timeoutMs) <= 0) return NULL;
+    return gbbWrapSocket(accept(ready.fd, NULL, NULL));
+}
+
+void* gbbConnectSocket(const char* host, uint16_t port)
+{
+    char service[8];
+    snprintf(service, sizeof(service), "%u", (unsigned)port);
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* results = NULL;
+    if (getaddrinfo(host, service, &hints, &results) != 0) return NULL;
+    int fd = -1;
+    for (struct addrinfo* it = results; it && (fd < 0); it = it->ai_next)
+    {
+        fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+        if ((fd >= 0) && (connect(fd, it->ai_addr, it->ai_addrlen) != 0))
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(results);
+    return gbbWrapSocket(fd);
+}
+
+int gbbSendAll(void* stream, const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    while (size > 0u)
+    {
+        const ssize_t sent = send(((GbbSocket*)stream)->fd, bytes, size, MSG_NOSIGNAL);
+        if ((sent < 0) && (errno == EINTR)) continue;
+        if (sent <= 0) return 1;
+        bytes += sent;
+        size -= (size_t)sent;
+    }
+    return 0;
+}
+
+int gbbRecvAll(void* stream, void* data, size_t size)
+{
+    uint8_t* bytes = (uint8_t*)data;
+    while (size > 0u)
+    {
+        const ssize_t received = recv(((GbbSocket*)stream)->fd, bytes, size, 0);
+        if ((received < 0) && (errno == EINTR)) continue;
+        if (received <= 0) return 1;
+        bytes += received;
+        size -= (size_t)received;
+    }
+    return 0;
+}
+
+void gbbCloseSocket(void* stream)
+{
+    if (!stream) return;
+    close(((GbbSocket*)stream)->fd);
+    free(stream);
+}
+
+void* gbbSpawnProcess(const char* const* argv)
+{
+    pid_t* process = (pid_t*)malloc(sizeof(pid_t));
+    if (!process) return NULL;
+    if (posix_spawnp(process, argv[0], NULL, NULL, (char* const*)argv, environ) != 0)
+    {
+        free(process);
+        return NULL;
+    }
+    return process;
+}
+
+int gbbWaitProcess(void* process)
+{
+    if (!process) return -1;
+    int status = 0;
+    pid_t result = -1;
+    do
+    {
+        result = waitpid(*(pid_t*)process, &status, 0);
+    } while ((result < 0) && (errno == EINTR));
+    free(process);
+    if ((result < 0) || !WIFEXITED(status)) return -1;
+    return WEXITSTATUS(status);
+}
@@ -8,22 +8,85 @@
 #include <stdint.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "bench.h"
+#include "capture.h"
+#include "distribute.h"
 #include "gradient_comp_spv.h"
+#include "image_file.h"
 #include "platform.h"
+#include "probe_update_comp_spv.h"
+#include "render_graph.h"
+#include "scene.h"
+#include "tile_bin_comp_spv.h"
 
 #define MAX_SWAP_IMAGES 3u
+#define MAX_PHYSICAL_DEVICES 8u
 #define FRAMES_IN_FLIGHT 1u
 #define COMPUTE_TILE_SIZE 8u
 #define MAX_PACKED_SPHERES 128u
 #define GRID_RES_X 24u
 #define GRID_RES_Y 8u
 #define GRID_RES_Z 24u
-#define GRID_CELL_COUNT (GRID_RES_X * GRID_RES_Y * GRID_RES_Z)
-#define MAX_GRID_INDICES 32768u
+#define ANIMATED_GRID_SLACK 4u
+#define GRID_BENCH_SPHERES 16384u
+#define GRID_BENCH_ITERATIONS 32u
+#define SCENE_GEN_BENCH_SPHERES 1000000u
+#define BENCH_DEFAULT_WIDTH 1280u
+#define BENCH_DEFAULT_HEIGHT 720u
+#define BENCH_DEFAULT_FRAMES 16u
+#define BENCH_DEFAULT_TOLERANCE 0.10
+#define BATCH_SLOTS 2u
+#define BATCH_DEFAULT_WIDTH 3840u
+#define BATCH_DEFAULT_HEIGHT 2160u
+#define BATCH_DEFAULT_SAMPLES 64u
+#define BATCH_DEFAULT_TILE 512u
+#define FRAME_ACCUMULATE 1u
+#define FRAME_RESOLVE 2u
+#define FRAME_FULL_IMAGE 4u
+#define FRAME_PROBES 8u
+#define FRAME_MULTI_VIEW 16u
+#define FRAME_TILE_BINS 32u
+#define FRAME_FIRST_HIT 64u
+#define FRAME_RESTIR 128u
+#define FRAME_COMPACT_GRID 256u
+#define PROGRESSIVE_TILE 128u
+#define PROGRESSIVE_MAX_SAMPLES 4096u
+#define PROGRESSIVE_DEFAULT_BUDGET_MS 6.0f
+#define LOD_DEFAULT_BOUNCE 1u
+#define LOD_COMPARE_SAMPLES 16u
+#define PROBE_SPACING 1.5f
+#define PROBE_MAX_DIM 64u
+#define PROBE_UPDATES_PER_FRAME 512u
+#define MULTI_VIEW_DEFAULT_SIZE 256u
+#define MULTI_VIEW_DEFAULT_SAMPLES 4u
+#define BIN_TILE_SIZE 8u
+#define BIN_SCAN 1u
+#define BIN_PASSES 3u
+#define BIN_CLEAR_STEP 0u
+#define BIN_STEPS (BIN_PASSES + 1u)
+#define BIN_DISPATCH_SIZE 256u
+#define TILE_BIN_ENTRIES_PER_SPHERE 8u
+#define TILE_BIN_MIN_ENTRIES 65536u
+#define TILE_BIN_BENCH_ITERATIONS 16u
+#define RESTIR_SAMPLE 0u
+#define RESTIR_SHADE 1u
+#define RESTIR_PASSES 2u
+#define RESTIR_PIXEL_BYTES 64u
+#define RESTIR_BENCH_FRAMES 32u
+#define RESTIR_REFERENCE_SAMPLES 256u
+#define RESTIR_REFERENCE_BATCH 16u
+#define CAPTURE_SLOTS 4u
+#define LATENCY_SCRIPT_EVENTS 64u
+#define LATENCY_SCRIPT_PERIOD_NS 23700000ull
 
 static const char* APPLICATION_NAME = "greatbadbeyond";
+static const float CAMERA_YAW = 0.7853981634f;
+static const float CAMERA_PITCH = -0.7853981634f;
+static const float CAMERA_FOV = 0.2967059728f;
+static const float CAMERA_DEFAULT_ZOOM = 26.0f;
 
 #if defined(_WIN32)
 static const char* const INSTANCE_EXTS[] = {
@@ -34,6 +97,8 @@ static const VkInstanceCreateFlags INSTANCE_FLAGS = 0u;
 static const char* const DEVICE_EXTS[] = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 };
+static const uint32_t INSTANCE_EXT_COUNT = (uint32_t)(sizeof(INSTANCE_EXTS) / sizeof(*INSTANCE_EXTS));
+static const uint32_t DEVICE_EXT_COUNT = (uint32_t)(sizeof(DEVICE_EXTS) / sizeof(*DEVICE_EXTS));
 #elif defined(__APPLE__)
 static const char* const INSTANCE_EXTS[] = {
     VK_KHR_SURFACE_EXTENSION_NAME,
@@ -45,6 +110,15 @@ static const char* const DEVICE_EXTS[] = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME,
     "VK_KHR_portability_subset",
 };
+static const uint32_t INSTANCE_EXT_COUNT = (uint32_t)(sizeof(INSTANCE_EXTS) / sizeof(*INSTANCE_EXTS));
+static const uint32_t DEVICE_EXT_COUNT = (uint32_t)(sizeof(DEVICE_EXTS) / sizeof(*DEVICE_EXTS));
+#elif defined(__linux__)
+// Headless only (batch and benchmark paths), so no surface or swapchain extensions.
+static const char* const* const INSTANCE_EXTS = NULL;
+static const VkInstanceCreateFlags INSTANCE_FLAGS = 0u;
+static const char* const* const DEVICE_EXTS = NULL;
+static const uint32_t INSTANCE_EXT_COUNT = 0u;
+static const uint32_t DEVICE_EXT_COUNT = 0u;
 #else
 #error Unsupported platform
 #endif
@@ -57,12 +131,15 @@ static VkQueue queue = VK_NULL_HANDLE;
 static VkSwapchainKHR swapchain = VK_NULL_HANDLE;
 static VkExtent2D swapExtent = {0u, 0u};
 static VkImage swapImages[MAX_SWAP_IMAGES];
-static VkImageView swapImageViews[MAX_SWAP_IMAGES];
+static VkImageView outputImageViews[MAX_SWAP_IMAGES];
+static VkImageView accumImageViews[MAX_SWAP_IMAGES];
 static VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
 static VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
 static VkDescriptorSet descriptorSets[MAX_SWAP_IMAGES];
 static VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
 static VkPipeline pipeline = VK_NULL_HANDLE;
+static VkPipeline probePipeline = VK_NULL_HANDLE;
+static VkPipeline tileBinPipeline = VK_NULL_HANDLE;
 static VkCommandPool commandPool = VK_NULL_HANDLE;
 static VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
 static VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
@@ -72,76 +149,77 @@ static VkFence inFlightFence = VK_NULL_HANDLE;
 static VkBuffer sphereBuffer = VK_NULL_HANDLE;
 static VkDeviceMemory sphereBufferMemory = VK_NULL_HANDLE;
 static VkDeviceSize sphereBufferSize = 0u;
+static void *sphereBufferMapped = NULL;
 static VkBuffer gridCellBuffer = VK_NULL_HANDLE;
 static VkDeviceMemory gridCellBufferMemory = VK_NULL_HANDLE;
 static VkDeviceSize gridCellBufferSize = 0u;
+static void *gridCellBufferMapped = NULL;
 static VkBuffer gridIndexBuffer = VK_NULL_HANDLE;
 static VkDeviceMemory gridIndexBufferMemory = VK_NULL_HANDLE;
 static VkDeviceSize gridIndexBufferSize = 0u;
-static uint32_t packedSphereWords[MAX_PACKED_SPHERES * 2u];
-static uint32_t packedSphereCount = 0u;
-static uint32_t gridCellWords[GRID_CELL_COUNT * 2u];
-static uint32_t gridIndexWords[MAX_GRID_INDICES];
-static uint32_t gridCellCount = 0u;
-static uint32_t gridIndexCount = 0u;
-
-static const float SCENE_MIN[3] = {-18.0f, 0.0f, -18.0f};
-static const float SCENE_EXTENT[3] = {36.0f, 8.0f, 36.0f};
-static const float SPHERE_RADIUS_MIN = 0.22f;
-static const float SPHERE_RADIUS_MAX = 0.85f;
+static void *gridIndexBufferMapped = NULL;
+static VkBuffer compactGridBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory compactGridBufferMemory = VK_NULL_HANDLE;
+static VkDeviceSize compactGridBufferSize = 0u;
+static VkBuffer blockBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory blockBufferMemory = VK_NULL_HANDLE;
+static VkDeviceSize blockBufferSize = 0u;
+static VkBuffer instanceBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory instanceBufferMemory = VK_NULL_HANDLE;
+static VkDeviceSize instanceBufferSize = 0u;
+static VkBuffer probeBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory probeBufferMemory = VK_NULL_HANDLE;
+static VkDeviceSize probeBufferSize = 0u;
+static uint32_t probeDims[3] = {0u, 0u, 0u};
+static uint32_t probeCursor = 0u;
+static uint32_t probeFrame = 0u;
+static VkImage viewArrayImage = VK_NULL_HANDLE;
+static VkDeviceMemory viewArrayMemory = VK_NULL_HANDLE;
+static VkImageView viewArrayView = VK_NULL_HANDLE;
+static VkBuffer viewCameraBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory viewCameraBufferMemory = VK_NULL_HANDLE;
+static VkDeviceSize viewCameraBufferSize = 0u;
+static void *viewCameraBufferMapped = NULL;
+static VkBuffer tileBinBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory tileBinBufferMemory = VK_NULL_HANDLE;
+static VkDeviceSize tileBinBufferSize = 0u;
+static VkBuffer tileEntryBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory tileEntryBufferMemory = VK_NULL_HANDLE;
+static VkDeviceSize tileEntryBufferSize = 0u;
+static uint32_t tileBinWidth = 0u;
+static uint32_t tileBinHeight = 0u;
+static VkBuffer restirBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory restirBufferMemory = VK_NULL_HANDLE;
+static VkDeviceSize restirBufferSize = 0u;
+static uint32_t restirWidth = 0u;
+static uint32_t restirHeight = 0u;
+static uint32_t restirFrame = 0u;
+static float restirPreviousOrigin[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+static float restirPreviousForwardFov[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+static PackedSpheres spheres = {0};
+static SphereGrid grid = {0};
+static InstancedScene instancedScene = {0};
+static SphereLod sphereLod = {0};
+static CompactGrid compactGrid = {0};
+static uint32_t lodBounce = 0u;
+static float lodDistance = 0.0f;
 
 typedef struct ScenePushConstants {
     float origin[4];
     float forward_fov[4];
     float scene_min[4];
     float scene_extent[4];
-    float radius_min_max[4];
+    uint32_t view[4];
     uint32_t counts[4];
     uint32_t grid_dims[4];
+    uint32_t frame[4];
 } ScenePushConstants;
 
-static float clampf01(float v)
-{
-    if (v < 0.0f) return 0.0f;
-    if (v > 1.0f) return 1.0f;
-    return v;
-}
-
-static uint32_t nextRandom(uint32_t *state)
-{
-    *state = (*state * 1664525u) + 1013904223u;
-    return *state;
-}
-
-static float random01(uint32_t *state)
-{
-    return (float)((nextRandom(state) >> 8u) & 0x00ffffffu) * (1.0f / 16777215.0f);
-}
-
-static uint32_t quantizeUnorm16(float v)
-{
-    return (uint32_t)floorf(clampf01(v) * 65535.0f + 0.5f);
-}
-
-static float dequantizeUnorm16(uint32_t q)
-{
-    return (float)q * (1.0f / 65535.0f);
-}
-
-static uint32_t quantizeRadius12(float radius)
-{
-    float range = fmaxf(SPHERE_RADIUS_MAX - SPHERE_RADIUS_MIN, 1e-6f);
-    float radiusNorm = clampf01((radius - SPHERE_RADIUS_MIN) / range);
-    float encoded = sqrtf(radiusNorm);
-    return (uint32_t)floorf(encoded * 4095.0f + 0.5f);
-}
-
-static float dequantizeRadius12(uint32_t q)
-{
-    float range = SPHERE_RADIUS_MAX - SPHERE_RADIUS_MIN;
-    float encoded = (float)q * (1.0f / 4095.0f);
-    return SPHERE_RADIUS_MIN + (encoded * encoded) * range;
-}
+// One camera of a FRAME_MULTI_VIEW dispatch (binding 9), also the ReSTIR state header.
+typedef struct GpuViewCamera {
+    float origin[4];
+    float forward_fov[4];
+} GpuViewCamera;
 
 static uint32_t findMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags requiredFlags)
 {
@@ -158,12 +236,13 @@ static uint32_t findMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags req
     return 0u;
 }
 
-static void createStorageBuffer(const void *data, VkDeviceSize size, VkBuffer *buffer, VkDeviceMemory *memory)
+static void createHostBuffer(VkBufferUsageFlags usage, const void *data, VkDeviceSize dataSize, VkDeviceSize size,
+                             VkBuffer *buffer, VkDeviceMemory *memory, void **mapped)
 {
     vkCreateBuffer(device, &(VkBufferCreateInfo){
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .size = size,
-        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .usage = usage,
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
     }, NULL, buffer);
 
@@ -178,266 +257,3245 @@ static void createStorageBuffer(const void *data, VkDeviceSize size, VkBuffer *b
     }, NULL, memory);
     vkBindBufferMemory(device, *buffer, *memory, 0u);
 
-    void *mapped = NULL;
-    vkMapMemory(device, *memory, 0u, size, 0u, &mapped);
-    memcpy(mapped, data, (size_t)size);
+    void *bufferData = NULL;
+    vkMapMemory(device, *memory, 0u, size, 0u, &bufferData);
+    if (dataSize > 0u) memcpy(bufferData, data, (size_t)dataSize);
+    if (mapped)
+    {
+        *mapped = bufferData;
+        return;
+    }
     vkUnmapMemory(device, *memory);
 }
 
-static void decodePackedSphereCpu(uint32_t sphereIndex, float *centerX, float *centerY, float *centerZ, float *radius)
+static void createStorageBuffer(const void *data, VkDeviceSize dataSize, VkDeviceSize size,
+                                VkBuffer *buffer, VkDeviceMemory *memory, void **mapped)
 {
-    uint32_t w0 = packedSphereWords[sphereIndex * 2u + 0u];
-    uint32_t w1 = packedSphereWords[sphereIndex * 2u + 1u];
-    uint32_t qx = w0 & 0xffffu;
-    uint32_t qy = (w0 >> 16u) & 0xffffu;
-    uint32_t qz = w1 & 0xffffu;
-    uint32_t qRadius = (w1 >> 16u) & 0x0fffu;
-    *centerX = SCENE_MIN[0] + dequantizeUnorm16(qx) * SCENE_EXTENT[0];
-    *centerY = SCENE_MIN[1] + dequantizeUnorm16(qy) * SCENE_EXTENT[1];
-    *centerZ = SCENE_MIN[2] + dequantizeUnorm16(qz) * SCENE_EXTENT[2];
-    *radius = dequantizeRadius12(qRadius);
+    createHostBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, data, dataSize, size, buffer, memory, mapped);
 }
 
-static uint32_t clampGridCoord(int32_t value, uint32_t maxValue)
+// For buffers only the GPU touches; contents start undefined.
+static void createDeviceBuffer(VkBufferUsageFlags usage, VkDeviceSize size, VkBuffer *buffer, VkDeviceMemory *memory)
 {
-    if (value < 0) return 0u;
-    if ((uint32_t)value >= maxValue) return maxValue - 1u;
-    return (uint32_t)value;
+    vkCreateBuffer(device, &(VkBufferCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = size,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    }, NULL, buffer);
+
+    VkMemoryRequirements requirements = {0};
+    vkGetBufferMemoryRequirements(device, *buffer, &requirements);
+    vkAllocateMemory(device, &(VkMemoryAllocateInfo){
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = requirements.size,
+        .memoryTypeIndex = findMemoryTypeIndex(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+    }, NULL, memory);
+    vkBindBufferMemory(device, *buffer, *memory, 0u);
 }
 
-static void buildPackedSpheres(void)
+static void destroyHostBuffer(VkBuffer *buffer, VkDeviceMemory *memory, void **mapped)
 {
-    float placedCenterX[MAX_PACKED_SPHERES];
-    float placedCenterY[MAX_PACKED_SPHERES];
-    float placedCenterZ[MAX_PACKED_SPHERES];
-    float placedRadius[MAX_PACKED_SPHERES];
-
-    packedSphereCount = 0u;
-    uint32_t rng = 0x1f2e3d4cu;
-    for (uint32_t i = 0u; i < MAX_PACKED_SPHERES; ++i)
+    if (mapped && *mapped)
     {
-        uint32_t placed = 0u;
-        for (uint32_t attempt = 0u; attempt < 64u; ++attempt)
-        {
-            float radiusMix = random01(&rng);
-            float radius = SPHERE_RADIUS_MIN + (SPHERE_RADIUS_MAX - SPHERE_RADIUS_MIN) * (0.25f + 0.75f * radiusMix);
+        vkUnmapMemory(device, *memory);
+        *mapped = NULL;
+    }
+    vkDestroyBuffer(device, *buffer, NULL);
+    vkFreeMemory(device, *memory, NULL);
+    *buffer = VK_NULL_HANDLE;
+    *memory = VK_NULL_HANDLE;
+}
 
-            float minX = SCENE_MIN[0] + radius;
-            float maxX = SCENE_MIN[0] + SCENE_EXTENT[0] - radius;
-            float minZ = SCENE_MIN[2] + radius;
-            float maxZ = SCENE_MIN[2] + SCENE_EXTENT[2] - radius;
-            if ((maxX <= minX) || (maxZ <= minZ)) continue;
+static VkDeviceSize wordBufferSize(uint32_t wordCount)
+{
+    return (VkDeviceSize)(((wordCount > 0u) ? wordCount : 2u) * sizeof(uint32_t));
+}
 
-            float centerX = minX + (maxX - minX) * random01(&rng);
-            float centerY = SCENE_MIN[1] + radius;
-            float centerZ = minZ + (maxZ - minZ) * random01(&rng);
-            uint32_t materialId = nextRandom(&rng) % 3u;
+// Buffers are sized from the CPU-side capacities so edits that stay within slack only
+// need their dirty pages copied; growth past capacity recreates the buffer.
+static void createSceneBuffers(void)
+{
+    if (instancedScene.instanceCount > 0u)
+    {
+        sphereBufferSize = wordBufferSize(instancedScene.sphereWordCount);
+        gridCellBufferSize = wordBufferSize(instancedScene.cellWordCount);
+        gridIndexBufferSize = wordBufferSize(instancedScene.indexWordCount);
+        blockBufferSize = (VkDeviceSize)instancedScene.blockCount * sizeof(GpuSphereBlock);
+        instanceBufferSize = (VkDeviceSize)instancedScene.instanceCount * sizeof(GpuSphereInstance);
+        createStorageBuffer(instancedScene.sphereWords, (VkDeviceSize)instancedScene.sphereWordCount * sizeof(uint32_t),
+                            sphereBufferSize, &sphereBuffer, &sphereBufferMemory, NULL);
+        createStorageBuffer(instancedScene.cellWords, (VkDeviceSize)instancedScene.cellWordCount * sizeof(uint32_t),
+                            gridCellBufferSize, &gridCellBuffer, &gridCellBufferMemory, NULL);
+        createStorageBuffer(instancedScene.indexWords, (VkDeviceSize)instancedScene.indexWordCount * sizeof(uint32_t),
+                            gridIndexBufferSize, &gridIndexBuffer, &gridIndexBufferMemory, NULL);
+        createStorageBuffer(instancedScene.gpuBlocks, blockBufferSize, blockBufferSize, &blockBuffer, &blockBufferMemory, NULL);
+        createStorageBuffer(instancedScene.instances, instanceBufferSize, instanceBufferSize,
+                            &instanceBuffer, &instanceBufferMemory, NULL);
+        compactGridBufferSize = wordBufferSize(0u);
+        createStorageBuffer(NULL, 0u, compactGridBufferSize, &compactGridBuffer, &compactGridBufferMemory, NULL);
+        return;
+    }
 
-            uint32_t qx = quantizeUnorm16((centerX - SCENE_MIN[0]) / SCENE_EXTENT[0]);
-            uint32_t qy = quantizeUnorm16((centerY - SCENE_MIN[1]) / SCENE_EXTENT[1]);
-            uint32_t qz = quantizeUnorm16((centerZ - SCENE_MIN[2]) / SCENE_EXTENT[2]);
-            uint32_t qRadius = quantizeRadius12(radius);
+    // A flat scene has no blocks, so block 0 describes its LOD proxies (if built), which
+    // are stored behind the scene's own spheres, cells and indices.
+    const PackedSpheres *proxies = &sphereLod.proxies;
+    const SphereGrid *lodGrid = &sphereLod.grid;
+    GpuSphereBlock lodBlock = {
+        .boundsMin = {proxies->bounds.min[0], proxies->bounds.min[1], proxies->bounds.min[2], proxies->bounds.radiusMin},
+        .boundsExtent = {proxies->bounds.extent[0], proxies->bounds.extent[1], proxies->bounds.extent[2], proxies->bounds.radiusMax},
+        .counts = {proxies->count, lodGrid->cellCount, lodGrid->indexCount, 0u},
+        .dims = {lodGrid->dims[0], lodGrid->dims[1], lodGrid->dims[2], 0u},
+        .base = {spheres.capacity, grid.cellCount, grid.indexCapacity, 0u},
+    };
+    static const GpuSphereInstance emptyInstance = {0};
+    blockBufferSize = sizeof(lodBlock);
+    instanceBufferSize = sizeof(emptyInstance);
+    createStorageBuffer(&lodBlock, blockBufferSize, blockBufferSize, &blockBuffer, &blockBufferMemory, NULL);
+    createStorageBuffer(&emptyInstance, instanceBufferSize, instanceBufferSize, &instanceBuffer, &instanceBufferMemory, NULL);
+    sphereBufferSize = wordBufferSize((spheres.capacity + proxies->count) * 2u);
+    gridCellBufferSize = wordBufferSize((grid.cellCount + lodGrid->cellCount) * 2u);
+    gridIndexBufferSize = wordBufferSize(grid.indexCapacity + lodGrid->indexCount);
+    createStorageBuffer(spheres.words, (VkDeviceSize)spheres.count * 2u * sizeof(uint32_t), sphereBufferSize,
+                        &sphereBuffer, &sphereBufferMemory, &sphereBufferMapped);
+    createStorageBuffer(grid.cellWords, (VkDeviceSize)grid.cellCount * 2u * sizeof(uint32_t), gridCellBufferSize,
+                        &gridCellBuffer, &gridCellBufferMemory, &gridCellBufferMapped);
+    createStorageBuffer(grid.indexWords, (VkDeviceSize)grid.indexCount * sizeof(uint32_t), gridIndexBufferSize,
+                        &gridIndexBuffer, &gridIndexBufferMemory, &gridIndexBufferMapped);
+    if (proxies->count > 0u)
+    {
+        memcpy((uint32_t *)sphereBufferMapped + (size_t)spheres.capacity * 2u, proxies->words,
+               (size_t)proxies->count * 2u * sizeof(uint32_t));
+        memcpy((uint32_t *)gridCellBufferMapped + (size_t)grid.cellCount * 2u, lodGrid->cellWords,
+               (size_t)lodGrid->cellCount * 2u * sizeof(uint32_t));
+        memcpy((uint32_t *)gridIndexBufferMapped + grid.indexCapacity, lodGrid->indexWords,
+               (size_t)lodGrid->indexCount * sizeof(uint32_t));
+    }
+    compactGridBufferSize = wordBufferSize(compactGrid.wordCount);
+    createStorageBuffer(compactGrid.words, (VkDeviceSize)compactGrid.wordCount * sizeof(uint32_t), compactGridBufferSize,
+                        &compactGridBuffer, &compactGridBufferMemory, NULL);
+    gbbClearDirty(&spheres.dirty);
+    gbbClearDirty(&grid.cellDirty);
+    gbbClearDirty(&grid.indexDirty);
+}
 
-            float decodedX = SCENE_MIN[0] + dequantizeUnorm16(qx) * SCENE_EXTENT[0];
-            float decodedY = SCENE_MIN[1] + dequantizeUnorm16(qy) * SCENE_EXTENT[1];
-            float decodedZ = SCENE_MIN[2] + dequantizeUnorm16(qz) * SCENE_EXTENT[2];
-            float decodedRadius = dequantizeRadius12(qRadius);
+static void destroySceneBuffers(void)
+{
+    destroyHostBuffer(&sphereBuffer, &sphereBufferMemory, &sphereBufferMapped);
+    destroyHostBuffer(&gridCellBuffer, &gridCellBufferMemory, &gridCellBufferMapped);
+    destroyHostBuffer(&gridIndexBuffer, &gridIndexBufferMemory, &gridIndexBufferMapped);
+    destroyHostBuffer(&blockBuffer, &blockBufferMemory, NULL);
+    destroyHostBuffer(&instanceBuffer, &instanceBufferMemory, NULL);
+    destroyHostBuffer(&compactGridBuffer, &compactGridBufferMemory, NULL);
+}
 
-            uint32_t overlap = 0u;
-            for (uint32_t s = 0u; s < packedSphereCount; ++s)
+static void writeSceneDescriptors(uint32_t setCount)
+{
+    for (uint32_t i = 0u; i < setCount; i++)
+    {
+        VkDescriptorImageInfo imageInfo = {
+            .imageView = outputImageViews[i],
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+        };
+        VkDescriptorImageInfo accumImageInfo = {
+            .imageView = accumImageViews[i],
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+        };
+        VkDescriptorBufferInfo sphereBufferInfo = {
+            .buffer = sphereBuffer,
+            .offset = 0u,
+            .range = sphereBufferSize,
+        };
+        VkDescriptorBufferInfo gridCellBufferInfo = {
+            .buffer = gridCellBuffer,
+            .offset = 0u,
+            .range = gridCellBufferSize,
+        };
+        VkDescriptorBufferInfo gridIndexBufferInfo = {
+            .buffer = gridIndexBuffer,
+            .offset = 0u,
+            .range = gridIndexBufferSize,
+        };
+        VkDescriptorBufferInfo blockBufferInfo = {
+            .buffer = blockBuffer,
+            .offset = 0u,
+            .range = blockBufferSize,
+        };
+        VkDescriptorBufferInfo instanceBufferInfo = {
+            .buffer = instanceBuffer,
+            .offset = 0u,
+            .range = instanceBufferSize,
+        };
+        VkDescriptorBufferInfo probeBufferInfo = {
+            .buffer = probeBuffer,
+            .offset = 0u,
+            .range = probeBufferSize,
+        };
+        VkDescriptorImageInfo viewArrayInfo = {
+            .imageView = viewArrayView,
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+        };
+        VkDescriptorBufferInfo viewCameraBufferInfo = {
+            .buffer = viewCameraBuffer,
+            .offset = 0u,
+            .range = viewCameraBufferSize,
+        };
+        VkDescriptorBufferInfo tileBinBufferInfo = {
+            .buffer = tileBinBuffer,
+            .offset = 0u,
+            .range = tileBinBufferSize,
+        };
+        VkDescriptorBufferInfo tileEntryBufferInfo = {
+            .buffer = tileEntryBuffer,
+            .offset = 0u,
+            .range = tileEntryBufferSize,
+        };
+        VkDescriptorBufferInfo restirBufferInfo = {
+            .buffer = restirBuffer,
+            .offset = 0u,
+            .range = restirBufferSize,
+        };
+        VkDescriptorBufferInfo compactGridBufferInfo = {
+            .buffer = compactGridBuffer,
+            .offset = 0u,
+            .range = compactGridBufferSize,
+        };
+        VkWriteDescriptorSet writes[14] = {
             {
-                float dx = decodedX - placedCenterX[s];
-                float dy = decodedY - placedCenterY[s];
-                float dz = decodedZ - placedCenterZ[s];
-                float minDist = decodedRadius + placedRadius[s] + 0.03f;
-                if ((dx * dx + dy * dy + dz * dz) < (minDist * minDist))
-                {
-                    overlap = 1u;
-                    break;
-                }
-            }
-            if (overlap != 0u) continue;
-
-            uint32_t base = packedSphereCount * 2u;
-            packedSphereWords[base + 0u] = (qx & 0xffffu) | ((qy & 0xffffu) << 16u);
-            packedSphereWords[base + 1u] = (qz & 0xffffu) | ((qRadius & 0x0fffu) << 16u) | ((materialId & 0x0fu) << 28u);
-
-            placedCenterX[packedSphereCount] = decodedX;
-            placedCenterY[packedSphereCount] = decodedY;
-            placedCenterZ[packedSphereCount] = decodedZ;
-            placedRadius[packedSphereCount] = decodedRadius;
-            packedSphereCount += 1u;
-            placed = 1u;
-            break;
-        }
-        if ((placed == 0u) && (packedSphereCount >= 32u)) break;
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 0u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                .pImageInfo = &imageInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 1u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &sphereBufferInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 2u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &gridCellBufferInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 3u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &gridIndexBufferInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 4u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &blockBufferInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 5u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &instanceBufferInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 6u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                .pImageInfo = &accumImageInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 7u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &probeBufferInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 8u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                .pImageInfo = &viewArrayInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 9u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &viewCameraBufferInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 10u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &tileBinBufferInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 11u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &tileEntryBufferInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 12u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &restirBufferInfo,
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = descriptorSets[i],
+                .dstBinding = 13u,
+                .descriptorCount = 1u,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &compactGridBufferInfo,
+            },
+        };
+        vkUpdateDescriptorSets(device, 14u, writes, 0u, NULL);
+    }
+}
+
+static size_t uploadDirtyWords(DirtyPages *dirty, const uint32_t *words, uint32_t wordCount, void *mapped)
+{
+    size_t uploadedBytes = 0u;
+    uint32_t cursor = 0u;
+    uint32_t firstWord = 0u;
+    uint32_t rangeWords = 0u;
+    while (gbbNextDirtyRange(dirty, &cursor, &firstWord, &rangeWords) != 0)
+    {
+        if (firstWord >= wordCount) break;
+        if ((firstWord + rangeWords) > wordCount) rangeWords = wordCount - firstWord;
+        memcpy((uint32_t *)mapped + firstWord, words + firstWord, (size_t)rangeWords * sizeof(uint32_t));
+        uploadedBytes += (size_t)rangeWords * sizeof(uint32_t);
+    }
+    gbbClearDirty(dirty);
+    return uploadedBytes;
+}
+
+// Must run while the GPU is not reading the scene buffers (after inFlightFence).
+static size_t uploadSceneEdits(uint32_t swapImageCount)
+{
+    uint32_t recreated = 0u;
+    if (wordBufferSize(spheres.capacity * 2u) > sphereBufferSize)
+    {
+        destroyHostBuffer(&sphereBuffer, &sphereBufferMemory, &sphereBufferMapped);
+        sphereBufferSize = wordBufferSize(spheres.capacity * 2u);
+        createStorageBuffer(spheres.words, 0u, sphereBufferSize, &sphereBuffer, &sphereBufferMemory, &sphereBufferMapped);
+        gbbMarkAllDirty(&spheres.dirty);
+        recreated = 1u;
     }
+    if (wordBufferSize(grid.indexCapacity) > gridIndexBufferSize)
+    {
+        destroyHostBuffer(&gridIndexBuffer, &gridIndexBufferMemory, &gridIndexBufferMapped);
+        gridIndexBufferSize = wordBufferSize(grid.indexCapacity);
+        createStorageBuffer(grid.indexWords, 0u, gridIndexBufferSize, &gridIndexBuffer, &gridIndexBufferMemory, &gridIndexBufferMapped);
+        gbbMarkAllDirty(&grid.indexDirty);
+        recreated = 1u;
+    }
+    if (recreated != 0u) writeSceneDescriptors(swapImageCount);
+
+    size_t uploadedBytes = 0u;
+    uploadedBytes += uploadDirtyWords(&spheres.dirty, spheres.words, spheres.count * 2u, sphereBufferMapped);
+    uploadedBytes += uploadDirtyWords(&grid.cellDirty, grid.cellWords, grid.cellCount * 2u, gridCellBufferMapped);
+    uploadedBytes += uploadDirtyWords(&grid.indexDirty, grid.indexWords, grid.indexCount, gridIndexBufferMapped);
+    return uploadedBytes;
+}
 
-    if (packedSphereCount == 0u)
+// In instanced mode the scene bounds, counts and grid describe the top-level grid over
+// instances; counts.w carries the block count and switches gradient.comp to that path.
+static void fillScenePushConstants(ScenePushConstants *push)
+{
+    const SceneBounds *bounds = &spheres.bounds;
+    const SphereGrid *sceneGrid = &grid;
+    uint32_t itemCount = spheres.count;
+    if (instancedScene.instanceCount > 0u)
+    {
+        bounds = &instancedScene.worldBounds;
+        sceneGrid = &instancedScene.topGrid;
+        itemCount = instancedScene.instanceCount;
+    }
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        push->scene_min[axis] = bounds->min[axis];
+        push->scene_extent[axis] = bounds->extent[axis];
+        push->grid_dims[axis] = sceneGrid->dims[axis];
+    }
+    push->scene_min[3] = bounds->radiusMin;
+    push->scene_extent[3] = bounds->radiusMax;
+    push->counts[0] = itemCount;
+    push->counts[1] = sceneGrid->cellCount;
+    push->counts[2] = sceneGrid->indexCount;
+    push->counts[3] = instancedScene.blockCount;
+    const uint32_t lodAvailable = (uint32_t)((instancedScene.instanceCount == 0u) && (sphereLod.proxies.count > 0u));
+    push->origin[3] = (lodAvailable != 0u) ? lodDistance : 0.0f;
+    push->grid_dims[3] = (lodAvailable != 0u) ? lodBounce : 0u;
+    if (probeDims[0] != 0u)
     {
-        uint32_t qx = quantizeUnorm16((0.0f - SCENE_MIN[0]) / SCENE_EXTENT[0]);
-        uint32_t qy = quantizeUnorm16((0.8f - SCENE_MIN[1]) / SCENE_EXTENT[1]);
-        uint32_t qz = quantizeUnorm16((-6.0f - SCENE_MIN[2]) / SCENE_EXTENT[2]);
-        uint32_t qRadius = quantizeRadius12(0.8f);
-        packedSphereWords[0] = (qx & 0xffffu) | ((qy & 0xffffu) << 16u);
-        packedSphereWords[1] = (qz & 0xffffu) | ((qRadius & 0x0fffu) << 16u);
-        packedSphereCount = 1u;
+        push->frame[1] |= FRAME_PROBES;
+        push->frame[2] = probeDims[0] | (probeDims[1] << 10u) | (probeDims[2] << 20u);
     }
+    if ((instancedScene.instanceCount == 0u) && (compactGrid.wordCount > 0u)) push->frame[1] |= FRAME_COMPACT_GRID;
 }
 
-static void buildUniformGrid(void)
+static void printGridStats(const SphereGrid *stats, uint32_t sphereCount)
 {
-    uint32_t cellHistogram[GRID_CELL_COUNT];
-    uint32_t cellCursor[GRID_CELL_COUNT];
-    memset(cellHistogram, 0, sizeof(cellHistogram));
-    memset(cellCursor, 0, sizeof(cellCursor));
-    memset(gridCellWords, 0, sizeof(gridCellWords));
-    memset(gridIndexWords, 0, sizeof(gridIndexWords));
+    uint32_t nonEmptyCellCount = 0u;
+    uint32_t maxCellCount = 0u;
+    for (uint32_t cell = 0u; cell < stats->cellCount; ++cell)
+    {
+        uint32_t count = stats->cellWords[cell * 2u + 1u];
+        if (count > 0u) nonEmptyCellCount += 1u;
+        if (count > maxCellCount) maxCellCount = count;
+    }
+    printf("grid cells %u non-empty %u max-cell %u refs %u spheres %u\n",
+           stats->cellCount, nonEmptyCellCount, maxCellCount, stats->refCount, sphereCount);
+}
 
-    const float cellSizeX = SCENE_EXTENT[0] / (float)GRID_RES_X;
-    const float cellSizeY = SCENE_EXTENT[1] / (float)GRID_RES_Y;
-    const float cellSizeZ = SCENE_EXTENT[2] / (float)GRID_RES_Z;
+static void jitterSphere(const SceneBounds *bounds, const uint32_t words[2], float amount, uint32_t *rng, uint32_t outWords[2])
+{
+    float center[3];
+    float radius = 0.0f;
+    gbbDecodeSphere(bounds, words, center, &radius);
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        *rng = (*rng * 1664525u) + 1013904223u;
+        float offset = ((float)(*rng >> 8u) * (1.0f / 16777216.0f) - 0.5f) * 2.0f * amount;
+        center[axis] = fminf(fmaxf(center[axis] + offset, bounds->min[axis]), bounds->min[axis] + bounds->extent[axis]);
+    }
+    gbbPackSphere(bounds, center, radius, words[1] >> 28u, outWords);
+}
 
-    for (uint32_t sphereIndex = 0u; sphereIndex < packedSphereCount; ++sphereIndex)
+// Compares a full two-pass rebuild plus whole-buffer upload against incremental edits
+// plus dirty-page upload, with host memory standing in for the mapped device buffers.
+static void runGridUpdateBenchmark(void)
+{
+    PackedSpheres benchSpheres = {0};
+    SphereGrid benchGrid = {0};
+    gbbDefaultSceneBounds(&benchSpheres.bounds);
+    gbbReserveSpheres(&benchSpheres, GRID_BENCH_SPHERES);
+    uint32_t rng = 0x5eed1234u;
+    for (uint32_t i = 0u; i < GRID_BENCH_SPHERES; ++i)
+    {
+        const SceneBounds *bounds = &benchSpheres.bounds;
+        float center[3];
+        for (uint32_t axis = 0u; axis < 3u; ++axis)
+        {
+            rng = (rng * 1664525u) + 1013904223u;
+            center[axis] = bounds->min[axis] + bounds->extent[axis] * ((float)(rng >> 8u) * (1.0f / 16777216.0f));
+        }
+        float radius = bounds->radiusMin + (bounds->radiusMax - bounds->radiusMin) * (float)(i % 7u) * (1.0f / 6.0f);
+        gbbPackSphere(bounds, center, radius, i % 3u, &benchSpheres.words[i * 2u]);
+    }
+    benchSpheres.count = GRID_BENCH_SPHERES;
+
+    const uint32_t dimX = GRID_RES_X * 2u;
+    const uint32_t dimY = GRID_RES_Y * 2u;
+    const uint32_t dimZ = GRID_RES_Z * 2u;
+    gbbBuildSphereGrid(&benchGrid, &benchSpheres, dimX, dimY, dimZ, 0u);
+    printGridStats(&benchGrid, benchSpheres.count);
+
+    SphereEdit *edits = (SphereEdit *)malloc(sizeof(SphereEdit) * GRID_BENCH_SPHERES);
+    size_t stagingWords = (size_t)GRID_BENCH_SPHERES * 2u + (size_t)benchGrid.cellCount * 2u + (size_t)benchGrid.indexCapacity * 4u;
+    uint32_t *staging = (uint32_t *)malloc(stagingWords * sizeof(uint32_t));
+    if (!edits || !staging)
     {
-        float cx = 0.0f;
-        float cy = 0.0f;
-        float cz = 0.0f;
-        float radius = 0.0f;
-        decodePackedSphereCpu(sphereIndex, &cx, &cy, &cz, &radius);
+        free(edits);
+        free(staging);
+        gbbFreeSphereGrid(&benchGrid);
+        gbbFreePackedSpheres(&benchSpheres);
+        return;
+    }
 
-        int32_t minX = (int32_t)floorf((cx - radius - SCENE_MIN[0]) / cellSizeX);
-        int32_t minY = (int32_t)floorf((cy - radius - SCENE_MIN[1]) / cellSizeY);
-        int32_t minZ = (int32_t)floorf((cz - radius - SCENE_MIN[2]) / cellSizeZ);
-        int32_t maxX = (int32_t)floorf((cx + radius - SCENE_MIN[0]) / cellSizeX);
-        int32_t maxY = (int32_t)floorf((cy + radius - SCENE_MIN[1]) / cellSizeY);
-        int32_t maxZ = (int32_t)floorf((cz + radius - SCENE_MIN[2]) / cellSizeZ);
+    const uint32_t movePercents[3] = {1u, 10u, 100u};
+    for (uint32_t m = 0u; m < 3u; ++m)
+    {
+        const uint32_t moveCount = (GRID_BENCH_SPHERES * movePercents[m] + 99u) / 100u;
 
-        uint32_t clampedMinX = clampGridCoord(minX, GRID_RES_X);
-        uint32_t clampedMinY = clampGridCoord(minY, GRID_RES_Y);
-        uint32_t clampedMinZ = clampGridCoord(minZ, GRID_RES_Z);
-        uint32_t clampedMaxX = clampGridCoord(maxX, GRID_RES_X);
-        uint32_t clampedMaxY = clampGridCoord(maxY, GRID_RES_Y);
-        uint32_t clampedMaxZ = clampGridCoord(maxZ, GRID_RES_Z);
+        uint64_t rebuildNs = 0u;
+        size_t rebuildBytes = 0u;
+        for (uint32_t iteration = 0u; iteration < GRID_BENCH_ITERATIONS; ++iteration)
+        {
+            for (uint32_t i = 0u; i < moveCount; ++i)
+            {
+                uint32_t sphereIndex = (i * 7919u + iteration * 104729u) % GRID_BENCH_SPHERES;
+                jitterSphere(&benchSpheres.bounds, &benchSpheres.words[sphereIndex * 2u], 0.25f, &rng,
+                             &benchSpheres.words[sphereIndex * 2u]);
+            }
+            uint64_t start = gbbGetTimeNs();
+            gbbBuildSphereGrid(&benchGrid, &benchSpheres, dimX, dimY, dimZ, 0u);
+            size_t sphereBytes = (size_t)benchSpheres.count * 2u * sizeof(uint32_t);
+            size_t cellBytes = (size_t)benchGrid.cellCount * 2u * sizeof(uint32_t);
+            size_t indexBytes = (size_t)benchGrid.indexCount * sizeof(uint32_t);
+            if ((sphereBytes + cellBytes + indexBytes) <= stagingWords * sizeof(uint32_t))
+            {
+                memcpy(staging, benchSpheres.words, sphereBytes);
+                memcpy((uint8_t *)staging + sphereBytes, benchGrid.cellWords, cellBytes);
+                memcpy((uint8_t *)staging + sphereBytes + cellBytes, benchGrid.indexWords, indexBytes);
+            }
+            rebuildNs += gbbGetTimeNs() - start;
+            rebuildBytes += sphereBytes + cellBytes + indexBytes;
+        }
 
-        for (uint32_t z = clampedMinZ; z <= clampedMaxZ; ++z)
+        gbbBuildSphereGrid(&benchGrid, &benchSpheres, dimX, dimY, dimZ, ANIMATED_GRID_SLACK);
+        gbbClearDirty(&benchSpheres.dirty);
+        gbbClearDirty(&benchGrid.cellDirty);
+        gbbClearDirty(&benchGrid.indexDirty);
+        uint32_t compactionsBefore = benchGrid.compactionCount;
+        uint64_t updateNs = 0u;
+        size_t updateBytes = 0u;
+        for (uint32_t iteration = 0u; iteration < GRID_BENCH_ITERATIONS; ++iteration)
         {
-            for (uint32_t y = clampedMinY; y <= clampedMaxY; ++y)
+            for (uint32_t i = 0u; i < moveCount; ++i)
             {
-                for (uint32_t x = clampedMinX; x <= clampedMaxX; ++x)
-                {
-                    uint32_t cellIndex = x + y * GRID_RES_X + z * GRID_RES_X * GRID_RES_Y;
-                    cellHistogram[cellIndex] += 1u;
-                }
+                uint32_t sphereIndex = (i * 7919u + iteration * 104729u) % GRID_BENCH_SPHERES;
+                edits[i].op = SPHERE_EDIT_MOVE;
+                edits[i].sphereIndex = sphereIndex;
+                jitterSphere(&benchSpheres.bounds, &benchSpheres.words[sphereIndex * 2u], 0.25f, &rng, edits[i].words);
+            }
+            uint64_t start = gbbGetTimeNs();
+            if ((gbbApplySphereEdits(&benchGrid, &benchSpheres, edits, moveCount) & SPHERE_GRID_FAILED) != 0u)
+            {
+                fprintf(stderr, "grid update: out of memory applying edits\n");
             }
+            if (((size_t)benchGrid.indexCapacity + (size_t)benchGrid.cellCount * 2u + (size_t)GRID_BENCH_SPHERES * 2u) <= stagingWords)
+            {
+                uint32_t *stagingCells = staging + (size_t)GRID_BENCH_SPHERES * 2u;
+                uint32_t *stagingIndices = stagingCells + (size_t)benchGrid.cellCount * 2u;
+                updateBytes += uploadDirtyWords(&benchSpheres.dirty, benchSpheres.words, benchSpheres.count * 2u, staging);
+                updateBytes += uploadDirtyWords(&benchGrid.cellDirty, benchGrid.cellWords, benchGrid.cellCount * 2u, stagingCells);
+                updateBytes += uploadDirtyWords(&benchGrid.indexDirty, benchGrid.indexWords, benchGrid.indexCount, stagingIndices);
+            }
+            updateNs += gbbGetTimeNs() - start;
         }
+
+        printf("grid update %3u%% moving (%u spheres): rebuild %.3f ms %.1f KiB, incremental %.3f ms %.1f KiB, "
+               "speedup %.2fx, compactions %u\n",
+               movePercents[m], moveCount,
+               (double)rebuildNs * 1e-6 / GRID_BENCH_ITERATIONS,
+               (double)rebuildBytes / 1024.0 / GRID_BENCH_ITERATIONS,
+               (double)updateNs * 1e-6 / GRID_BENCH_ITERATIONS,
+               (double)updateBytes / 1024.0 / GRID_BENCH_ITERATIONS,
+               (updateNs > 0u) ? ((double)rebuildNs / (double)updateNs) : 0.0,
+               benchGrid.compactionCount - compactionsBefore);
     }
 
-    uint32_t runningOffset = 0u;
-    uint32_t nonEmptyCellCount = 0u;
-    uint32_t maxCellCount = 0u;
-    for (uint32_t cell = 0u; cell < GRID_CELL_COUNT; ++cell)
+    free(edits);
+    free(staging);
+    gbbFreeSphereGrid(&benchGrid);
+    gbbFreePackedSpheres(&benchSpheres);
+}
+
+#define SCENE_DIST_UNKNOWN 0xffffffffu
+
+// Returns SCENE_DIST_UNKNOWN after reporting a name it does not know.
+static uint32_t parseDistribution(const char *name)
+{
+    if (strcmp(name, "uniform") == 0) return SCENE_DIST_UNIFORM;
+    if (strcmp(name, "clustered") == 0) return SCENE_DIST_CLUSTERED;
+    if (strcmp(name, "stacked") == 0) return SCENE_DIST_STACKED;
+    fprintf(stderr, "unknown distribution %s (uniform, clustered, stacked)\n", name);
+    return SCENE_DIST_UNKNOWN;
+}
+
+// Generates the same scene with 1, 2, 4, ... threads and checks the packed words match.
+static int runSceneGenBenchmark(const SceneGenDesc *baseDesc)
+{
+    PackedSpheres reference = {0};
+    const uint32_t cpuCount = gbbGetCpuCount();
+    int mismatch = 0;
+    for (uint32_t threadCount = 1u; threadCount <= cpuCount; threadCount *= 2u)
     {
-        uint32_t count = cellHistogram[cell];
-        if (count > 0u)
+        SceneGenDesc desc = *baseDesc;
+        desc.threadCount = threadCount;
+        PackedSpheres generated = {0};
+        uint64_t start = gbbGetTimeNs();
+        gbbGenerateSpheres(&generated, &desc);
+        uint64_t elapsed = gbbGetTimeNs() - start;
+        uint32_t identical = 1u;
+        if (threadCount == 1u)
+        {
+            reference = generated;
+        }
+        else
+        {
+            identical = (uint32_t)((generated.count == reference.count) &&
+                                   (memcmp(generated.words, reference.words, (size_t)generated.count * 2u * sizeof(uint32_t)) == 0));
+            gbbFreePackedSpheres(&generated);
+        }
+        printf("scene gen threads %u: %u spheres in %.3f ms (%.2f M/s), extent %.1f x %.1f x %.1f, %s\n",
+               threadCount, reference.count, (double)elapsed * 1e-6,
+               (elapsed > 0u) ? ((double)reference.count * 1e3 / (double)elapsed) : 0.0,
+               reference.bounds.extent[0], reference.bounds.extent[1], reference.bounds.extent[2],
+               (identical != 0u) ? "identical" : "MISMATCH");
+        if (identical == 0u) mismatch = 1;
+    }
+    gbbFreePackedSpheres(&reference);
+    return mismatch;
+}
+
+typedef struct BatchDesc {
+    const char *path;
+    uint32_t width;
+    uint32_t height;
+    uint32_t samples;
+    uint32_t tileSize;
+} BatchDesc;
+
+// Each slot owns its tile images, readback buffer and command buffer, so one tile can
+// render while the previous slot's readback is streamed to disk.
+typedef struct BatchSlot {
+    VkImage outImage;
+    VkDeviceMemory outMemory;
+    VkImage accumImage;
+    VkDeviceMemory accumMemory;
+    VkBuffer readbackBuffer;
+    VkDeviceMemory readbackMemory;
+    void *readbackMapped;
+    VkCommandBuffer commandBuffer;
+    VkFence fence;
+    uint32_t tileX;
+    uint32_t tileY;
+    uint32_t tileWidth;
+    uint32_t tileHeight;
+    uint32_t pending;
+} BatchSlot;
+
+static VkPipeline createComputePipeline(const uint32_t *code, size_t codeSize)
+{
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    vkCreateShaderModule(device, &(VkShaderModuleCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = codeSize,
+        .pCode = code,
+    }, NULL, &shaderModule);
+
+    VkPipeline computePipeline = VK_NULL_HANDLE;
+    vkCreateComputePipelines(device, VK_NULL_HANDLE, 1u, &(VkComputePipelineCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = shaderModule,
+            .pName = "main",
+        },
+        .layout = pipelineLayout,
+        .basePipelineIndex = -1,
+    }, NULL, &computePipeline);
+
+    vkDestroyShaderModule(device, shaderModule, NULL);
+    return computePipeline;
+}
+
+static void createLayeredStorageImage(VkFormat format, uint32_t width, uint32_t height, uint32_t layers,
+                                      VkImageViewType viewType, VkImage *image, VkDeviceMemory *memory, VkImageView *view)
+{
+    vkCreateImage(device, &(VkImageCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = format,
+        .extent = {width, height, 1u},
+        .mipLevels = 1u,
+        .arrayLayers = layers,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    }, NULL, image);
+
+    VkMemoryRequirements requirements = {0};
+    vkGetImageMemoryRequirements(device, *image, &requirements);
+    vkAllocateMemory(device, &(VkMemoryAllocateInfo){
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = requirements.size,
+        .memoryTypeIndex = findMemoryTypeIndex(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+    }, NULL, memory);
+    vkBindImageMemory(device, *image, *memory, 0u);
+
+    vkCreateImageView(device, &(VkImageViewCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = *image,
+        .viewType = viewType,
+        .format = format,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .levelCount = 1u,
+            .layerCount = layers,
+        },
+    }, NULL, view);
+}
+
+static void createStorageImage(VkFormat format, uint32_t width, uint32_t height,
+                               VkImage *image, VkDeviceMemory *memory, VkImageView *view)
+{
+    createLayeredStorageImage(format, width, height, 1u, VK_IMAGE_VIEW_TYPE_2D, image, memory, view);
+}
+
+static void destroyStorageImage(VkImage *image, VkDeviceMemory *memory, VkImageView *view)
+{
+    vkDestroyImageView(device, *view, NULL);
+    vkDestroyImage(device, *image, NULL);
+    vkFreeMemory(device, *memory, NULL);
+    *view = VK_NULL_HANDLE;
+    *image = VK_NULL_HANDLE;
+    *memory = VK_NULL_HANDLE;
+}
+
+// One-off submit on the shared command buffer; only used during setup.
+static void transitionImagesToGeneral(const VkImage *images, uint32_t imageCount)
+{
+    vkResetCommandBuffer(commandBuffer, 0u);
+    vkBeginCommandBuffer(commandBuffer, &(VkCommandBufferBeginInfo){
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    });
+    for (uint32_t i = 0u; i < imageCount; ++i)
+    {
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u,
+                             0u, NULL, 0u, NULL, 1u, &(VkImageMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = images[i],
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .levelCount = 1u,
+                .layerCount = VK_REMAINING_ARRAY_LAYERS,
+            },
+        });
+    }
+    vkEndCommandBuffer(commandBuffer);
+    vkQueueSubmit(queue, 1u, &(VkSubmitInfo){
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1u,
+        .pCommandBuffers = &commandBuffer,
+    }, VK_NULL_HANDLE);
+    vkQueueWaitIdle(queue);
+}
+
+static void fillOrbitCamera(float origin[3], float forwardFov[4], const float focus[3], float yaw, float pitch, float zoom)
+{
+    const float forwardX = sinf(yaw) * cosf(pitch);
+    const float forwardY = sinf(pitch);
+    const float forwardZ = cosf(yaw) * cosf(pitch);
+    origin[0] = focus[0] - forwardX * zoom;
+    origin[1] = focus[1] - forwardY * zoom;
+    origin[2] = focus[2] - forwardZ * zoom;
+    forwardFov[0] = forwardX;
+    forwardFov[1] = forwardY;
+    forwardFov[2] = forwardZ;
+    forwardFov[3] = CAMERA_FOV;
+}
+
+static void fillCameraPushConstants(ScenePushConstants *push, const float focus[3], float zoom)
+{
+    fillOrbitCamera(push->origin, push->forward_fov, focus, CAMERA_YAW, CAMERA_PITCH, zoom);
+}
+
+// Applies the wheel and WASD state sampled at this point to the orbit camera.
+static void applyCameraInput(float focus[3], float *zoom, float deltaTime)
+{
+    const float forwardX = sinf(CAMERA_YAW) * cosf(CAMERA_PITCH);
+    const float forwardZ = cosf(CAMERA_YAW) * cosf(CAMERA_PITCH);
+    const float forwardLenXZ = sqrtf(forwardX * forwardX + forwardZ * forwardZ);
+    const float moveForwardX = forwardX / fmaxf(forwardLenXZ, 1e-6f);
+    const float moveForwardZ = forwardZ / fmaxf(forwardLenXZ, 1e-6f);
+    const float moveRightX = -moveForwardZ;
+    const float moveRightZ = moveForwardX;
+
+    float wheelDelta = 0.0f;
+    gbbConsumeMouseWheel(&wheelDelta);
+    *zoom *= expf(-wheelDelta * 0.12f);
+    *zoom = fmaxf(6.0f, fminf(80.0f, *zoom));
+
+    const float moveSpeed = 8.0f + *zoom * 0.35f;
+
+    const float moveForward = (float)gbbIsKeyDown(GBB_KEY_W) - (float)gbbIsKeyDown(GBB_KEY_S);
+    const float moveRight = (float)gbbIsKeyDown(GBB_KEY_D) - (float)gbbIsKeyDown(GBB_KEY_A);
+    float moveNorm = sqrtf(moveForward * moveForward + moveRight * moveRight);
+    float moveForwardUnit = moveForward;
+    float moveRightUnit = moveRight;
+    if (moveNorm > 1e-6f)
+    {
+        moveForwardUnit /= moveNorm;
+        moveRightUnit /= moveNorm;
+    }
+    focus[0] += (moveForwardX * moveForwardUnit + moveRightX * moveRightUnit) * moveSpeed * deltaTime;
+    focus[2] += (moveForwardZ * moveForwardUnit + moveRightZ * moveRightUnit) * moveSpeed * deltaTime;
+}
+
+// The probe grid spans the scene bounds at roughly PROBE_SPACING; with probes disabled a
+// single dummy probe keeps binding 7 valid. Probes are only touched by the GPU, so they
+// live in device-local memory and start zeroed (an update count of 0 marks them empty).
+static void createProbeCache(uint32_t enabled)
+{
+    const SceneBounds *bounds = (instancedScene.instanceCount > 0u) ? &instancedScene.worldBounds : &spheres.bounds;
+    uint32_t probeCount = 1u;
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        uint32_t dim = (uint32_t)ceilf(bounds->extent[axis] / PROBE_SPACING);
+        if (dim < 1u) dim = 1u;
+        if (dim > PROBE_MAX_DIM) dim = PROBE_MAX_DIM;
+        probeDims[axis] = (enabled != 0u) ? dim : 0u;
+        if (enabled != 0u) probeCount *= dim;
+    }
+    probeCursor = 0u;
+    probeFrame = 0u;
+    probeBufferSize = (VkDeviceSize)probeCount * 6u * 4u * sizeof(float);
+    createDeviceBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, probeBufferSize,
+                       &probeBuffer, &probeBufferMemory);
+
+    vkResetCommandBuffer(commandBuffer, 0u);
+    vkBeginCommandBuffer(commandBuffer, &(VkCommandBufferBeginInfo){
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    });
+    vkCmdFillBuffer(commandBuffer, probeBuffer, 0u, VK_WHOLE_SIZE, 0u);
+    vkEndCommandBuffer(commandBuffer);
+    vkQueueSubmit(queue, 1u, &(VkSubmitInfo){
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1u,
+        .pCommandBuffers = &commandBuffer,
+    }, VK_NULL_HANDLE);
+    vkQueueWaitIdle(queue);
+}
+
+// Bindings 8 and 9 back FRAME_MULTI_VIEW dispatches; other modes bind a single 1x1
+// layer and camera. Returns the view count, clamped to the device's layer limit.
+static uint32_t createViewTargets(uint32_t width, uint32_t height, uint32_t viewCount)
+{
+    VkPhysicalDeviceProperties deviceProps;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProps);
+    if (viewCount > deviceProps.limits.maxImageArrayLayers) viewCount = deviceProps.limits.maxImageArrayLayers;
+    createLayeredStorageImage(VK_FORMAT_R8G8B8A8_UNORM, width, height, viewCount, VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+                              &viewArrayImage, &viewArrayMemory, &viewArrayView);
+    transitionImagesToGeneral(&viewArrayImage, 1u);
+    viewCameraBufferSize = (VkDeviceSize)viewCount * sizeof(GpuViewCamera);
+    createStorageBuffer(NULL, 0u, viewCameraBufferSize, &viewCameraBuffer, &viewCameraBufferMemory, &viewCameraBufferMapped);
+    return viewCount;
+}
+
+// Traces the next PROBE_UPDATES_PER_FRAME probes ahead of the frame's own dispatches,
+// so the whole grid is refreshed every few frames at a small fixed cost. Recorded as a
+// frame graph pass, which orders it against the trace that reads the probes.
+static void recordProbeUpdate(VkCommandBuffer cmd, const float focus[3], float zoom)
+{
+    if (probeDims[0] == 0u) return;
+    const uint32_t probeCount = probeDims[0] * probeDims[1] * probeDims[2];
+    const uint32_t updates = (probeCount < PROBE_UPDATES_PER_FRAME) ? probeCount : PROBE_UPDATES_PER_FRAME;
+
+    ScenePushConstants push = {0};
+    fillCameraPushConstants(&push, focus, zoom);
+    fillScenePushConstants(&push);
+    push.frame[0] = probeFrame;
+    push.frame[3] = probeCursor;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, probePipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0u, 1u, &descriptorSets[0], 0u, NULL);
+    vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(push), &push);
+    vkCmdDispatch(cmd, updates, 1u, 1u);
+
+    probeCursor = (probeCursor + updates) % probeCount;
+    probeFrame += 1u;
+}
+
+// Sizes the primary-ray tile lists for frames up to width x height; 0 leaves binning
+// off with one-tile dummies bound. Entries grow with the sphere count since small
+// spheres mostly land in one or two tiles; tiles past the end fall back to the grid.
+static void createTileBins(uint32_t width, uint32_t height)
+{
+    tileBinWidth = width;
+    tileBinHeight = height;
+    uint32_t tileCount = 1u;
+    uint32_t entryCount = 1u;
+    if (width > 0u)
+    {
+        tileCount = ((width + BIN_TILE_SIZE - 1u) / BIN_TILE_SIZE) * ((height + BIN_TILE_SIZE - 1u) / BIN_TILE_SIZE);
+        entryCount = spheres.capacity * TILE_BIN_ENTRIES_PER_SPHERE + tileCount;
+        if (entryCount < TILE_BIN_MIN_ENTRIES) entryCount = TILE_BIN_MIN_ENTRIES;
+    }
+    tileBinBufferSize = (VkDeviceSize)tileCount * 3u * sizeof(uint32_t);
+    tileEntryBufferSize = (VkDeviceSize)entryCount * sizeof(uint32_t);
+    createDeviceBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                       tileBinBufferSize, &tileBinBuffer, &tileBinBufferMemory);
+    createDeviceBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, tileEntryBufferSize, &tileEntryBuffer, &tileEntryBufferMemory);
+}
+
+// Whether the tile lists can be rebuilt for push: not for instanced scenes or frames
+// larger than the lists were sized for.
+static uint32_t tileBinningActive(const ScenePushConstants *push)
+{
+    return (uint32_t)((tileBinWidth != 0u) && (instancedScene.instanceCount == 0u) &&
+                      (push->view[0] <= tileBinWidth) && (push->view[1] <= tileBinHeight));
+}
+
+// One step of the binning prepass without barriers: the counter clear, then BIN_PASSES
+// dispatches of tile_bin.comp (count, scan, scatter) for push's camera and frame.
+static void recordTileBinStep(VkCommandBuffer cmd, const ScenePushConstants *push, uint32_t step)
+{
+    if (step == BIN_CLEAR_STEP)
+    {
+        vkCmdFillBuffer(cmd, tileBinBuffer, 0u, VK_WHOLE_SIZE, 0u);
+        return;
+    }
+    ScenePushConstants binPush = *push;
+    binPush.frame[3] = step - 1u;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, tileBinPipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0u, 1u, &descriptorSets[0], 0u, NULL);
+    vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(binPush), &binPush);
+    vkCmdDispatch(cmd, (binPush.frame[3] == BIN_SCAN) ? 1u : ((spheres.count + BIN_DISPATCH_SIZE - 1u) / BIN_DISPATCH_SIZE), 1u, 1u);
+}
+
+// Rebuilds the tile lists with their barriers, outside a frame graph, and marks push
+// with FRAME_TILE_BINS.
+static void recordTileBinning(VkCommandBuffer cmd, ScenePushConstants *push)
+{
+    if (tileBinningActive(push) == 0u) return;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0u,
+                         0u, NULL, 0u, NULL, 0u, NULL);
+    for (uint32_t step = 0u; step < BIN_STEPS; ++step)
+    {
+        recordTileBinStep(cmd, push, step);
+        vkCmdPipelineBarrier(cmd, (step == BIN_CLEAR_STEP) ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u, 1u, &(VkMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = (step == BIN_CLEAR_STEP) ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        }, 0u, NULL, 0u, NULL);
+    }
+    push->frame[1] |= FRAME_TILE_BINS;
+}
+
+// Reservoirs and visible points for FRAME_RESTIR frames up to width x height, kept for
+// two frames so the previous one can be reprojected, after a header holding the previous
+// frame's camera; 0, or a frame past the storage buffer range, leaves ReSTIR off with a
+// one-pixel dummy bound. The first frame after a reset never reads the history, so the
+// state starts undefined.
+static void createRestirState(uint32_t width, uint32_t height)
+{
+    VkPhysicalDeviceProperties deviceProps;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProps);
+    const VkDeviceSize stateSize = sizeof(GpuViewCamera) + (VkDeviceSize)width * height * 2u * RESTIR_PIXEL_BYTES;
+    if (stateSize > deviceProps.limits.maxStorageBufferRange)
+    {
+        fprintf(stderr, "restir: %ux%u needs %.1f MB, past the storage buffer range; disabled\n", width, height,
+                (double)stateSize / (1024.0 * 1024.0));
+        width = 0u;
+        height = 0u;
+    }
+    restirWidth = width;
+    restirHeight = height;
+    restirFrame = 0u;
+    restirBufferSize = (width > 0u) ? stateSize : (sizeof(GpuViewCamera) + RESTIR_PIXEL_BYTES);
+    createDeviceBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, restirBufferSize, &restirBuffer,
+                       &restirBufferMemory);
+}
+
+static uint32_t restirActive(const ScenePushConstants *push)
+{
+    return (uint32_t)((restirWidth != 0u) && (push->view[0] <= restirWidth) && (push->view[1] <= restirHeight));
+}
+
+// Writes the previous frame's camera into the state header.
+static void recordRestirCamera(VkCommandBuffer cmd)
+{
+    GpuViewCamera previousCamera;
+    memcpy(previousCamera.origin, restirPreviousOrigin, sizeof(restirPreviousOrigin));
+    memcpy(previousCamera.forward_fov, restirPreviousForwardFov, sizeof(restirPreviousForwardFov));
+    vkCmdUpdateBuffer(cmd, restirBuffer, 0u, sizeof(previousCamera), &previousCamera);
+}
+
+// One ReSTIR dispatch (RESTIR_SAMPLE or RESTIR_SHADE) with gradient.comp and a descriptor
+// set already bound, without barriers. The shade step ends the frame.
+static void recordRestirStep(VkCommandBuffer cmd, const ScenePushConstants *push, uint32_t step)
+{
+    ScenePushConstants restirPush = *push;
+    restirPush.frame[0] = restirFrame;
+    restirPush.frame[1] |= FRAME_RESTIR;
+    restirPush.frame[3] = step;
+    if (step == RESTIR_SHADE) restirPush.frame[1] &= ~FRAME_TILE_BINS;
+    vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(restirPush), &restirPush);
+    vkCmdDispatch(cmd, (push->view[0] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE,
+                  (push->view[1] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE, 1u);
+    if (step != RESTIR_SHADE) return;
+
+    memcpy(restirPreviousOrigin, push->origin, sizeof(restirPreviousOrigin));
+    memcpy(restirPreviousForwardFov, push->forward_fov, sizeof(restirPreviousForwardFov));
+    restirFrame += 1u;
+}
+
+// Records a whole FRAME_RESTIR frame with its barriers, outside a frame graph. Returns 0
+// when the state was not sized for the frame and the caller has to trace it normally.
+static uint32_t recordRestirPasses(VkCommandBuffer cmd, const ScenePushConstants *push)
+{
+    if (restirActive(push) == 0u) return 0u;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0u,
+                         1u, &(VkMemoryBarrier){
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    }, 0u, NULL, 0u, NULL);
+    recordRestirCamera(cmd);
+    for (uint32_t step = 0u; step < RESTIR_PASSES; ++step)
+    {
+        // The sample pass writes the half the frame before last read; the shade pass
+        // reads the neighbors the sample pass just wrote.
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u, 1u, &(VkMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        }, 0u, NULL, 0u, NULL);
+        recordRestirStep(cmd, push, step);
+    }
+    return 1u;
+}
+
+// Input latency per frame that consumed an event. GPU completion is observed when the
+// CPU next waits on the frame's fence, so inputToGpu is an upper bound.
+typedef struct LatencyStats {
+    double inputToSubmitMs;
+    double inputToSubmitMaxMs;
+    double inputToGpuMs;
+    double inputToGpuMaxMs;
+    uint32_t submitCount;
+    uint32_t gpuCount;
+} LatencyStats;
+
+static void recordLatency(double *sumMs, double *maxMs, uint32_t *count, uint64_t inputTime, uint64_t now)
+{
+    const double ms = (double)(now - inputTime) * 1e-6;
+    *sumMs += ms;
+    if (ms > *maxMs) *maxMs = ms;
+    *count += 1u;
+}
+
+static void printLatencyStats(const char *label, const LatencyStats *stats)
+{
+    if (stats->submitCount == 0u) return;
+    printf("%s: input->submit %.2f ms (max %.2f), input->gpu complete %.2f ms (max %.2f) over %u inputs\n", label,
+           stats->inputToSubmitMs / (double)stats->submitCount, stats->inputToSubmitMaxMs,
+           (stats->gpuCount > 0u) ? (stats->inputToGpuMs / (double)stats->gpuCount) : 0.0, stats->inputToGpuMaxMs,
+           stats->submitCount);
+}
+
+// The traced image is copied into one of CAPTURE_SLOTS readback buffers right after the
+// dispatch; the slot is handed to the writer thread once the frame's fence signals, so
+// capturing never waits on the GPU or the disk.
+typedef struct CaptureRing {
+    Capture capture;
+    VkBuffer buffers[CAPTURE_SLOTS];
+    VkDeviceMemory memory[CAPTURE_SLOTS];
+    void *mapped[CAPTURE_SLOTS];
+    uint32_t width;
+    uint32_t height;
+    uint32_t pendingSlot;
+    uint32_t pendingFrame;
+    uint32_t frameIndex;
+    uint32_t active;
+} CaptureRing;
+
+static int startCaptureRing(CaptureRing *ring, const char *path, uint32_t width, uint32_t height, uint32_t swapRedBlue)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->width = width;
+    ring->height = height;
+    ring->pendingSlot = UINT32_MAX;
+    const VkDeviceSize size = (VkDeviceSize)width * height * 4u;
+    for (uint32_t i = 0u; i < CAPTURE_SLOTS; ++i)
+    {
+        createHostBuffer(VK_BUFFER_USAGE_TRANSFER_DST_BIT, NULL, 0u, size, &ring->buffers[i], &ring->memory[i], &ring->mapped[i]);
+    }
+    if (gbbStartCapture(&ring->capture, path, width, height, swapRedBlue, ring->mapped, CAPTURE_SLOTS) != 0)
+    {
+        for (uint32_t i = 0u; i < CAPTURE_SLOTS; ++i)
+        {
+            destroyHostBuffer(&ring->buffers[i], &ring->memory[i], &ring->mapped[i]);
+        }
+        fprintf(stderr, "failed to start capture to %s\n", path);
+        return 1;
+    }
+    ring->active = 1u;
+    printf("capturing %ux%u to %s\n", width, height, path);
+    return 0;
+}
+
+// Records the copy of image, which the caller has made readable by transfers in GENERAL
+// layout. Frames are dropped, not waited for, when the writer still holds every slot.
+static void recordCaptureCopy(CaptureRing *ring, VkCommandBuffer cmd, VkImage image)
+{
+    if (ring->active == 0u) return;
+    const uint32_t frameIndex = ring->frameIndex++;
+    uint32_t slot = 0u;
+    if (gbbAcquireCaptureSlot(&ring->capture, &slot) == 0) return;
+
+    vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_GENERAL, ring->buffers[slot], 1u, &(VkBufferImageCopy){
+        .imageSubresource = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .layerCount = 1u,
+        },
+        .imageExtent = {ring->width, ring->height, 1u},
+    });
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0u,
+                         1u, &(VkMemoryBarrier){
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    }, 0u, NULL, 0u, NULL);
+    ring->pendingSlot = slot;
+    ring->pendingFrame = frameIndex;
+}
+
+// Call after the fence of the frame that recorded the last copy has signaled.
+static void flushCaptureRing(CaptureRing *ring)
+{
+    if (ring->pendingSlot == UINT32_MAX) return;
+    gbbSubmitCaptureSlot(&ring->capture, ring->pendingSlot, ring->pendingFrame);
+    ring->pendingSlot = UINT32_MAX;
+}
+
+static void stopCaptureRing(CaptureRing *ring)
+{
+    if (ring->active == 0u) return;
+    flushCaptureRing(ring);
+    gbbStopCapture(&ring->capture);
+    printf("capture: %u frames written, %u dropped, %u failed\n", ring->capture.written, ring->capture.dropped,
+           ring->capture.failed);
+    for (uint32_t i = 0u; i < CAPTURE_SLOTS; ++i)
+    {
+        destroyHostBuffer(&ring->buffers[i], &ring->memory[i], &ring->mapped[i]);
+    }
+    ring->active = 0u;
+}
+
+// Progressive mode traces one sample pass at a time, PROGRESSIVE_TILE tiles per dispatch,
+// and each frame only records as many tiles as the measured GPU cost per tile fits into
+// the budget. A finished pass is copied to the display image, which is what every frame
+// presents, so a partial pass is never shown. The camera is latched per pass: moving
+// restarts accumulation at the next pass boundary rather than throwing away a pass.
+typedef struct ProgressiveState {
+    VkImage progressImage;
+    VkDeviceMemory progressMemory;
+    VkImageView progressView;
+    VkImage accumImage;
+    VkDeviceMemory accumMemory;
+    VkImageView accumView;
+    VkImage displayImage;
+    VkDeviceMemory displayMemory;
+    VkImageView displayView;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tilesX;
+    uint32_t tileCount;
+    uint32_t nextTile;
+    uint32_t sample;
+    uint32_t tilesInFlight;
+    uint32_t cleared;
+    float budgetMs;
+    float msPerTile;
+    float passFocus[3];
+    float passZoom;
+} ProgressiveState;
+
+static void createProgressiveState(ProgressiveState *state, uint32_t width, uint32_t height, float budgetMs)
+{
+    memset(state, 0, sizeof(*state));
+    state->width = width;
+    state->height = height;
+    state->tilesX = (width + PROGRESSIVE_TILE - 1u) / PROGRESSIVE_TILE;
+    state->tileCount = state->tilesX * ((height + PROGRESSIVE_TILE - 1u) / PROGRESSIVE_TILE);
+    state->budgetMs = budgetMs;
+    state->passZoom = -1.0f;
+    // B8G8R8A8 matches the swapchain so finished passes reach it with a plain image copy.
+    createStorageImage(VK_FORMAT_B8G8R8A8_UNORM, width, height, &state->progressImage, &state->progressMemory, &state->progressView);
+    createStorageImage(VK_FORMAT_B8G8R8A8_UNORM, width, height, &state->displayImage, &state->displayMemory, &state->displayView);
+    createStorageImage(VK_FORMAT_R32G32B32A32_SFLOAT, width, height, &state->accumImage, &state->accumMemory, &state->accumView);
+    const VkImage images[3] = {state->progressImage, state->displayImage, state->accumImage};
+    transitionImagesToGeneral(images, 3u);
+}
+
+// Feeds back the GPU time of the frame that recorded tilesInFlight tiles.
+static void updateProgressiveCost(ProgressiveState *state, float gpuMs)
+{
+    if (state->tilesInFlight == 0u) return;
+    const float msPerTile = gpuMs / (float)state->tilesInFlight;
+    state->msPerTile = (state->msPerTile > 0.0f) ? (0.75f * state->msPerTile + 0.25f * msPerTile) : msPerTile;
+    state->tilesInFlight = 0u;
+}
+
+// Frame graphs: the interactive one traces straight into the swapchain image, the
+// progressive one traces tiles into progressImage, resolves finished passes into
+// displayImage and copies that to the swapchain. Both start with the probe refresh and
+// the tile binning steps, and the interactive one replaces its trace with the ReSTIR
+// steps when the state fits the frame; the graph orders them through the buffers they
+// declare. Capture is a pass of either, enabled while a capture runs. The callbacks
+// record from context, filled in before each frame.
+typedef struct FrameGraphContext {
+    ScenePushConstants push;
+    ProgressiveState *progressive;
+    CaptureRing *captureRing;
+    VkImage swapImage;
+    VkImage captureImage;
+    float focus[3];
+    float zoom;
+    uint32_t descriptorIndex;
+    uint32_t firstTile;
+    uint32_t tiles;
+} FrameGraphContext;
+
+// User data of the passes that share a callback and differ by step.
+typedef struct FrameGraphStep {
+    FrameGraphContext *context;
+    uint32_t step;
+} FrameGraphStep;
+
+typedef struct FrameGraph {
+    RenderGraph graph;
+    FrameGraphContext context;
+    FrameGraphStep binSteps[BIN_STEPS];
+    FrameGraphStep restirSteps[RESTIR_PASSES];
+    uint32_t swapImage;
+    uint32_t probePass;
+    uint32_t binPasses[BIN_STEPS];
+    uint32_t restirCameraPass;
+    uint32_t restirPasses[RESTIR_PASSES];
+    uint32_t clearPass;
+    uint32_t tracePass;
+    uint32_t resolvePass;
+    uint32_t capturePass;
+} FrameGraph;
+
+// Handles of the scene buffers the prepasses write and the trace passes read.
+typedef struct FrameGraphBuffers {
+    uint32_t probes;
+    uint32_t tileBins;
+    uint32_t tileEntries;
+} FrameGraphBuffers;
+
+static const RenderGraphState graphComputeRead = {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                                  VK_IMAGE_LAYOUT_GENERAL};
+static const RenderGraphState graphComputeWrite = {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                                   VK_IMAGE_LAYOUT_GENERAL};
+static const RenderGraphState graphComputeReadWrite = {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                                       VK_IMAGE_LAYOUT_GENERAL};
+static const RenderGraphState graphTransferRead = {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                                                   VK_IMAGE_LAYOUT_GENERAL};
+static const RenderGraphState graphTransferWrite = {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                    VK_IMAGE_LAYOUT_GENERAL};
+static const RenderGraphState graphIdle = {VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0u, VK_IMAGE_LAYOUT_GENERAL};
+
+static void recordProbePass(VkCommandBuffer cmd, void *user)
+{
+    const FrameGraphContext *context = (const FrameGraphContext *)user;
+    recordProbeUpdate(cmd, context->focus, context->zoom);
+}
+
+static void recordTileBinPass(VkCommandBuffer cmd, void *user)
+{
+    const FrameGraphStep *step = (const FrameGraphStep *)user;
+    recordTileBinStep(cmd, &step->context->push, step->step);
+}
+
+static void recordRestirCameraPass(VkCommandBuffer cmd, void *user)
+{
+    (void)user;
+    recordRestirCamera(cmd);
+}
+
+static void recordRestirPass(VkCommandBuffer cmd, void *user)
+{
+    const FrameGraphStep *step = (const FrameGraphStep *)user;
+    FrameGraphContext *context = step->context;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0u, 1u, &descriptorSets[context->descriptorIndex], 0u, NULL);
+    recordRestirStep(cmd, &context->push, step->step);
+    if (step->step == RESTIR_SHADE) vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampQueryPool, 1u);
+}
+
+static void recordTracePass(VkCommandBuffer cmd, void *user)
+{
+    FrameGraphContext *context = (FrameGraphContext *)user;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0u, 1u, &descriptorSets[context->descriptorIndex], 0u, NULL);
+    vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(context->push), &context->push);
+    vkCmdDispatch(cmd, (context->push.view[0] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE,
+                  (context->push.view[1] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE, 1u);
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampQueryPool, 1u);
+}
+
+static void recordCapturePass(VkCommandBuffer cmd, void *user)
+{
+    FrameGraphContext *context = (FrameGraphContext *)user;
+    recordCaptureCopy(context->captureRing, cmd, context->captureImage);
+}
+
+static void recordClearPass(VkCommandBuffer cmd, void *user)
+{
+    FrameGraphContext *context = (FrameGraphContext *)user;
+    vkCmdClearColorImage(cmd, context->progressive->displayImage, VK_IMAGE_LAYOUT_GENERAL,
+                         &(VkClearColorValue){{0.0f, 0.0f, 0.0f, 1.0f}}, 1u, &(VkImageSubresourceRange){
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .levelCount = 1u,
+        .layerCount = 1u,
+    });
+}
+
+static void recordTileTracePass(VkCommandBuffer cmd, void *user)
+{
+    FrameGraphContext *context = (FrameGraphContext *)user;
+    const ProgressiveState *state = context->progressive;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0u, 1u, &descriptorSets[0], 0u, NULL);
+    for (uint32_t i = 0u; i < context->tiles; ++i)
+    {
+        const uint32_t tile = context->firstTile + i;
+        context->push.view[2] = (tile % state->tilesX) * PROGRESSIVE_TILE;
+        context->push.view[3] = (tile / state->tilesX) * PROGRESSIVE_TILE;
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(context->push), &context->push);
+        vkCmdDispatch(cmd, PROGRESSIVE_TILE / COMPUTE_TILE_SIZE, PROGRESSIVE_TILE / COMPUTE_TILE_SIZE, 1u);
+    }
+}
+
+static void recordResolvePass(VkCommandBuffer cmd, void *user)
+{
+    const ProgressiveState *state = ((FrameGraphContext *)user)->progressive;
+    vkCmdCopyImage(cmd, state->progressImage, VK_IMAGE_LAYOUT_GENERAL, state->displayImage, VK_IMAGE_LAYOUT_GENERAL,
+                   1u, &(VkImageCopy){
+        .srcSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .layerCount = 1u},
+        .dstSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .layerCount = 1u},
+        .extent = {state->width, state->height, 1u},
+    });
+}
+
+static void recordPresentCopyPass(VkCommandBuffer cmd, void *user)
+{
+    FrameGraphContext *context = (FrameGraphContext *)user;
+    const ProgressiveState *state = context->progressive;
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampQueryPool, 1u);
+    vkCmdCopyImage(cmd, state->displayImage, VK_IMAGE_LAYOUT_GENERAL, context->swapImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   1u, &(VkImageCopy){
+        .srcSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .layerCount = 1u},
+        .dstSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .layerCount = 1u},
+        .extent = {state->width, state->height, 1u},
+    });
+}
+
+// Returns 1 when none of handles is RENDER_GRAPH_INVALID, which a graph past its limits
+// hands out.
+static uint32_t graphHandlesValid(const uint32_t *handles, uint32_t count)
+{
+    for (uint32_t i = 0u; i < count; ++i)
+    {
+        if (handles[i] == RENDER_GRAPH_INVALID) return 0u;
+    }
+    return 1u;
+}
+
+// Imports the scene buffers and declares the probe refresh and the binning steps, which
+// start disabled; enableFrameBinning turns the steps on per frame. Returns 0 when every
+// buffer and pass was added.
+static int addScenePrepasses(FrameGraph *frame, FrameGraphBuffers *buffers)
+{
+    RenderGraph *graph = &frame->graph;
+    buffers->probes = gbbAddGraphBuffer(graph, "probes", probeBuffer, graphIdle);
+    buffers->tileBins = gbbAddGraphBuffer(graph, "tile bins", tileBinBuffer, graphIdle);
+    buffers->tileEntries = gbbAddGraphBuffer(graph, "tile entries", tileEntryBuffer, graphIdle);
+
+    frame->probePass = gbbAddGraphPass(graph, "probes", recordProbePass, &frame->context);
+    gbbGraphPassUse(graph, frame->probePass, buffers->probes, graphComputeReadWrite);
+    gbbEnableGraphPass(graph, frame->probePass, (uint32_t)(probeDims[0] != 0u));
+
+    static const char *const binNames[BIN_STEPS] = {"bin clear", "bin count", "bin scan", "bin scatter"};
+    for (uint32_t step = 0u; step < BIN_STEPS; ++step)
+    {
+        frame->binSteps[step] = (FrameGraphStep){&frame->context, step};
+        const uint32_t pass = gbbAddGraphPass(graph, binNames[step], recordTileBinPass, &frame->binSteps[step]);
+        frame->binPasses[step] = pass;
+        gbbGraphPassUse(graph, pass, buffers->tileBins, (step == BIN_CLEAR_STEP) ? graphTransferWrite : graphComputeReadWrite);
+        if (step + 1u == BIN_STEPS) gbbGraphPassUse(graph, pass, buffers->tileEntries, graphComputeWrite);
+        gbbEnableGraphPass(graph, pass, 0u);
+    }
+    const uint32_t handles[] = {buffers->probes, buffers->tileBins, buffers->tileEntries, frame->probePass};
+    return ((graphHandlesValid(handles, 4u) != 0u) && (graphHandlesValid(frame->binPasses, BIN_STEPS) != 0u)) ? 0 : 1;
+}
+
+// Trace passes read whichever scene buffers the frame's flags select.
+static void useSceneBuffers(FrameGraph *frame, uint32_t pass, const FrameGraphBuffers *buffers)
+{
+    gbbGraphPassUse(&frame->graph, pass, buffers->probes, graphComputeRead);
+    gbbGraphPassUse(&frame->graph, pass, buffers->tileBins, graphComputeRead);
+    gbbGraphPassUse(&frame->graph, pass, buffers->tileEntries, graphComputeRead);
+}
+
+// Enables the binning steps when the tile lists fit context.push and marks it with
+// FRAME_TILE_BINS; tracing == 0 leaves them off.
+static void enableFrameBinning(FrameGraph *frame, uint32_t tracing)
+{
+    const uint32_t binning = (uint32_t)((tracing != 0u) && (tileBinningActive(&frame->context.push) != 0u));
+    if (binning != 0u) frame->context.push.frame[1] |= FRAME_TILE_BINS;
+    for (uint32_t step = 0u; step < BIN_STEPS; ++step)
+    {
+        gbbEnableGraphPass(&frame->graph, frame->binPasses[step], binning);
+    }
+}
+
+static int buildInteractiveGraph(FrameGraph *frame, CaptureRing *captureRing)
+{
+    RenderGraph *graph = &frame->graph;
+    gbbInitRenderGraph(graph, "interactive");
+    frame->context.captureRing = captureRing;
+    frame->swapImage = gbbAddGraphImage(graph, "swapchain", VK_NULL_HANDLE, (RenderGraphState){0});
+    gbbSetGraphFinalState(graph, frame->swapImage,
+                          (RenderGraphState){VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0u, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR});
+    FrameGraphBuffers buffers;
+    if (addScenePrepasses(frame, &buffers) != 0) return 1;
+    const uint32_t restir = gbbAddGraphBuffer(graph, "restir", restirBuffer, graphIdle);
+
+    frame->restirCameraPass = gbbAddGraphPass(graph, "restir camera", recordRestirCameraPass, NULL);
+    gbbGraphPassUse(graph, frame->restirCameraPass, restir, graphTransferWrite);
+    static const char *const restirNames[RESTIR_PASSES] = {"restir sample", "restir shade"};
+    for (uint32_t step = 0u; step < RESTIR_PASSES; ++step)
+    {
+        frame->restirSteps[step] = (FrameGraphStep){&frame->context, step};
+        const uint32_t pass = gbbAddGraphPass(graph, restirNames[step], recordRestirPass, &frame->restirSteps[step]);
+        frame->restirPasses[step] = pass;
+        gbbGraphPassUse(graph, pass, restir, (step == RESTIR_SAMPLE) ? graphComputeReadWrite : graphComputeRead);
+        if (step == RESTIR_SHADE) gbbGraphPassUse(graph, pass, frame->swapImage, graphComputeWrite);
+        useSceneBuffers(frame, pass, &buffers);
+    }
+
+    frame->tracePass = gbbAddGraphPass(graph, "trace", recordTracePass, &frame->context);
+    gbbGraphPassUse(graph, frame->tracePass, frame->swapImage, graphComputeWrite);
+    useSceneBuffers(frame, frame->tracePass, &buffers);
+    frame->capturePass = gbbAddGraphPass(graph, "capture", recordCapturePass, &frame->context);
+    gbbGraphPassUse(graph, frame->capturePass, frame->swapImage, graphTransferRead);
+    gbbEnableGraphPass(graph, frame->capturePass, captureRing->active);
+    const uint32_t handles[] = {frame->swapImage, restir, frame->restirCameraPass, frame->restirPasses[RESTIR_SAMPLE],
+                                frame->restirPasses[RESTIR_SHADE], frame->tracePass, frame->capturePass};
+    if (graphHandlesValid(handles, sizeof(handles) / sizeof(handles[0])) == 0u) return 1;
+    return gbbCompileRenderGraph(graph, physicalDevice, device);
+}
+
+// Fills context.push for the interactive frame and picks the ReSTIR steps or the plain
+// trace for it.
+static void prepareInteractiveFrame(FrameGraph *frame, uint32_t width, uint32_t height, uint32_t descriptorIndex)
+{
+    FrameGraphContext *context = &frame->context;
+    context->push = (ScenePushConstants){
+        .view = {width, height, 0u, 0u},
+    };
+    fillCameraPushConstants(&context->push, context->focus, context->zoom);
+    fillScenePushConstants(&context->push);
+    context->descriptorIndex = descriptorIndex;
+    enableFrameBinning(frame, 1u);
+
+    const uint32_t restir = restirActive(&context->push);
+    gbbEnableGraphPass(&frame->graph, frame->restirCameraPass, restir);
+    for (uint32_t step = 0u; step < RESTIR_PASSES; ++step)
+    {
+        gbbEnableGraphPass(&frame->graph, frame->restirPasses[step], restir);
+    }
+    gbbEnableGraphPass(&frame->graph, frame->tracePass, (uint32_t)(restir == 0u));
+}
+
+static int buildProgressiveGraph(FrameGraph *frame, ProgressiveState *state, CaptureRing *captureRing)
+{
+    RenderGraph *graph = &frame->graph;
+    gbbInitRenderGraph(graph, "progressive");
+    frame->context.progressive = state;
+    frame->context.captureRing = captureRing;
+    frame->context.captureImage = state->displayImage;
+    frame->swapImage = gbbAddGraphImage(graph, "swapchain", VK_NULL_HANDLE, (RenderGraphState){0});
+    gbbSetGraphFinalState(graph, frame->swapImage,
+                          (RenderGraphState){VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0u, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR});
+    const uint32_t progress = gbbAddGraphImage(graph, "progress", state->progressImage, graphIdle);
+    const uint32_t accum = gbbAddGraphImage(graph, "accum", state->accumImage, graphIdle);
+    const uint32_t display = gbbAddGraphImage(graph, "display", state->displayImage, graphIdle);
+    FrameGraphBuffers buffers;
+    if (addScenePrepasses(frame, &buffers) != 0) return 1;
+
+    frame->clearPass = gbbAddGraphPass(graph, "clear", recordClearPass, &frame->context);
+    gbbGraphPassUse(graph, frame->clearPass, display, graphTransferWrite);
+    frame->tracePass = gbbAddGraphPass(graph, "trace", recordTileTracePass, &frame->context);
+    gbbGraphPassUse(graph, frame->tracePass, progress, graphComputeWrite);
+    gbbGraphPassUse(graph, frame->tracePass, accum, graphComputeReadWrite);
+    useSceneBuffers(frame, frame->tracePass, &buffers);
+    frame->resolvePass = gbbAddGraphPass(graph, "resolve", recordResolvePass, &frame->context);
+    gbbGraphPassUse(graph, frame->resolvePass, progress, graphTransferRead);
+    gbbGraphPassUse(graph, frame->resolvePass, display, graphTransferWrite);
+    const uint32_t presentPass = gbbAddGraphPass(graph, "present", recordPresentCopyPass, &frame->context);
+    gbbGraphPassUse(graph, presentPass, display, graphTransferRead);
+    gbbGraphPassUse(graph, presentPass, frame->swapImage,
+                    (RenderGraphState){VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL});
+    frame->capturePass = gbbAddGraphPass(graph, "capture", recordCapturePass, &frame->context);
+    gbbGraphPassUse(graph, frame->capturePass, display, graphTransferRead);
+    gbbEnableGraphPass(graph, frame->capturePass, captureRing->active);
+    const uint32_t handles[] = {frame->swapImage, progress, accum, display, frame->clearPass, frame->tracePass,
+                                frame->resolvePass, presentPass, frame->capturePass};
+    if (graphHandlesValid(handles, sizeof(handles) / sizeof(handles[0])) == 0u) return 1;
+    return gbbCompileRenderGraph(graph, physicalDevice, device);
+}
+
+// Records this frame's share of the current pass and the copy of the display image into
+// the swapchain image bound to the graph.
+static void recordProgressiveFrame(ProgressiveState *state, FrameGraph *frame, VkCommandBuffer cmd,
+                                   const float focus[3], float zoom)
+{
+    if (state->nextTile == 0u)
+    {
+        const uint32_t moved = (uint32_t)((focus[0] != state->passFocus[0]) || (focus[1] != state->passFocus[1]) ||
+                                          (focus[2] != state->passFocus[2]) || (zoom != state->passZoom));
+        if (moved != 0u)
+        {
+            memcpy(state->passFocus, focus, sizeof(state->passFocus));
+            state->passZoom = zoom;
+            state->sample = 0u;
+        }
+    }
+
+    FrameGraphContext *context = &frame->context;
+    context->firstTile = state->nextTile;
+    context->tiles = 0u;
+    uint32_t resolve = 0u;
+    if (state->sample < PROGRESSIVE_MAX_SAMPLES)
+    {
+        const uint32_t remaining = state->tileCount - state->nextTile;
+        uint32_t tiles = (state->msPerTile > 0.0f) ? (uint32_t)(state->budgetMs / state->msPerTile) : 1u;
+        if (tiles < 1u) tiles = 1u;
+        if (tiles > remaining) tiles = remaining;
+
+        context->push = (ScenePushConstants){
+            .view = {state->width, state->height, 0u, 0u},
+            .frame = {state->sample, FRAME_ACCUMULATE | FRAME_RESOLVE | FRAME_FULL_IMAGE, 0u, 0u},
+        };
+        fillCameraPushConstants(&context->push, state->passFocus, state->passZoom);
+        fillScenePushConstants(&context->push);
+        context->tiles = tiles;
+        state->nextTile += tiles;
+        state->tilesInFlight = tiles;
+        if (state->nextTile == state->tileCount)
+        {
+            resolve = 1u;
+            state->nextTile = 0u;
+            state->sample += 1u;
+        }
+    }
+
+    enableFrameBinning(frame, (uint32_t)(context->tiles != 0u));
+    gbbEnableGraphPass(&frame->graph, frame->clearPass, (uint32_t)(state->cleared == 0u));
+    gbbEnableGraphPass(&frame->graph, frame->tracePass, (uint32_t)(context->tiles != 0u));
+    gbbEnableGraphPass(&frame->graph, frame->resolvePass, resolve);
+    state->cleared = 1u;
+    vkCmdResetQueryPool(cmd, timestampQueryPool, 0u, 2u);
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, 0u);
+    gbbExecuteRenderGraph(&frame->graph, cmd);
+}
+
+// Records samples [sampleBegin, sampleEnd) of the slot's tile, resolving on the last one
+// of the image, and the copy of copyImage to the readback buffer. A range that starts
+// past sample 0 clears the accumulator first, so it holds that range's sum alone.
+static void recordBatchTile(BatchSlot *slot, uint32_t slotIndex, ScenePushConstants *push, uint32_t frameFlags,
+                            uint32_t sampleBegin, uint32_t sampleEnd, VkImage copyImage)
+{
+    VkCommandBuffer cmd = slot->commandBuffer;
+    vkResetCommandBuffer(cmd, 0u);
+    vkBeginCommandBuffer(cmd, &(VkCommandBufferBeginInfo){
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    });
+    if (sampleBegin > 0u)
+    {
+        vkCmdClearColorImage(cmd, slot->accumImage, VK_IMAGE_LAYOUT_GENERAL, &(VkClearColorValue){{0.0f, 0.0f, 0.0f, 0.0f}},
+                             1u, &(VkImageSubresourceRange){
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .levelCount = 1u,
+            .layerCount = 1u,
+        });
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u,
+                             1u, &(VkMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        }, 0u, NULL, 0u, NULL);
+    }
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0u, 1u, &descriptorSets[slotIndex], 0u, NULL);
+    push->view[2] = slot->tileX;
+    push->view[3] = slot->tileY;
+    for (uint32_t sample = sampleBegin; sample < sampleEnd; ++sample)
+    {
+        const uint32_t lastSample = (uint32_t)(sample + 1u == sampleEnd);
+        push->frame[0] = sample;
+        push->frame[1] = frameFlags | FRAME_ACCUMULATE | ((lastSample != 0u) ? FRAME_RESOLVE : 0u);
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(*push), push);
+        vkCmdDispatch(cmd, (slot->tileWidth + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE,
+                      (slot->tileHeight + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE, 1u);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             (lastSample != 0u) ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u,
+                             1u, &(VkMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = (lastSample != 0u) ? VK_ACCESS_TRANSFER_READ_BIT
+                                                : (VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT),
+        }, 0u, NULL, 0u, NULL);
+    }
+    vkCmdCopyImageToBuffer(cmd, copyImage, VK_IMAGE_LAYOUT_GENERAL, slot->readbackBuffer, 1u, &(VkBufferImageCopy){
+        .imageSubresource = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .layerCount = 1u,
+        },
+        .imageExtent = {slot->tileWidth, slot->tileHeight, 1u},
+    });
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0u,
+                         1u, &(VkMemoryBarrier){
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    }, 0u, NULL, 0u, NULL);
+    vkEndCommandBuffer(cmd);
+
+    vkQueueSubmit(queue, 1u, &(VkSubmitInfo){
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1u,
+        .pCommandBuffers = &cmd,
+    }, slot->fence);
+    slot->pending = 1u;
+}
+
+// Creates the tile images, readback buffers (texelSize bytes a texel), command buffers
+// and fences of the BATCH_SLOTS slots and points descriptor set i at slot i.
+static void createBatchSlots(BatchSlot *slots, uint32_t tileSize, VkDeviceSize texelSize)
+{
+    VkImage slotImages[BATCH_SLOTS * 2u];
+    memset(slots, 0, BATCH_SLOTS * sizeof(BatchSlot));
+    for (uint32_t i = 0u; i < BATCH_SLOTS; ++i)
+    {
+        BatchSlot *slot = &slots[i];
+        createStorageImage(VK_FORMAT_R8G8B8A8_UNORM, tileSize, tileSize, &slot->outImage, &slot->outMemory, &outputImageViews[i]);
+        createStorageImage(VK_FORMAT_R32G32B32A32_SFLOAT, tileSize, tileSize, &slot->accumImage, &slot->accumMemory, &accumImageViews[i]);
+        createHostBuffer(VK_BUFFER_USAGE_TRANSFER_DST_BIT, NULL, 0u, (VkDeviceSize)tileSize * tileSize * texelSize,
+                         &slot->readbackBuffer, &slot->readbackMemory, &slot->readbackMapped);
+        vkAllocateCommandBuffers(device, &(VkCommandBufferAllocateInfo){
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = commandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1u,
+        }, &slot->commandBuffer);
+        vkCreateFence(device, &(VkFenceCreateInfo){
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO
+        }, NULL, &slot->fence);
+        slotImages[i * 2u + 0u] = slot->outImage;
+        slotImages[i * 2u + 1u] = slot->accumImage;
+    }
+    writeSceneDescriptors(BATCH_SLOTS);
+    transitionImagesToGeneral(slotImages, BATCH_SLOTS * 2u);
+}
+
+static void destroyBatchSlots(BatchSlot *slots)
+{
+    vkDeviceWaitIdle(device);
+    for (uint32_t i = 0u; i < BATCH_SLOTS; ++i)
+    {
+        BatchSlot *slot = &slots[i];
+        destroyStorageImage(&slot->outImage, &slot->outMemory, &outputImageViews[i]);
+        destroyStorageImage(&slot->accumImage, &slot->accumMemory, &accumImageViews[i]);
+        destroyHostBuffer(&slot->readbackBuffer, &slot->readbackMemory, &slot->readbackMapped);
+        vkFreeCommandBuffers(device, commandPool, 1u, &slot->commandBuffer);
+        vkDestroyFence(device, slot->fence, NULL);
+    }
+}
+
+// The camera is fixed, so the tile lists are built once. Workgroups must not straddle bin
+// tiles, which holds when batch tiles start on the bin grid; other tile sizes trace
+// unbinned.
+static void buildStaticTileBins(ScenePushConstants *push, uint32_t tileSize)
+{
+    if ((tileSize % BIN_TILE_SIZE) == 0u)
+    {
+        vkResetCommandBuffer(commandBuffer, 0u);
+        vkBeginCommandBuffer(commandBuffer, &(VkCommandBufferBeginInfo){
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        });
+        recordTileBinning(commandBuffer, push);
+        vkEndCommandBuffer(commandBuffer);
+        vkQueueSubmit(queue, 1u, &(VkSubmitInfo){
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount = 1u,
+            .pCommandBuffers = &commandBuffer,
+        }, VK_NULL_HANDLE);
+        vkQueueWaitIdle(queue);
+    }
+}
+
+// Renders the frame tile by tile: every sample is one dispatch accumulating into the
+// tile's float image, the last one resolves to RGBA8, and the tile is copied to a
+// readback buffer that is written out once its fence signals. Memory stays at
+// BATCH_SLOTS tiles regardless of the output size.
+static int runBatchRender(const BatchDesc *batch)
+{
+    ImageFile file = {0};
+    if (gbbOpenImageFile(&file, batch->path, batch->width, batch->height) != 0)
+    {
+        fprintf(stderr, "failed to open %s\n", batch->path);
+        return 1;
+    }
+    const uint32_t floatOutput = (uint32_t)(file.format == IMAGE_FILE_PFM);
+    const VkDeviceSize texelSize = (floatOutput != 0u) ? 16u : 4u;
+    const uint32_t tileSize = batch->tileSize;
+    const uint32_t tilesX = (batch->width + tileSize - 1u) / tileSize;
+    const uint32_t tilesY = (batch->height + tileSize - 1u) / tileSize;
+    const uint32_t tileCount = tilesX * tilesY;
+
+    BatchSlot slots[BATCH_SLOTS];
+    createBatchSlots(slots, tileSize, texelSize);
+
+    ScenePushConstants push = {0};
+    const float cameraFocus[3] = {0.0f, 0.0f, 0.0f};
+    fillCameraPushConstants(&push, cameraFocus, CAMERA_DEFAULT_ZOOM);
+    fillScenePushConstants(&push);
+    push.view[0] = batch->width;
+    push.view[1] = batch->height;
+    buildStaticTileBins(&push, tileSize);
+    const uint32_t frameFlags = push.frame[1];
+
+    int result = 0;
+    uint32_t tilesWritten = 0u;
+    const uint64_t start = gbbGetTimeNs();
+    for (uint32_t tile = 0u; tile < tileCount + BATCH_SLOTS; ++tile)
+    {
+        BatchSlot *slot = &slots[tile % BATCH_SLOTS];
+        if (slot->pending != 0u)
+        {
+            vkWaitForFences(device, 1u, &slot->fence, VK_TRUE, UINT64_MAX);
+            vkResetFences(device, 1u, &slot->fence);
+            if (gbbWriteImageTile(&file, slot->tileX, slot->tileY, slot->tileWidth, slot->tileHeight,
+                                  slot->readbackMapped, (size_t)(slot->tileWidth * texelSize)) != 0)
+            {
+                result = 1;
+            }
+            slot->pending = 0u;
+            tilesWritten += 1u;
+            if ((tilesWritten % tilesX) == 0u)
+            {
+                printf("batch: %u/%u tiles\n", tilesWritten, tileCount);
+            }
+        }
+        if ((tile >= tileCount) || (result != 0)) continue;
+
+        const uint32_t slotIndex = tile % BATCH_SLOTS;
+        slot->tileX = (tile % tilesX) * tileSize;
+        slot->tileY = (tile / tilesX) * tileSize;
+        slot->tileWidth = (batch->width - slot->tileX < tileSize) ? (batch->width - slot->tileX) : tileSize;
+        slot->tileHeight = (batch->height - slot->tileY < tileSize) ? (batch->height - slot->tileY) : tileSize;
+        recordBatchTile(slot, slotIndex, &push, frameFlags, 0u, batch->samples,
+                        (floatOutput != 0u) ? slot->accumImage : slot->outImage);
+    }
+    const uint64_t elapsed = gbbGetTimeNs() - start;
+    if (gbbCloseImageFile(&file) != 0) result = 1;
+
+    destroyBatchSlots(slots);
+
+    const double seconds = (double)elapsed * 1e-9;
+    printf("batch %ux%u, %u spp, %u tiles of %u px in %.2f s (%.1f Msamples/s) -> %s%s\n",
+           batch->width, batch->height, batch->samples, tileCount, tileSize, seconds,
+           (seconds > 0.0) ? ((double)batch->width * batch->height * batch->samples * 1e-6 / seconds) : 0.0,
+           batch->path, (result != 0) ? " (write failed)" : "");
+    return result;
+}
+
+// FNV-1a over the camera, scene constants and sphere words, so a coordinator can refuse a
+// worker that loaded a different scene.
+static void hashWorkerScene(const ScenePushConstants *push, uint32_t hash[2])
+{
+    uint64_t value = 0xcbf29ce484222325ull;
+    const uint8_t *bytes = (const uint8_t *)push;
+    for (size_t i = 0u; i < sizeof(*push); ++i)
+    {
+        value = (value ^ bytes[i]) * 0x100000001b3ull;
+    }
+    bytes = (const uint8_t *)spheres.words;
+    for (size_t i = 0u; i < (size_t)spheres.count * 2u * sizeof(uint32_t); ++i)
+    {
+        value = (value ^ bytes[i]) * 0x100000001b3ull;
+    }
+    hash[0] = (uint32_t)value;
+    hash[1] = (uint32_t)(value >> 32);
+}
+
+// Renders assignments from a coordinator at address (host:port) until it sends the done
+// marker, returning each range's float sum. Slots overlap the GPU work of one
+// assignment with the transfer of the previous one.
+static int runRenderWorker(const char *address)
+{
+    char host[256];
+    const char *colon = strrchr(address, ':');
+    if ((colon == NULL) || ((size_t)(colon - address) >= sizeof(host)))
+    {
+        fprintf(stderr, "--worker expects host:port\n");
+        return 1;
+    }
+    memcpy(host, address, (size_t)(colon - address));
+    host[colon - address] = '\0';
+    void *stream = gbbConnectSocket(host, (uint16_t)strtoul(colon + 1, NULL, 10));
+    if (stream == NULL)
+    {
+        fprintf(stderr, "worker: failed to connect to %s\n", address);
+        return 1;
+    }
+
+    ScenePushConstants push = {0};
+    const float cameraFocus[3] = {0.0f, 0.0f, 0.0f};
+    fillCameraPushConstants(&push, cameraFocus, CAMERA_DEFAULT_ZOOM);
+    fillScenePushConstants(&push);
+    VkPhysicalDeviceProperties deviceProps;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProps);
+    DistributeHello hello = {.magic = DISTRIBUTE_MAGIC, .version = DISTRIBUTE_VERSION};
+    hashWorkerScene(&push, hello.sceneHash);
+    snprintf(hello.device, sizeof(hello.device), "%s", deviceProps.deviceName);
+    DistributeJob job = {0};
+    if ((gbbSendAll(stream, &hello, sizeof(hello)) != 0) || (gbbRecvAll(stream, &job, sizeof(job)) != 0) ||
+        (job.magic != DISTRIBUTE_MAGIC) || (job.tileSize == 0u))
+    {
+        fprintf(stderr, "worker: rejected by %s\n", address);
+        gbbCloseSocket(stream);
+        return 1;
+    }
+    const uint32_t tileSize = job.tileSize;
+    const uint32_t tilesX = (job.width + tileSize - 1u) / tileSize;
+    const VkDeviceSize texelSize = 16u;
+
+    BatchSlot slots[BATCH_SLOTS];
+    createBatchSlots(slots, tileSize, texelSize);
+
+    push.view[0] = job.width;
+    push.view[1] = job.height;
+    buildStaticTileBins(&push, tileSize);
+    const uint32_t frameFlags = push.frame[1];
+
+    int result = 0;
+    uint32_t done = 0u;
+    uint32_t idle = 0u;
+    uint32_t pendingCount = 0u;
+    uint32_t assignments = 0u;
+    uint64_t samplesRendered = 0u;
+    DistributeResult pendingResults[BATCH_SLOTS];
+    const uint64_t start = gbbGetTimeNs();
+    for (uint32_t slotIndex = 0u; (result == 0) && ((done == 0u) || (pendingCount > 0u));
+         slotIndex = (slotIndex + 1u) % BATCH_SLOTS)
+    {
+        BatchSlot *slot = &slots[slotIndex];
+        if (slot->pending != 0u)
+        {
+            vkWaitForFences(device, 1u, &slot->fence, VK_TRUE, UINT64_MAX);
+            vkResetFences(device, 1u, &slot->fence);
+            slot->pending = 0u;
+            pendingCount -= 1u;
+            if ((gbbSendAll(stream, &pendingResults[slotIndex], sizeof(DistributeResult)) != 0) ||
+                (gbbSendAll(stream, slot->readbackMapped, (size_t)(slot->tileWidth * slot->tileHeight * texelSize)) != 0))
+            {
+                result = 1;
+            }
+        }
+        if ((done != 0u) || (result != 0) || (pendingCount >= DISTRIBUTE_WINDOW)) continue;
+        // An idle worker hands in everything it has before asking again.
+        if ((idle != 0u) && (pendingCount > 0u)) continue;
+
+        DistributeAssignment assignment;
+        if (gbbRecvAll(stream, &assignment, sizeof(assignment)) != 0)
+        {
+            result = 1;
+            continue;
+        }
+        idle = (uint32_t)(assignment.tile == DISTRIBUTE_IDLE);
+        if (assignment.tile == DISTRIBUTE_DONE)
+        {
+            done = 1u;
+            continue;
+        }
+        if (idle != 0u) continue;
+        if ((assignment.tile >= tilesX * ((job.height + tileSize - 1u) / tileSize)) ||
+            (assignment.sampleBegin >= assignment.sampleEnd))
+        {
+            result = 1;
+            continue;
+        }
+        slot->tileX = (assignment.tile % tilesX) * tileSize;
+        slot->tileY = (assignment.tile / tilesX) * tileSize;
+        slot->tileWidth = (job.width - slot->tileX < tileSize) ? (job.width - slot->tileX) : tileSize;
+        slot->tileHeight = (job.height - slot->tileY < tileSize) ? (job.height - slot->tileY) : tileSize;
+        pendingResults[slotIndex] = (DistributeResult){
+            .tile = assignment.tile,
+            .sampleBegin = assignment.sampleBegin,
+            .sampleEnd = assignment.sampleEnd,
+            .width = slot->tileWidth,
+            .height = slot->tileHeight,
+        };
+        recordBatchTile(slot, slotIndex, &push, frameFlags, assignment.sampleBegin, assignment.sampleEnd, slot->accumImage);
+        pendingCount += 1u;
+        assignments += 1u;
+        samplesRendered += (uint64_t)slot->tileWidth * slot->tileHeight * (assignment.sampleEnd - assignment.sampleBegin);
+    }
+    const uint64_t elapsed = gbbGetTimeNs() - start;
+    gbbCloseSocket(stream);
+
+    destroyBatchSlots(slots);
+
+    const double seconds = (double)elapsed * 1e-9;
+    printf("worker %s: %u assignments in %.2f s (%.1f Msamples/s)%s\n", deviceProps.deviceName, assignments, seconds,
+           (seconds > 0.0) ? ((double)samplesRendered * 1e-6 / seconds) : 0.0, (result != 0) ? " (connection lost)" : "");
+    return result;
+}
+
+#define OFFSCREEN_MAX_READBACKS 4u
+
+// Output and accumulation targets bound through set 0, plus host readbacks, shared by
+// the offscreen A/B harnesses below.
+typedef struct OffscreenFixture {
+    uint32_t width;
+    uint32_t height;
+    VkImage outImage;
+    VkDeviceMemory outMemory;
+    VkImage accumImage;
+    VkDeviceMemory accumMemory;
+    uint32_t readbackCount;
+    VkBuffer readbackBuffers[OFFSCREEN_MAX_READBACKS];
+    VkDeviceMemory readbackMemory[OFFSCREEN_MAX_READBACKS];
+    void *readbackMapped[OFFSCREEN_MAX_READBACKS];
+    double timestampMs;
+} OffscreenFixture;
+
+// Copies image (the fixture's output image when VK_NULL_HANDLE) into a readback buffer.
+typedef struct OffscreenReadback {
+    uint32_t buffer;
+    VkDeviceSize offset;
+    VkImage image;
+    uint32_t layers;
+} OffscreenReadback;
+
+typedef void (*OffscreenRecordFn)(VkCommandBuffer cmd, void *user);
+
+// accumulate == 0 leaves a 1x1 accumulation image for passes that never touch it.
+static void createOffscreenFixture(OffscreenFixture *fixture, uint32_t width, uint32_t height, uint32_t accumulate,
+                                   const VkDeviceSize *readbackSizes, uint32_t readbackCount)
+{
+    *fixture = (OffscreenFixture){
+        .width = width,
+        .height = height,
+        .readbackCount = readbackCount,
+    };
+    VkPhysicalDeviceProperties deviceProps;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProps);
+    fixture->timestampMs = (double)deviceProps.limits.timestampPeriod * 1e-6;
+
+    createStorageImage(VK_FORMAT_R8G8B8A8_UNORM, width, height, &fixture->outImage, &fixture->outMemory, &outputImageViews[0]);
+    createStorageImage(VK_FORMAT_R32G32B32A32_SFLOAT, (accumulate != 0u) ? width : 1u, (accumulate != 0u) ? height : 1u,
+                       &fixture->accumImage, &fixture->accumMemory, &accumImageViews[0]);
+    const VkImage images[2] = {fixture->outImage, fixture->accumImage};
+    transitionImagesToGeneral(images, 2u);
+    writeSceneDescriptors(1u);
+    for (uint32_t i = 0u; i < readbackCount; ++i)
+    {
+        createHostBuffer(VK_BUFFER_USAGE_TRANSFER_DST_BIT, NULL, 0u, readbackSizes[i], &fixture->readbackBuffers[i],
+                         &fixture->readbackMemory[i], &fixture->readbackMapped[i]);
+    }
+}
+
+static void destroyOffscreenFixture(OffscreenFixture *fixture)
+{
+    for (uint32_t i = 0u; i < fixture->readbackCount; ++i)
+    {
+        destroyHostBuffer(&fixture->readbackBuffers[i], &fixture->readbackMemory[i], &fixture->readbackMapped[i]);
+    }
+    destroyStorageImage(&fixture->outImage, &fixture->outMemory, &outputImageViews[0]);
+    destroyStorageImage(&fixture->accumImage, &fixture->accumMemory, &accumImageViews[0]);
+}
+
+// Records one submission with the trace pipeline bound: record() between timestamp 0
+// and timestamp timestampCount - 1 (it may write the ones in between), then the optional
+// readback copy and a host barrier. Waits for the queue and returns the timestamps.
+static void submitAndReadback(OffscreenFixture *fixture, OffscreenRecordFn record, void *user,
+                              const OffscreenReadback *readback, uint64_t *timestamps, uint32_t timestampCount)
+{
+    vkResetCommandBuffer(commandBuffer, 0u);
+    vkBeginCommandBuffer(commandBuffer, &(VkCommandBufferBeginInfo){
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    });
+    if (timestampCount > 0u)
+    {
+        vkCmdResetQueryPool(commandBuffer, timestampQueryPool, 0u, timestampCount);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, 0u);
+    }
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0u, 1u, &descriptorSets[0], 0u, NULL);
+    record(commandBuffer, user);
+    if (timestampCount > 0u)
+    {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampQueryPool, timestampCount - 1u);
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0u,
+                         1u, &(VkMemoryBarrier){
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+    }, 0u, NULL, 0u, NULL);
+    if (readback != NULL)
+    {
+        vkCmdCopyImageToBuffer(commandBuffer, (readback->image != VK_NULL_HANDLE) ? readback->image : fixture->outImage,
+                               VK_IMAGE_LAYOUT_GENERAL, fixture->readbackBuffers[readback->buffer], 1u, &(VkBufferImageCopy){
+            .bufferOffset = readback->offset,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .layerCount = (readback->layers > 0u) ? readback->layers : 1u,
+            },
+            .imageExtent = {fixture->width, fixture->height, 1u},
+        });
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0u,
+                         1u, &(VkMemoryBarrier){
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    }, 0u, NULL, 0u, NULL);
+    vkEndCommandBuffer(commandBuffer);
+    vkQueueSubmit(queue, 1u, &(VkSubmitInfo){
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1u,
+        .pCommandBuffers = &commandBuffer,
+    }, VK_NULL_HANDLE);
+    vkQueueWaitIdle(queue);
+    if (timestampCount > 0u)
+    {
+        vkGetQueryPoolResults(device, timestampQueryPool, 0u, timestampCount, timestampCount * sizeof(uint64_t), timestamps,
+                              sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    }
+}
+
+// Accumulates samples [first, end) of a total-sample image into the bound targets,
+// resolving after the last one.
+typedef struct AccumulatePass {
+    ScenePushConstants push;
+    uint32_t first;
+    uint32_t end;
+    uint32_t total;
+} AccumulatePass;
+
+static void recordAccumulatePass(VkCommandBuffer cmd, void *user)
+{
+    const AccumulatePass *pass = (const AccumulatePass *)user;
+    for (uint32_t sample = pass->first; sample < pass->end; ++sample)
+    {
+        ScenePushConstants push = pass->push;
+        push.frame[0] = sample;
+        push.frame[1] |= FRAME_ACCUMULATE | ((sample + 1u == pass->total) ? FRAME_RESOLVE : 0u);
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(push), &push);
+        vkCmdDispatch(cmd, (push.view[0] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE,
+                      (push.view[1] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE, 1u);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u,
+                             1u, &(VkMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        }, 0u, NULL, 0u, NULL);
+    }
+}
+
+// Mean squared error of the RGB channels, normalized to [0, 1].
+static double imageMse(const uint8_t *a, const uint8_t *b, size_t pixelCount)
+{
+    double sum = 0.0;
+    for (size_t i = 0u; i < pixelCount; ++i)
+    {
+        for (uint32_t c = 0u; c < 3u; ++c)
+        {
+            const double diff = ((double)a[i * 4u + c] - (double)b[i * 4u + c]) * (1.0 / 255.0);
+            sum += diff * diff;
+        }
+    }
+    return sum / (double)(pixelCount * 3u);
+}
+
+static uint32_t imageMaxDiff(const uint8_t *a, const uint8_t *b, size_t pixelCount)
+{
+    uint32_t maxDiff = 0u;
+    for (size_t i = 0u; i < pixelCount * 4u; ++i)
+    {
+        if ((i & 3u) == 3u) continue;
+        const uint32_t diff = (uint32_t)abs((int)a[i] - (int)b[i]);
+        if (diff > maxDiff) maxDiff = diff;
+    }
+    return maxDiff;
+}
+
+typedef struct BenchSuiteDesc {
+    uint32_t full;
+    uint32_t width;
+    uint32_t height;
+    uint32_t frames;
+    // Packs every case's grid into the compact layout and traces that instead.
+    uint32_t compactGrid;
+    const char *outputPath;
+    const char *baselinePath;
+    double tolerance;
+} BenchSuiteDesc;
+
+typedef struct BenchPose {
+    const char *name;
+    float zoom;
+} BenchPose;
+
+static const uint32_t BENCH_QUICK_SPHERE_COUNTS[] = {128u, 16384u, 262144u};
+static const uint32_t BENCH_FULL_SPHERE_COUNTS[] = {128u, 16384u, 262144u, 1048576u, 4194304u};
+static const uint32_t BENCH_DISTRIBUTIONS[] = {SCENE_DIST_UNIFORM, SCENE_DIST_CLUSTERED};
+static const char *const BENCH_DISTRIBUTION_NAMES[] = {"uniform", "clustered"};
+static const float BENCH_GRID_SCALES[] = {0.5f, 1.0f, 2.0f};
+static const BenchPose BENCH_POSES[] = {
+    {"overview", 26.0f},
+    {"close", 8.0f},
+    {"wide", 80.0f},
+};
+
+// Replaces the scene with a generated one whose grid dims are scaled by gridScale and
+// uploads it. buildCompact also packs the grid; a nonzero return means the encoding did
+// not fit and the scene traces the regular layout. genMs and buildMs may be NULL.
+static int rebuildBenchScene(const SceneGenDesc *genDesc, float gridScale, uint32_t buildCompact, double *genMs,
+                             double *buildMs)
+{
+    vkDeviceWaitIdle(device);
+    destroySceneBuffers();
+    gbbFreeInstancedScene(&instancedScene);
+    gbbFreeSphereLod(&sphereLod);
+    gbbFreeCompactGrid(&compactGrid);
+    gbbFreeSphereGrid(&grid);
+    gbbFreePackedSpheres(&spheres);
+
+    const uint64_t genStart = gbbGetTimeNs();
+    gbbGenerateSpheres(&spheres, genDesc);
+    const uint64_t genEnd = gbbGetTimeNs();
+    uint32_t dims[3];
+    gbbChooseGridDims(&spheres, dims);
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        const float scaled = (float)dims[axis] * gridScale;
+        dims[axis] = (scaled < 1.0f) ? 1u : ((scaled > 1024.0f) ? 1024u : (uint32_t)scaled);
+    }
+    const uint64_t buildStart = gbbGetTimeNs();
+    gbbBuildSphereGrid(&grid, &spheres, dims[0], dims[1], dims[2], 0u);
+    const int packFailed = (buildCompact != 0u) ? gbbBuildCompactGrid(&compactGrid, &grid, spheres.count) : 0;
+    const uint64_t buildEnd = gbbGetTimeNs();
+    createSceneBuffers();
+    writeSceneDescriptors(1u);
+
+    if (genMs) *genMs = (double)(genEnd - genStart) * 1e-6;
+    if (buildMs) *buildMs = (double)(buildEnd - buildStart) * 1e-6;
+    return packFailed;
+}
+
+// Looks at the middle of the scene bounds from zoom.
+static ScenePushConstants benchPushConstants(const BenchSuiteDesc *suite, float zoom)
+{
+    const float focus[3] = {
+        spheres.bounds.min[0] + 0.5f * spheres.bounds.extent[0],
+        0.0f,
+        spheres.bounds.min[2] + 0.5f * spheres.bounds.extent[2],
+    };
+    ScenePushConstants push = {
+        .view = {suite->width, suite->height, 0u, 0u},
+    };
+    fillCameraPushConstants(&push, focus, zoom);
+    fillScenePushConstants(&push);
+    return push;
+}
+
+typedef struct BenchFramesPass {
+    ScenePushConstants push;
+    uint32_t frames;
+} BenchFramesPass;
+
+// Frame 0 warms caches and is excluded from the timed range, which starts at
+// timestamp 1.
+static void recordBenchFrames(VkCommandBuffer cmd, void *user)
+{
+    const BenchFramesPass *pass = (const BenchFramesPass *)user;
+    vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(pass->push), &pass->push);
+    for (uint32_t frame = 0u; frame <= pass->frames; ++frame)
+    {
+        if (frame == 1u)
+        {
+            vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampQueryPool, 1u);
+        }
+        vkCmdDispatch(cmd, (pass->push.view[0] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE,
+                      (pass->push.view[1] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE, 1u);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u,
+                             1u, &(VkMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        }, 0u, NULL, 0u, NULL);
+    }
+}
+
+// GPU milliseconds per frame of tracing push into the fixture's output image, which
+// readback (NULL for none) then copies to the host.
+static double timeSceneFrames(OffscreenFixture *fixture, const ScenePushConstants *push, uint32_t frames,
+                              const OffscreenReadback *readback)
+{
+    BenchFramesPass pass = {
+        .push = *push,
+        .frames = frames,
+    };
+    uint64_t timestamps[3] = {0u, 0u, 0u};
+    submitAndReadback(fixture, recordBenchFrames, &pass, readback, timestamps, 3u);
+    return (double)(timestamps[2] - timestamps[1]) * fixture->timestampMs / (double)frames;
+}
+
+// Renders every (sphere count, distribution, grid scale, pose) case offscreen for a
+// fixed number of frames and writes the results as JSON. The quick suite uses the
+// first pose only. A missing baseline is reported, never invented.
+static int runBenchSuite(const BenchSuiteDesc *suite)
+{
+    const uint32_t *sphereCounts = (suite->full != 0u) ? BENCH_FULL_SPHERE_COUNTS : BENCH_QUICK_SPHERE_COUNTS;
+    const uint32_t sphereCountCount = (suite->full != 0u)
+        ? (uint32_t)(sizeof(BENCH_FULL_SPHERE_COUNTS) / sizeof(*BENCH_FULL_SPHERE_COUNTS))
+        : (uint32_t)(sizeof(BENCH_QUICK_SPHERE_COUNTS) / sizeof(*BENCH_QUICK_SPHERE_COUNTS));
+    const uint32_t distributionCount = (uint32_t)(sizeof(BENCH_DISTRIBUTIONS) / sizeof(*BENCH_DISTRIBUTIONS));
+    const uint32_t gridScaleCount = (uint32_t)(sizeof(BENCH_GRID_SCALES) / sizeof(*BENCH_GRID_SCALES));
+    const uint32_t poseCount = (suite->full != 0u) ? (uint32_t)(sizeof(BENCH_POSES) / sizeof(*BENCH_POSES)) : 1u;
+
+    VkPhysicalDeviceProperties deviceProps;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProps);
+    BenchReport report = {0};
+    snprintf(report.device, sizeof(report.device), "%s", deviceProps.deviceName);
+    report.width = suite->width;
+    report.height = suite->height;
+    report.frames = suite->frames;
+    report.results = (BenchResult *)calloc((size_t)sphereCountCount * distributionCount * gridScaleCount * poseCount,
+                                           sizeof(BenchResult));
+    if (!report.results) return 1;
+
+    OffscreenFixture fixture;
+    createOffscreenFixture(&fixture, suite->width, suite->height, 0u, NULL, 0u);
+    for (uint32_t c = 0u; c < sphereCountCount; ++c)
+    {
+        for (uint32_t d = 0u; d < distributionCount; ++d)
+        {
+            for (uint32_t g = 0u; g < gridScaleCount; ++g)
+            {
+                const SceneGenDesc genDesc = {
+                    .sphereCount = sphereCounts[c],
+                    .distribution = BENCH_DISTRIBUTIONS[d],
+                    .seed = 0x1f2e3d4cu,
+                };
+                double genMs = 0.0;
+                double buildMs = 0.0;
+                if (rebuildBenchScene(&genDesc, BENCH_GRID_SCALES[g], suite->compactGrid, &genMs, &buildMs) != 0)
+                {
+                    printf("%s-%u-g%.1fx: compact encoding does not fit, timing the regular layout\n",
+                           BENCH_DISTRIBUTION_NAMES[d], sphereCounts[c], (double)BENCH_GRID_SCALES[g]);
+                }
+                const uint32_t compact = (uint32_t)(compactGrid.wordCount > 0u);
+
+                for (uint32_t p = 0u; p < poseCount; ++p)
+                {
+                    const ScenePushConstants push = benchPushConstants(suite, BENCH_POSES[p].zoom);
+                    const double gpuMs = timeSceneFrames(&fixture, &push, suite->frames, NULL);
+
+                    BenchResult *r = &report.results[report.count++];
+                    snprintf(r->name, sizeof(r->name), "%s-%u-g%.1fx-%s%s", BENCH_DISTRIBUTION_NAMES[d], sphereCounts[c],
+                             (double)BENCH_GRID_SCALES[g], BENCH_POSES[p].name, (compact != 0u) ? "-compact" : "");
+                    snprintf(r->distribution, sizeof(r->distribution), "%s", BENCH_DISTRIBUTION_NAMES[d]);
+                    snprintf(r->pose, sizeof(r->pose), "%s", BENCH_POSES[p].name);
+                    r->sphereCount = spheres.count;
+                    r->gridDims[0] = grid.dims[0];
+                    r->gridDims[1] = grid.dims[1];
+                    r->gridDims[2] = grid.dims[2];
+                    r->genMs = genMs;
+                    r->buildMs = buildMs;
+                    r->gpuMs = gpuMs;
+                    r->mraysPerSecond = (gpuMs > 0.0) ? ((double)suite->width * suite->height * 1e-3 / gpuMs) : 0.0;
+                    r->memoryBytes = (uint64_t)(sphereBufferSize + ((compact != 0u) ? compactGridBufferSize
+                                                                                     : (gridCellBufferSize + gridIndexBufferSize)));
+                    printf("%-40s grid %4ux%3ux%4u  gen %9.2f ms  build %8.2f ms  gpu %8.3f ms  %8.2f Mrays/s  %7.2f MB\n",
+                           r->name, r->gridDims[0], r->gridDims[1], r->gridDims[2], r->genMs, r->buildMs, r->gpuMs,
+                           r->mraysPerSecond, (double)r->memoryBytes / (1024.0 * 1024.0));
+                }
+            }
+        }
+    }
+    vkDeviceWaitIdle(device);
+    destroyOffscreenFixture(&fixture);
+
+    int result = 0;
+    if (gbbWriteBenchReport(suite->outputPath, &report) != 0)
+    {
+        fprintf(stderr, "failed to write %s\n", suite->outputPath);
+        result = 1;
+    }
+    else
+    {
+        printf("wrote %u cases to %s\n", report.count, suite->outputPath);
+    }
+
+    if (suite->baselinePath)
+    {
+        BenchReport baseline = {0};
+        if (gbbReadBenchReport(suite->baselinePath, &baseline) != 0)
+        {
+            printf("no baseline at %s; run the bench_baseline target to store this run as one\n", suite->baselinePath);
+        }
+        else if (gbbCompareBenchReports(&baseline, &report, suite->tolerance) > 0u)
+        {
+            result = 1;
+        }
+        gbbFreeBenchReport(&baseline);
+    }
+    gbbFreeBenchReport(&report);
+    return result;
+}
+
+// Renders the overview pose of uniform scenes at the suite's sphere counts through the
+// regular and the compact grid, reporting both footprints and frame times. The two
+// layouts hold the same references, so the images must match exactly.
+static int runCompactGridBench(const BenchSuiteDesc *suite)
+{
+    const uint32_t *sphereCounts = (suite->full != 0u) ? BENCH_FULL_SPHERE_COUNTS : BENCH_QUICK_SPHERE_COUNTS;
+    const uint32_t sphereCountCount = (suite->full != 0u)
+        ? (uint32_t)(sizeof(BENCH_FULL_SPHERE_COUNTS) / sizeof(*BENCH_FULL_SPHERE_COUNTS))
+        : (uint32_t)(sizeof(BENCH_QUICK_SPHERE_COUNTS) / sizeof(*BENCH_QUICK_SPHERE_COUNTS));
+    VkPhysicalDeviceProperties deviceProps;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProps);
+
+    const VkDeviceSize readbackSize = (VkDeviceSize)suite->width * suite->height * 4u;
+    const VkDeviceSize readbackSizes[2] = {readbackSize, readbackSize};
+    OffscreenFixture fixture;
+    createOffscreenFixture(&fixture, suite->width, suite->height, 0u, readbackSizes, 2u);
+
+    printf("compact grid %ux%u, %u frames on %s\n", suite->width, suite->height, suite->frames, deviceProps.deviceName);
+    printf("%9s %9s  %10s %10s  %6s  %10s %10s  %6s  %5s  %s\n", "spheres", "refs", "regular", "compact", "memory",
+           "regular", "compact", "time", "bits", "diff");
+    int result = 0;
+    for (uint32_t c = 0u; c < sphereCountCount; ++c)
+    {
+        const SceneGenDesc genDesc = {
+            .sphereCount = sphereCounts[c],
+            .distribution = SCENE_DIST_UNIFORM,
+            .seed = 0x1f2e3d4cu,
+        };
+        if (rebuildBenchScene(&genDesc, 1.0f, 1u, NULL, NULL) != 0)
+        {
+            printf("%9u %9u  compact encoding does not fit\n", spheres.count, grid.refCount);
+            continue;
+        }
+
+        const ScenePushConstants push = benchPushConstants(suite, BENCH_POSES[0].zoom);
+        double gpuMs[2] = {0.0, 0.0};
+        for (uint32_t variant = 0u; variant < 2u; ++variant)
+        {
+            ScenePushConstants variantPush = push;
+            if (variant == 0u) variantPush.frame[1] &= ~FRAME_COMPACT_GRID;
+            gpuMs[variant] = timeSceneFrames(&fixture, &variantPush, suite->frames, &(OffscreenReadback){.buffer = variant});
+        }
+
+        const uint32_t maxError = imageMaxDiff((const uint8_t *)fixture.readbackMapped[0],
+                                               (const uint8_t *)fixture.readbackMapped[1],
+                                               (size_t)suite->width * suite->height);
+        if (maxError != 0u) result = 1;
+        const double regularBytes = (double)(gridCellBufferSize + gridIndexBufferSize);
+        const double compactBytes = (double)compactGridBufferSize;
+        printf("%9u %9u  %7.2f MB %7.2f MB  %5.2fx  %7.3f ms %7.3f ms  %5.2fx  %2u/%-2u  %u\n", spheres.count, grid.refCount,
+               regularBytes / (1024.0 * 1024.0), compactBytes / (1024.0 * 1024.0),
+               (compactBytes > 0.0) ? (regularBytes / compactBytes) : 0.0, gpuMs[0], gpuMs[1],
+               (gpuMs[0] > 0.0) ? (gpuMs[1] / gpuMs[0]) : 0.0, compactGrid.indexBits,
+               compactGrid.countBits + compactGrid.deltaBits, maxError);
+    }
+
+    vkDeviceWaitIdle(device);
+    destroyOffscreenFixture(&fixture);
+    return result;
+}
+
+typedef struct LatencyTestDesc {
+    uint32_t frames;
+    uint32_t width;
+    uint32_t height;
+    uint32_t lowLatency;
+    const char *capturePath;
+} LatencyTestDesc;
+
+// Drives the camera from a looping input script and renders offscreen with the same
+// ordering as the interactive loop: by default input is sampled before waiting on the
+// previous frame, in low-latency mode only after it, right before recording.
+static int runLatencyTest(const LatencyTestDesc *test)
+{
+    GbbInputEvent script[LATENCY_SCRIPT_EVENTS];
+    for (uint32_t i = 0u; i < LATENCY_SCRIPT_EVENTS; ++i)
+    {
+        script[i] = (GbbInputEvent){
+            .timeNs = (uint64_t)i * LATENCY_SCRIPT_PERIOD_NS,
+            .key = ((i & 3u) < 2u) ? (GBB_KEY_W + ((i >> 2u) & 3u)) : GBB_KEY_COUNT,
+            .down = (uint32_t)((i & 3u) == 0u),
+            .wheel = ((i & 3u) == 2u) ? 1.0f : (((i & 3u) == 3u) ? -1.0f : 0.0f),
+        };
+    }
+
+    VkImage outImage = VK_NULL_HANDLE;
+    VkDeviceMemory outMemory = VK_NULL_HANDLE;
+    VkImage accumImage = VK_NULL_HANDLE;
+    VkDeviceMemory accumMemory = VK_NULL_HANDLE;
+    createStorageImage(VK_FORMAT_R8G8B8A8_UNORM, test->width, test->height, &outImage, &outMemory, &outputImageViews[0]);
+    createStorageImage(VK_FORMAT_R32G32B32A32_SFLOAT, 1u, 1u, &accumImage, &accumMemory, &accumImageViews[0]);
+    const VkImage images[2] = {outImage, accumImage};
+    transitionImagesToGeneral(images, 2u);
+    writeSceneDescriptors(1u);
+
+    CaptureRing captureRing = {.pendingSlot = UINT32_MAX};
+    if (test->capturePath && (startCaptureRing(&captureRing, test->capturePath, test->width, test->height, 0u) != 0)) return 1;
+
+    VkFence fence = VK_NULL_HANDLE;
+    vkCreateFence(device, &(VkFenceCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, .flags = VK_FENCE_CREATE_SIGNALED_BIT
+    }, NULL, &fence);
+
+    float focus[3] = {0.0f, 0.0f, 0.0f};
+    float zoom = CAMERA_DEFAULT_ZOOM;
+    LatencyStats stats = {0};
+    uint64_t inFlightInputTime = 0u;
+    uint64_t lastTime = gbbGetTimeNs();
+    gbbSetInputScript(script, LATENCY_SCRIPT_EVENTS, lastTime, (uint64_t)LATENCY_SCRIPT_EVENTS * LATENCY_SCRIPT_PERIOD_NS);
+    for (uint32_t frame = 0u; frame < test->frames; ++frame)
+    {
+        if (test->lowLatency == 0u) gbbPlayInputScript(gbbGetTimeNs());
+
+        vkWaitForFences(device, 1u, &fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(device, 1u, &fence);
+        flushCaptureRing(&captureRing);
+        if (inFlightInputTime != 0u)
+        {
+            recordLatency(&stats.inputToGpuMs, &stats.inputToGpuMaxMs, &stats.gpuCount, inFlightInputTime, gbbGetTimeNs());
+            inFlightInputTime = 0u;
+        }
+
+        if (test->lowLatency != 0u) gbbPlayInputScript(gbbGetTimeNs());
+        uint64_t inputTime = 0u;
+        gbbConsumeInputTime(&inputTime);
+        const uint64_t now = gbbGetTimeNs();
+        applyCameraInput(focus, &zoom, (float)(now - lastTime) * 1e-9f);
+        lastTime = now;
+
+        ScenePushConstants push = {
+            .view = {test->width, test->height, 0u, 0u},
+        };
+        fillCameraPushConstants(&push, focus, zoom);
+        fillScenePushConstants(&push);
+
+        vkResetCommandBuffer(commandBuffer, 0u);
+        vkBeginCommandBuffer(commandBuffer, &(VkCommandBufferBeginInfo){
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        });
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0u, 1u, &descriptorSets[0], 0u, NULL);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(push), &push);
+        vkCmdDispatch(commandBuffer, (test->width + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE,
+                      (test->height + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE, 1u);
+        if (captureRing.active != 0u)
+        {
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0u,
+                                 1u, &(VkMemoryBarrier){
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+            }, 0u, NULL, 0u, NULL);
+        }
+        recordCaptureCopy(&captureRing, commandBuffer, outImage);
+        vkEndCommandBuffer(commandBuffer);
+        vkQueueSubmit(queue, 1u, &(VkSubmitInfo){
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount = 1u,
+            .pCommandBuffers = &commandBuffer,
+        }, fence);
+        if (inputTime != 0u)
+        {
+            recordLatency(&stats.inputToSubmitMs, &stats.inputToSubmitMaxMs, &stats.submitCount, inputTime, gbbGetTimeNs());
+            inFlightInputTime = inputTime;
+        }
+    }
+    vkWaitForFences(device, 1u, &fence, VK_TRUE, UINT64_MAX);
+    if (inFlightInputTime != 0u)
+    {
+        recordLatency(&stats.inputToGpuMs, &stats.inputToGpuMaxMs, &stats.gpuCount, inFlightInputTime, gbbGetTimeNs());
+    }
+    gbbSetInputScript(NULL, 0u, 0u, 0u);
+    stopCaptureRing(&captureRing);
+
+    printf("latency test: %u frames at %ux%u, %s pacing\n", test->frames, test->width, test->height,
+           (test->lowLatency != 0u) ? "low-latency" : "default");
+    printLatencyStats("latency", &stats);
+
+    vkDestroyFence(device, fence, NULL);
+    destroyStorageImage(&outImage, &outMemory, &outputImageViews[0]);
+    destroyStorageImage(&accumImage, &accumMemory, &accumImageViews[0]);
+    return 0;
+}
+
+typedef struct LodCompareDesc {
+    uint32_t width;
+    uint32_t height;
+    uint32_t samples;
+} LodCompareDesc;
+
+// Renders the same converged view with exact traversal and with the LOD proxies, using
+// identical sample sequences, and reports the GPU speedup and the 8-bit image error.
+static int runLodCompare(const LodCompareDesc *compare)
+{
+    if (sphereLod.proxies.count == 0u)
+    {
+        fprintf(stderr, "--lod-compare needs a flat, static scene with --lod\n");
+        return 1;
+    }
+    const VkDeviceSize readbackSize = (VkDeviceSize)compare->width * compare->height * 4u;
+    const VkDeviceSize readbackSizes[2] = {readbackSize, readbackSize};
+    OffscreenFixture fixture;
+    createOffscreenFixture(&fixture, compare->width, compare->height, 1u, readbackSizes, 2u);
+
+    double gpuMs[2] = {0.0, 0.0};
+    const uint32_t requestedBounce = lodBounce;
+    const float focus[3] = {0.0f, 0.0f, 0.0f};
+    for (uint32_t variant = 0u; variant < 2u; ++variant)
+    {
+        lodBounce = (variant == 0u) ? 0u : requestedBounce;
+        AccumulatePass pass = {
+            .push.view = {compare->width, compare->height, 0u, 0u},
+            .end = compare->samples,
+            .total = compare->samples,
+        };
+        fillCameraPushConstants(&pass.push, focus, CAMERA_DEFAULT_ZOOM);
+        fillScenePushConstants(&pass.push);
+
+        uint64_t timestamps[2] = {0u, 0u};
+        submitAndReadback(&fixture, recordAccumulatePass, &pass, &(OffscreenReadback){.buffer = variant}, timestamps, 2u);
+        gpuMs[variant] = (double)(timestamps[1] - timestamps[0]) * fixture.timestampMs;
+    }
+    lodBounce = requestedBounce;
+
+    const size_t pixelCount = (size_t)compare->width * compare->height;
+    const uint8_t *exact = (const uint8_t *)fixture.readbackMapped[0];
+    const uint8_t *approx = (const uint8_t *)fixture.readbackMapped[1];
+    const double rmse = sqrt(imageMse(exact, approx, pixelCount)) * 255.0;
+    const double psnr = (rmse > 0.0) ? (20.0 * log10(255.0 / rmse)) : INFINITY;
+    printf("lod compare %ux%u, %u spp, proxies %u (macro %u, bounce >= %u, distance %.1f)\n", compare->width, compare->height,
+           compare->samples, sphereLod.proxies.count, sphereLod.macroSize, requestedBounce, (double)lodDistance);
+    printf("  exact %.3f ms, lod %.3f ms, speedup %.2fx\n", gpuMs[0], gpuMs[1], (gpuMs[1] > 0.0) ? (gpuMs[0] / gpuMs[1]) : 0.0);
+    printf("  rmse %.3f, psnr %.2f dB, max error %u (8-bit)\n", rmse, psnr, imageMaxDiff(exact, approx, pixelCount));
+
+    destroyOffscreenFixture(&fixture);
+    return 0;
+}
+
+typedef struct MultiViewDesc {
+    uint32_t views;
+    uint32_t width;
+    uint32_t height;
+    uint32_t samples;
+    const char *outputStem;
+} MultiViewDesc;
+
+typedef struct MultiViewPass {
+    ScenePushConstants push;
+    uint32_t views;
+} MultiViewPass;
+
+static void recordMultiViewPass(VkCommandBuffer cmd, void *user)
+{
+    const MultiViewPass *pass = (const MultiViewPass *)user;
+    vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(pass->push), &pass->push);
+    vkCmdDispatch(cmd, (pass->push.view[0] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE,
+                  (pass->push.view[1] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE, pass->views);
+}
+
+// Renders desc->views orbit cameras twice: as one FRAME_MULTI_VIEW dispatch into the
+// layers of the view array followed by one bulk readback, and the way the frame loop
+// would, one submission with its own dispatches and copy per view. Both runs trace
+// the same samples, so their pixels should agree to rounding.
+static int runMultiView(const MultiViewDesc *desc)
+{
+    const uint32_t views = desc->views;
+    const float focus[3] = {0.0f, 0.0f, 0.0f};
+    GpuViewCamera *cameras = (GpuViewCamera *)viewCameraBufferMapped;
+    for (uint32_t v = 0u; v < views; ++v)
+    {
+        // Yaw steps evenly around the scene; pitch is shuffled between -0.2 and -1.2 rad.
+        const float yaw = CAMERA_YAW + 6.2831853f * (float)v / (float)views;
+        const float pitch = -0.2f - (float)((v * 7u) % views) / (float)views;
+        fillOrbitCamera(cameras[v].origin, cameras[v].forward_fov, focus, yaw, pitch, CAMERA_DEFAULT_ZOOM);
+        cameras[v].origin[3] = 0.0f;
+    }
+
+    const VkDeviceSize viewBytes = (VkDeviceSize)desc->width * desc->height * 4u;
+    const VkDeviceSize readbackSizes[2] = {viewBytes * views, viewBytes * views};
+    OffscreenFixture fixture;
+    createOffscreenFixture(&fixture, desc->width, desc->height, 1u, readbackSizes, 2u);
+
+    ScenePushConstants push = {
+        .view = {desc->width, desc->height, 0u, 0u},
+    };
+    fillCameraPushConstants(&push, focus, CAMERA_DEFAULT_ZOOM);
+    fillScenePushConstants(&push);
+
+    // The first batch only warms up the pipeline and caches.
+    MultiViewPass batched = {
+        .push = push,
+        .views = views,
+    };
+    batched.push.frame[1] |= FRAME_MULTI_VIEW;
+    batched.push.frame[3] = desc->samples;
+    double batchedMs = 0.0;
+    double batchedGpuMs = 0.0;
+    for (uint32_t pass = 0u; pass < 2u; ++pass)
+    {
+        const uint64_t start = gbbGetTimeNs();
+        uint64_t timestamps[2] = {0u, 0u};
+        submitAndReadback(&fixture, recordMultiViewPass, &batched,
+                          &(OffscreenReadback){.buffer = 0u, .image = viewArrayImage, .layers = views}, timestamps, 2u);
+        batchedMs = (double)(gbbGetTimeNs() - start) * 1e-6;
+        batchedGpuMs = (double)(timestamps[1] - timestamps[0]) * fixture.timestampMs;
+    }
+
+    const uint64_t perViewStart = gbbGetTimeNs();
+    for (uint32_t v = 0u; v < views; ++v)
+    {
+        AccumulatePass accumulate = {
+            .push = push,
+            .end = desc->samples,
+            .total = desc->samples,
+        };
+        memcpy(accumulate.push.origin, cameras[v].origin, 3u * sizeof(float));
+        memcpy(accumulate.push.forward_fov, cameras[v].forward_fov, sizeof(accumulate.push.forward_fov));
+        submitAndReadback(&fixture, recordAccumulatePass, &accumulate, &(OffscreenReadback){.buffer = 1u, .offset = viewBytes * v},
+                          NULL, 0u);
+    }
+    const double perViewMs = (double)(gbbGetTimeNs() - perViewStart) * 1e-6;
+
+    const uint8_t *batchedPixels = (const uint8_t *)fixture.readbackMapped[0];
+    const uint8_t *perViewPixels = (const uint8_t *)fixture.readbackMapped[1];
+    const uint32_t maxError = imageMaxDiff(batchedPixels, perViewPixels, (size_t)desc->width * desc->height * views);
+    printf("multi-view %u views of %ux%u, %u spp\n", views, desc->width, desc->height, desc->samples);
+    printf("  batched  %.2f ms (%.1f views/s), gpu %.2f ms\n", batchedMs,
+           (batchedMs > 0.0) ? ((double)views * 1000.0 / batchedMs) : 0.0, batchedGpuMs);
+    printf("  per view %.2f ms (%.1f views/s)\n", perViewMs, (perViewMs > 0.0) ? ((double)views * 1000.0 / perViewMs) : 0.0);
+    printf("  speedup %.2fx, max difference %u (8-bit)\n", (batchedMs > 0.0) ? (perViewMs / batchedMs) : 0.0, maxError);
+
+    int result = 0;
+    for (uint32_t v = 0u; (desc->outputStem != NULL) && (v < views); ++v)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s_%04u.ppm", desc->outputStem, v);
+        ImageFile image = {0};
+        int failed = gbbOpenImageFile(&image, path, desc->width, desc->height);
+        if (failed == 0)
+        {
+            failed = gbbWriteImageTile(&image, 0u, 0u, desc->width, desc->height, batchedPixels + viewBytes * v, (size_t)desc->width * 4u);
+            if (gbbCloseImageFile(&image) != 0) failed = 1;
+        }
+        if (failed != 0)
+        {
+            fprintf(stderr, "failed to write %s\n", path);
+            result = 1;
+            break;
+        }
+    }
+
+    destroyOffscreenFixture(&fixture);
+    return result;
+}
+
+typedef struct TileBinBenchDesc {
+    uint32_t width;
+    uint32_t height;
+    uint32_t iterations;
+} TileBinBenchDesc;
+
+typedef struct FirstHitPass {
+    ScenePushConstants push;
+    uint32_t iterations;
+    uint32_t binned;
+} FirstHitPass;
+
+// Timestamp 1 separates the binning prepass from the first-hit dispatches.
+static void recordFirstHitPass(VkCommandBuffer cmd, void *user)
+{
+    FirstHitPass *pass = (FirstHitPass *)user;
+    for (uint32_t i = 0u; (pass->binned != 0u) && (i < pass->iterations); ++i)
+    {
+        recordTileBinning(cmd, &pass->push);
+    }
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampQueryPool, 1u);
+    ScenePushConstants push = pass->push;
+    push.frame[1] |= FRAME_FIRST_HIT;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0u, 1u, &descriptorSets[0], 0u, NULL);
+    vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(push), &push);
+    for (uint32_t i = 0u; i < pass->iterations; ++i)
+    {
+        vkCmdDispatch(cmd, (push.view[0] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE,
+                      (push.view[1] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE, 1u);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u,
+                             1u, &(VkMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        }, 0u, NULL, 0u, NULL);
+    }
+}
+
+// The per-tile counts are the first tileCount words of the bin buffer.
+static void recordTileCountCopy(VkCommandBuffer cmd, void *user)
+{
+    const OffscreenFixture *fixture = (const OffscreenFixture *)user;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0u,
+                         1u, &(VkMemoryBarrier){
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+    }, 0u, NULL, 0u, NULL);
+    vkCmdCopyBuffer(cmd, tileBinBuffer, fixture->readbackBuffers[2], 1u, &(VkBufferCopy){
+        .size = (VkDeviceSize)((fixture->width + BIN_TILE_SIZE - 1u) / BIN_TILE_SIZE) *
+                ((fixture->height + BIN_TILE_SIZE - 1u) / BIN_TILE_SIZE) * sizeof(uint32_t),
+    });
+}
+
+// Times first hits only (FRAME_FIRST_HIT) through the grid DDA and through the tile
+// lists, with the binning prepass timed on its own. Both resolve the same centered
+// primary rays, so the images should match.
+static int runTileBinBench(const TileBinBenchDesc *bench)
+{
+    if ((tileBinWidth == 0u) || (instancedScene.instanceCount > 0u))
+    {
+        fprintf(stderr, "--bench-tile-bins needs a flat scene\n");
+        return 1;
+    }
+    const uint32_t tileCount = ((bench->width + BIN_TILE_SIZE - 1u) / BIN_TILE_SIZE) *
+                               ((bench->height + BIN_TILE_SIZE - 1u) / BIN_TILE_SIZE);
+    const VkDeviceSize readbackSize = (VkDeviceSize)bench->width * bench->height * 4u;
+    const VkDeviceSize readbackSizes[3] = {readbackSize, readbackSize, (VkDeviceSize)tileCount * sizeof(uint32_t)};
+    OffscreenFixture fixture;
+    createOffscreenFixture(&fixture, bench->width, bench->height, 0u, readbackSizes, 3u);
+
+    const float focus[3] = {0.0f, 0.0f, 0.0f};
+    double prepassMs = 0.0;
+    double traceMs[2] = {0.0, 0.0};
+    for (uint32_t variant = 0u; variant < 2u; ++variant)
+    {
+        FirstHitPass pass = {
+            .push.view = {bench->width, bench->height, 0u, 0u},
+            .iterations = bench->iterations,
+            .binned = variant,
+        };
+        fillCameraPushConstants(&pass.push, focus, CAMERA_DEFAULT_ZOOM);
+        fillScenePushConstants(&pass.push);
+
+        uint64_t timestamps[3] = {0u, 0u, 0u};
+        submitAndReadback(&fixture, recordFirstHitPass, &pass, &(OffscreenReadback){.buffer = variant}, timestamps, 3u);
+        const double periodMs = fixture.timestampMs / (double)bench->iterations;
+        if (variant == 1u) prepassMs = (double)(timestamps[1] - timestamps[0]) * periodMs;
+        traceMs[variant] = (double)(timestamps[2] - timestamps[1]) * periodMs;
+    }
+    submitAndReadback(&fixture, recordTileCountCopy, &fixture, NULL, NULL, 0u);
+
+    const uint32_t maxError = imageMaxDiff((const uint8_t *)fixture.readbackMapped[0], (const uint8_t *)fixture.readbackMapped[1],
+                                           (size_t)bench->width * bench->height);
+    const uint32_t *counts = (const uint32_t *)fixture.readbackMapped[2];
+    uint64_t entries = 0u;
+    uint32_t maxCount = 0u;
+    for (uint32_t i = 0u; i < tileCount; ++i)
+    {
+        entries += counts[i];
+        if (counts[i] > maxCount) maxCount = counts[i];
+    }
+    const double binnedMs = prepassMs + traceMs[1];
+    printf("tile bins %ux%u, %u tiles of %u px, %u spheres, %u iterations\n", bench->width, bench->height, tileCount,
+           BIN_TILE_SIZE, spheres.count, bench->iterations);
+    printf("  dda first hit    %.3f ms\n", traceMs[0]);
+    printf("  binned first hit %.3f ms (prepass %.3f ms + trace %.3f ms), speedup %.2fx\n", binnedMs, prepassMs, traceMs[1],
+           (binnedMs > 0.0) ? (traceMs[0] / binnedMs) : 0.0);
+    printf("  %.1f candidates per tile (max %u), %llu of %llu entries, max difference %u (8-bit)\n",
+           (double)entries / (double)tileCount, maxCount, (unsigned long long)entries,
+           (unsigned long long)(tileEntryBufferSize / sizeof(uint32_t)), maxError);
+
+    destroyOffscreenFixture(&fixture);
+    return 0;
+}
+
+typedef struct RestirBenchDesc {
+    uint32_t width;
+    uint32_t height;
+    uint32_t frames;
+    uint32_t referenceSamples;
+} RestirBenchDesc;
+
+typedef struct RestirBenchPass {
+    ScenePushConstants push;
+    uint32_t frames;
+    uint32_t restir;
+} RestirBenchPass;
+
+// Plain path frames use the jittered sample indices of every reference sample but the first.
+static void recordRestirBenchPass(VkCommandBuffer cmd, void *user)
+{
+    const RestirBenchPass *pass = (const RestirBenchPass *)user;
+    for (uint32_t frame = 0u; frame < pass->frames; ++frame)
+    {
+        if (pass->restir != 0u)
+        {
+            recordRestirPasses(cmd, &pass->push);
+            continue;
+        }
+        ScenePushConstants push = pass->push;
+        push.frame[0] = frame + 1u;
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(push), &push);
+        vkCmdDispatch(cmd, (push.view[0] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE,
+                      (push.view[1] + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE, 1u);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u,
+                             1u, &(VkMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        }, 0u, NULL, 0u, NULL);
+    }
+}
+
+// Scores ReSTIR by effective samples: plain 1 spp path tracing, the first ReSTIR frame
+// (spatial reuse only) and the frame after bench->frames static frames are compared to
+// a referenceSamples accumulation. Error falls as 1 / spp for independent samples, so
+// the MSE ratio to the 1 spp frame is the number of plain samples a frame is worth,
+// and dividing by each frame's GPU time gives the gain per millisecond.
+static int runRestirBench(const RestirBenchDesc *bench)
+{
+    if (restirWidth == 0u)
+    {
+        fprintf(stderr, "--bench-restir has no reservoir state for %ux%u\n", bench->width, bench->height);
+        return 1;
+    }
+    // Readbacks: reference, 1 spp path, first ReSTIR frame, converged ReSTIR frame.
+    const VkDeviceSize readbackSize = (VkDeviceSize)bench->width * bench->height * 4u;
+    const VkDeviceSize readbackSizes[4] = {readbackSize, readbackSize, readbackSize, readbackSize};
+    OffscreenFixture fixture;
+    createOffscreenFixture(&fixture, bench->width, bench->height, 1u, readbackSizes, 4u);
+
+    const float focus[3] = {0.0f, 0.0f, 0.0f};
+    ScenePushConstants basePush = {
+        .view = {bench->width, bench->height, 0u, 0u},
+    };
+    fillCameraPushConstants(&basePush, focus, CAMERA_DEFAULT_ZOOM);
+    fillScenePushConstants(&basePush);
+
+    // Reference accumulation in submissions of RESTIR_REFERENCE_BATCH samples.
+    const uint32_t referenceSteps = (bench->referenceSamples + RESTIR_REFERENCE_BATCH - 1u) / RESTIR_REFERENCE_BATCH;
+    for (uint32_t step = 0u; step < referenceSteps; ++step)
+    {
+        AccumulatePass reference = {
+            .push = basePush,
+            .first = step * RESTIR_REFERENCE_BATCH,
+            .end = step * RESTIR_REFERENCE_BATCH + RESTIR_REFERENCE_BATCH,
+            .total = bench->referenceSamples,
+        };
+        if (reference.end > bench->referenceSamples) reference.end = bench->referenceSamples;
+        submitAndReadback(&fixture, recordAccumulatePass, &reference,
+                          (reference.end == bench->referenceSamples) ? &(OffscreenReadback){.buffer = 0u} : NULL, NULL, 0u);
+    }
+
+    // Then the timed 1 spp frames, the first ReSTIR frame and the remaining ones.
+    double stepMs[3] = {0.0, 0.0, 0.0};
+    restirFrame = 0u;
+    for (uint32_t step = 0u; step < 3u; ++step)
+    {
+        RestirBenchPass pass = {
+            .push = basePush,
+            .frames = (step == 0u) ? bench->frames : ((step == 1u) ? 1u : (bench->frames - 1u)),
+            .restir = (uint32_t)(step > 0u),
+        };
+        uint64_t timestamps[2] = {0u, 0u};
+        submitAndReadback(&fixture, recordRestirBenchPass, &pass, &(OffscreenReadback){.buffer = step + 1u}, timestamps, 2u);
+        stepMs[step] = (double)(timestamps[1] - timestamps[0]) * fixture.timestampMs / (double)pass.frames;
+    }
+
+    const size_t pixelCount = (size_t)bench->width * bench->height;
+    const uint8_t *reference = (const uint8_t *)fixture.readbackMapped[0];
+    double mse[3] = {0.0, 0.0, 0.0};
+    double effectiveSamples[3] = {1.0, 0.0, 0.0};
+    for (uint32_t i = 0u; i < 3u; ++i)
+    {
+        mse[i] = imageMse((const uint8_t *)fixture.readbackMapped[i + 1u], reference, pixelCount);
+        if (i > 0u) effectiveSamples[i] = (mse[i] > 0.0) ? (mse[0] / mse[i]) : 0.0;
+    }
+    const double pathPerMs = (stepMs[0] > 0.0) ? (1.0 / stepMs[0]) : 0.0;
+    const double restirPerMs = (stepMs[2] > 0.0) ? (effectiveSamples[2] / stepMs[2]) : 0.0;
+    printf("restir %ux%u, %u spheres, %u frames against a %u spp reference\n", bench->width, bench->height, spheres.count,
+           bench->frames, bench->referenceSamples);
+    printf("  path 1 spp        %.3f ms/frame, mse %.6f\n", stepMs[0], mse[0]);
+    printf("  restir spatial    %.3f ms,       mse %.6f, %.2f effective spp\n", stepMs[1], mse[1], effectiveSamples[1]);
+    printf("  restir temporal   %.3f ms/frame, mse %.6f, %.2f effective spp\n", stepMs[2], mse[2], effectiveSamples[2]);
+    printf("  effective spp per GPU ms: path %.3f, restir %.3f, gain %.2fx\n", pathPerMs, restirPerMs,
+           (pathPerMs > 0.0) ? (restirPerMs / pathPerMs) : 0.0);
+
+    destroyOffscreenFixture(&fixture);
+    return 0;
+}
+
+static void createInstance(void)
+{
+    vkCreateInstance(&(VkInstanceCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+        .flags = INSTANCE_FLAGS,
+        .pApplicationInfo = &(VkApplicationInfo){
+            .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+            .pApplicationName = APPLICATION_NAME,
+            .applicationVersion = VK_MAKE_API_VERSION(0, 0, 1, 0),
+            .pEngineName = APPLICATION_NAME,
+            .engineVersion = VK_MAKE_API_VERSION(0, 0, 1, 0),
+            .apiVersion = VK_API_VERSION_1_3,
+        },
+        .enabledExtensionCount = INSTANCE_EXT_COUNT,
+        .ppEnabledExtensionNames = INSTANCE_EXTS,
+    }, NULL, &instance);
+}
+
+// Adapters --device can pick from, counted on a throwaway instance for the coordinator,
+// which creates no device of its own.
+static uint32_t countPhysicalDevices(void)
+{
+    createInstance();
+    if (instance == VK_NULL_HANDLE) return 0u;
+    uint32_t deviceCount = 0u;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, NULL);
+    vkDestroyInstance(instance, NULL);
+    instance = VK_NULL_HANDLE;
+    return (deviceCount < MAX_PHYSICAL_DEVICES) ? deviceCount : MAX_PHYSICAL_DEVICES;
+}
+
+// Records the render graph self-check on the device and submits it, so the validation
+// layers see its aliasing barriers too. The graph outlives the submission.
+static int runRenderGraphCheck(void)
+{
+    RenderGraph graph;
+    vkResetCommandBuffer(commandBuffer, 0u);
+    vkBeginCommandBuffer(commandBuffer, &(VkCommandBufferBeginInfo){
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    });
+    const int recorded = gbbRecordRenderGraphCheck(&graph, physicalDevice, device, commandBuffer);
+    vkEndCommandBuffer(commandBuffer);
+    if (recorded != 0)
+    {
+        gbbDestroyRenderGraph(&graph);
+        return 1;
+    }
+    vkQueueSubmit(queue, 1u, &(VkSubmitInfo){
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1u,
+        .pCommandBuffers = &commandBuffer,
+    }, VK_NULL_HANDLE);
+    vkQueueWaitIdle(queue);
+    return gbbFinishRenderGraphCheck(&graph);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t animateSpheres = 0u;
+    uint32_t useLod = 0u;
+    uint32_t lodMacroSize = 0u;
+    uint32_t lodCompare = 0u;
+    uint32_t useProbes = 0u;
+    uint32_t useTileBins = 0u;
+    uint32_t tileBinBench = 0u;
+    uint32_t useRestir = 0u;
+    uint32_t restirBench = 0u;
+    RestirBenchDesc restirBenchDesc = {
+        .width = BENCH_DEFAULT_WIDTH,
+        .height = BENCH_DEFAULT_HEIGHT,
+        .frames = RESTIR_BENCH_FRAMES,
+        .referenceSamples = RESTIR_REFERENCE_SAMPLES,
+    };
+    TileBinBenchDesc tileBinBenchDesc = {
+        .width = BENCH_DEFAULT_WIDTH,
+        .height = BENCH_DEFAULT_HEIGHT,
+        .iterations = TILE_BIN_BENCH_ITERATIONS,
+    };
+    MultiViewDesc multiViewDesc = {
+        .width = MULTI_VIEW_DEFAULT_SIZE,
+        .height = MULTI_VIEW_DEFAULT_SIZE,
+        .samples = MULTI_VIEW_DEFAULT_SAMPLES,
+    };
+    LodCompareDesc lodCompareDesc = {
+        .width = BENCH_DEFAULT_WIDTH,
+        .height = BENCH_DEFAULT_HEIGHT,
+        .samples = LOD_COMPARE_SAMPLES,
+    };
+    uint32_t benchSceneGen = 0u;
+    SceneGenDesc sceneGenDesc = {.seed = 0x1f2e3d4cu};
+    InstancedSceneDesc instancedDesc = {0};
+    BenchSuiteDesc benchSuiteDesc = {
+        .width = BENCH_DEFAULT_WIDTH,
+        .height = BENCH_DEFAULT_HEIGHT,
+        .frames = BENCH_DEFAULT_FRAMES,
+        .outputPath = "bench.json",
+        .tolerance = BENCH_DEFAULT_TOLERANCE,
+    };
+    uint32_t benchSuite = 0u;
+    uint32_t useCompactGrid = 0u;
+    uint32_t compactGridBench = 0u;
+    uint32_t lowLatency = 0u;
+    const char *capturePath = NULL;
+    uint32_t progressive = 0u;
+    uint32_t renderGraphDump = 0u;
+    uint32_t renderGraphCheck = 0u;
+    float frameBudgetMs = PROGRESSIVE_DEFAULT_BUDGET_MS;
+    LatencyTestDesc latencyTest = {
+        .width = BENCH_DEFAULT_WIDTH,
+        .height = BENCH_DEFAULT_HEIGHT,
+    };
+    BatchDesc batchDesc = {
+        .width = BATCH_DEFAULT_WIDTH,
+        .height = BATCH_DEFAULT_HEIGHT,
+        .samples = BATCH_DEFAULT_SAMPLES,
+        .tileSize = BATCH_DEFAULT_TILE,
+    };
+    CoordinatorDesc coordinatorDesc = {0};
+    const char *workerAddress = NULL;
+    uint32_t deviceIndex = 0u;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--bench-grid-update") == 0)
+        {
+            runGridUpdateBenchmark();
+            return 0;
+        }
+        if (strcmp(argv[i], "--animate") == 0) animateSpheres = 1u;
+        if (strcmp(argv[i], "--lod") == 0) useLod = 1u;
+        if (strcmp(argv[i], "--probes") == 0) useProbes = 1u;
+        if (strcmp(argv[i], "--tile-bins") == 0) useTileBins = 1u;
+        if (strcmp(argv[i], "--bench-tile-bins") == 0)
+        {
+            useTileBins = 1u;
+            tileBinBench = 1u;
+        }
+        if (strcmp(argv[i], "--restir") == 0) useRestir = 1u;
+        if (strcmp(argv[i], "--bench-restir") == 0)
+        {
+            useRestir = 1u;
+            restirBench = 1u;
+        }
+        if ((strcmp(argv[i], "--restir-frames") == 0) && (i + 1 < argc))
+        {
+            restirBenchDesc.frames = (uint32_t)strtoul(argv[++i], NULL, 10);
+            if (restirBenchDesc.frames < 2u) restirBenchDesc.frames = 2u;
+        }
+        if ((strcmp(argv[i], "--multi-view") == 0) && (i + 1 < argc)) multiViewDesc.views = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--multi-view-samples") == 0) && (i + 1 < argc))
+        {
+            multiViewDesc.samples = (uint32_t)strtoul(argv[++i], NULL, 10);
+            if (multiViewDesc.samples == 0u) multiViewDesc.samples = 1u;
+        }
+        if ((strcmp(argv[i], "--multi-view-out") == 0) && (i + 1 < argc)) multiViewDesc.outputStem = argv[++i];
+        if ((strcmp(argv[i], "--lod-macro") == 0) && (i + 1 < argc)) lodMacroSize = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--lod-bounce") == 0) && (i + 1 < argc)) lodBounce = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--lod-distance") == 0) && (i + 1 < argc)) lodDistance = strtof(argv[++i], NULL);
+        if (strcmp(argv[i], "--lod-compare") == 0)
+        {
+            useLod = 1u;
+            lodCompare = 1u;
+        }
+        if (strcmp(argv[i], "--bench-scene-gen") == 0) benchSceneGen = 1u;
+        if ((strcmp(argv[i], "--spheres") == 0) && (i + 1 < argc)) sceneGenDesc.sphereCount = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--distribution") == 0) && (i + 1 < argc))
+        {
+            sceneGenDesc.distribution = parseDistribution(argv[++i]);
+            if (sceneGenDesc.distribution == SCENE_DIST_UNKNOWN) return 1;
+        }
+        if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc)) sceneGenDesc.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc)) sceneGenDesc.threadCount = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--instances") == 0) && (i + 1 < argc)) instancedDesc.instanceCount = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--blocks") == 0) && (i + 1 < argc)) instancedDesc.blockCount = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--batch") == 0) && (i + 1 < argc)) batchDesc.path = argv[++i];
+        if ((strcmp(argv[i], "--spp") == 0) && (i + 1 < argc)) batchDesc.samples = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--tile") == 0) && (i + 1 < argc)) batchDesc.tileSize = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--distribute") == 0) && (i + 1 < argc)) coordinatorDesc.localWorkers = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--remote-workers") == 0) && (i + 1 < argc))
+        {
+            coordinatorDesc.remoteWorkers = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        if ((strcmp(argv[i], "--distribute-port") == 0) && (i + 1 < argc)) coordinatorDesc.port = (uint16_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--sample-chunk") == 0) && (i + 1 < argc))
+        {
+            coordinatorDesc.sampleChunk = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        if ((strcmp(argv[i], "--worker") == 0) && (i + 1 < argc)) workerAddress = argv[++i];
+        if ((strcmp(argv[i], "--device") == 0) && (i + 1 < argc)) deviceIndex = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--size") == 0) && (i + 2 < argc))
         {
-            nonEmptyCellCount += 1u;
-            if (count > maxCellCount) maxCellCount = count;
+            batchDesc.width = (uint32_t)strtoul(argv[++i], NULL, 10);
+            batchDesc.height = (uint32_t)strtoul(argv[++i], NULL, 10);
+            benchSuiteDesc.width = batchDesc.width;
+            benchSuiteDesc.height = batchDesc.height;
+            latencyTest.width = batchDesc.width;
+            latencyTest.height = batchDesc.height;
+            lodCompareDesc.width = batchDesc.width;
+            lodCompareDesc.height = batchDesc.height;
+            multiViewDesc.width = batchDesc.width;
+            multiViewDesc.height = batchDesc.height;
+            tileBinBenchDesc.width = batchDesc.width;
+            tileBinBenchDesc.height = batchDesc.height;
+            restirBenchDesc.width = batchDesc.width;
+            restirBenchDesc.height = batchDesc.height;
         }
-        if (runningOffset >= MAX_GRID_INDICES)
+        if (strcmp(argv[i], "--low-latency") == 0) lowLatency = 1u;
+        if ((strcmp(argv[i], "--capture") == 0) && (i + 1 < argc)) capturePath = argv[++i];
+        if (strcmp(argv[i], "--progressive") == 0) progressive = 1u;
+        if (strcmp(argv[i], "--render-graph-dump") == 0) renderGraphDump = 1u;
+        if (strcmp(argv[i], "--render-graph-check") == 0) renderGraphCheck = 1u;
+        if ((strcmp(argv[i], "--frame-budget") == 0) && (i + 1 < argc))
         {
-            count = 0u;
+            progressive = 1u;
+            frameBudgetMs = strtof(argv[++i], NULL);
         }
-        else if ((runningOffset + count) > MAX_GRID_INDICES)
+        if ((strcmp(argv[i], "--latency-test") == 0) && (i + 1 < argc)) latencyTest.frames = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if (strcmp(argv[i], "--bench-suite") == 0) benchSuite = 1u;
+        if (strcmp(argv[i], "--compact-grid") == 0) useCompactGrid = 1u;
+        if (strcmp(argv[i], "--bench-compact-grid") == 0) compactGridBench = 1u;
+        if (strcmp(argv[i], "--bench-full") == 0)
         {
-            count = MAX_GRID_INDICES - runningOffset;
+            benchSuite = 1u;
+            benchSuiteDesc.full = 1u;
         }
-        gridCellWords[cell * 2u + 0u] = runningOffset;
-        gridCellWords[cell * 2u + 1u] = count;
-        runningOffset += count;
+        if ((strcmp(argv[i], "--bench-frames") == 0) && (i + 1 < argc)) benchSuiteDesc.frames = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if ((strcmp(argv[i], "--bench-out") == 0) && (i + 1 < argc)) benchSuiteDesc.outputPath = argv[++i];
+        if ((strcmp(argv[i], "--bench-baseline") == 0) && (i + 1 < argc)) benchSuiteDesc.baselinePath = argv[++i];
+        if ((strcmp(argv[i], "--bench-tolerance") == 0) && (i + 1 < argc)) benchSuiteDesc.tolerance = strtod(argv[++i], NULL);
     }
-    gridCellCount = GRID_CELL_COUNT;
-    gridIndexCount = runningOffset;
-    printf("grid cells %u non-empty %u max-cell %u refs %u spheres %u\n",
-           gridCellCount, nonEmptyCellCount, maxCellCount, gridIndexCount, packedSphereCount);
-
-    for (uint32_t sphereIndex = 0u; sphereIndex < packedSphereCount; ++sphereIndex)
+    if (benchSceneGen != 0u)
     {
-        float cx = 0.0f;
-        float cy = 0.0f;
-        float cz = 0.0f;
-        float radius = 0.0f;
-        decodePackedSphereCpu(sphereIndex, &cx, &cy, &cz, &radius);
-
-        int32_t minX = (int32_t)floorf((cx - radius - SCENE_MIN[0]) / cellSizeX);
-        int32_t minY = (int32_t)floorf((cy - radius - SCENE_MIN[1]) / cellSizeY);
-        int32_t minZ = (int32_t)floorf((cz - radius - SCENE_MIN[2]) / cellSizeZ);
-        int32_t maxX = (int32_t)floorf((cx + radius - SCENE_MIN[0]) / cellSizeX);
-        int32_t maxY = (int32_t)floorf((cy + radius - SCENE_MIN[1]) / cellSizeY);
-        int32_t maxZ = (int32_t)floorf((cz + radius - SCENE_MIN[2]) / cellSizeZ);
-
-        uint32_t clampedMinX = clampGridCoord(minX, GRID_RES_X);
-        uint32_t clampedMinY = clampGridCoord(minY, GRID_RES_Y);
-        uint32_t clampedMinZ = clampGridCoord(minZ, GRID_RES_Z);
-        uint32_t clampedMaxX = clampGridCoord(maxX, GRID_RES_X);
-        uint32_t clampedMaxY = clampGridCoord(maxY, GRID_RES_Y);
-        uint32_t clampedMaxZ = clampGridCoord(maxZ, GRID_RES_Z);
-
-        for (uint32_t z = clampedMinZ; z <= clampedMaxZ; ++z)
+        if (sceneGenDesc.sphereCount == 0u) sceneGenDesc.sphereCount = SCENE_GEN_BENCH_SPHERES;
+        return runSceneGenBenchmark(&sceneGenDesc);
+    }
+    if ((batchDesc.width == 0u) || (batchDesc.height == 0u) || (batchDesc.samples == 0u)) return 1;
+    if (batchDesc.tileSize < COMPUTE_TILE_SIZE) batchDesc.tileSize = COMPUTE_TILE_SIZE;
+    if (benchSuiteDesc.frames == 0u) benchSuiteDesc.frames = 1u;
+    benchSuiteDesc.compactGrid = useCompactGrid;
+    if (frameBudgetMs <= 0.0f) frameBudgetMs = PROGRESSIVE_DEFAULT_BUDGET_MS;
+    // Accumulation assumes a static scene; animated edits would land mid-pass.
+    if (progressive != 0u) animateSpheres = 0u;
+
+    // The coordinator needs no device: it hands tiles to copies of this process, which
+    // rebuild the scene from the same arguments minus the distribution ones.
+    if ((batchDesc.path != NULL) && (workerAddress == NULL) &&
+        (coordinatorDesc.localWorkers + coordinatorDesc.remoteWorkers > 0u))
+    {
+        const char **workerArgs = (const char **)malloc(sizeof(const char *) * (size_t)argc);
+        if (workerArgs == NULL) return 1;
+        uint32_t workerArgCount = 0u;
+        workerArgs[workerArgCount++] = argv[0];
+        for (int i = 1; i < argc; ++i)
         {
-            for (uint32_t y = clampedMinY; y <= clampedMaxY; ++y)
+            const uint32_t skip = (uint32_t)((strcmp(argv[i], "--distribute") == 0) || (strcmp(argv[i], "--remote-workers") == 0) ||
+                                             (strcmp(argv[i], "--distribute-port") == 0) || (strcmp(argv[i], "--batch") == 0) ||
+                                             (strcmp(argv[i], "--worker") == 0) || (strcmp(argv[i], "--device") == 0));
+            if (skip != 0u)
             {
-                for (uint32_t x = clampedMinX; x <= clampedMaxX; ++x)
-                {
-                    uint32_t cellIndex = x + y * GRID_RES_X + z * GRID_RES_X * GRID_RES_Y;
-                    uint32_t cellOffset = gridCellWords[cellIndex * 2u + 0u];
-                    uint32_t cellCount = gridCellWords[cellIndex * 2u + 1u];
-                    uint32_t cursor = cellCursor[cellIndex];
-                    if (cursor < cellCount)
-                    {
-                        gridIndexWords[cellOffset + cursor] = sphereIndex;
-                        cellCursor[cellIndex] = cursor + 1u;
-                    }
-                }
+                i += 1;
+                continue;
             }
+            workerArgs[workerArgCount++] = argv[i];
         }
+        coordinatorDesc.path = batchDesc.path;
+        coordinatorDesc.width = batchDesc.width;
+        coordinatorDesc.height = batchDesc.height;
+        coordinatorDesc.samples = batchDesc.samples;
+        coordinatorDesc.tileSize = batchDesc.tileSize;
+        if ((coordinatorDesc.sampleChunk == 0u) || (coordinatorDesc.sampleChunk > batchDesc.samples))
+        {
+            coordinatorDesc.sampleChunk = batchDesc.samples;
+        }
+        coordinatorDesc.workerArgs = workerArgs;
+        coordinatorDesc.workerArgCount = workerArgCount;
+        coordinatorDesc.deviceCount = countPhysicalDevices();
+        const int result = gbbRunCoordinator(&coordinatorDesc);
+        free(workerArgs);
+        return result;
     }
-}
 
-int main(void)
-{
-    gbbInitWindow(1280u, 720u, APPLICATION_NAME);
+    latencyTest.lowLatency = lowLatency;
+    latencyTest.capturePath = capturePath;
+    const uint32_t headless = (uint32_t)((batchDesc.path != NULL) || (benchSuite != 0u) || (latencyTest.frames > 0u) ||
+                                         (lodCompare != 0u) || (multiViewDesc.views > 0u) || (compactGridBench != 0u) ||
+                                         (tileBinBench != 0u) || (restirBench != 0u) || (workerAddress != NULL) ||
+                                         (renderGraphCheck != 0u));
+    if ((headless == 0u) && (gbbInitWindow(1280u, 720u, APPLICATION_NAME) != 0))
+    {
+        fprintf(stderr, "no window available; use --batch, --bench-suite, --latency-test, --lod-compare, --multi-view,\n"
+                        "--bench-compact-grid, --bench-tile-bins, --bench-restir, --worker or --render-graph-check\n");
+        return 1;
+    }
 
-    vkCreateInstance(&(VkInstanceCreateInfo){
-        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
-        .flags = INSTANCE_FLAGS,
-        .pApplicationInfo = &(VkApplicationInfo){
-            .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
-            .pApplicationName = APPLICATION_NAME,
-            .applicationVersion = VK_MAKE_API_VERSION(0, 0, 1, 0),
-            .pEngineName = APPLICATION_NAME,
-            .engineVersion = VK_MAKE_API_VERSION(0, 0, 1, 0),
-            .apiVersion = VK_API_VERSION_1_3,
-        },
-        .enabledExtensionCount = (uint32_t)(sizeof(INSTANCE_EXTS) / sizeof(*INSTANCE_EXTS)),
-        .ppEnabledExtensionNames = INSTANCE_EXTS,
-    }, NULL, &instance);
+    createInstance();
 
 #if defined(_WIN32)
-    vkCreateWin32SurfaceKHR(instance, &(VkWin32SurfaceCreateInfoKHR){
+    if (headless == 0u) vkCreateWin32SurfaceKHR(instance, &(VkWin32SurfaceCreateInfoKHR){
         .sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
         .hinstance = GetModuleHandleA(NULL),
         .hwnd = (HWND)window_handle,
     }, NULL, &surface);
 #elif defined(__APPLE__)
-    vkCreateMetalSurfaceEXT(instance, &(VkMetalSurfaceCreateInfoEXT){
+    if (headless == 0u) vkCreateMetalSurfaceEXT(instance, &(VkMetalSurfaceCreateInfoEXT){
         .sType = VK_STRUCTURE_TYPE_METAL_SURFACE_CREATE_INFO_EXT,
         .pLayer = surface_layer,
     }, NULL, &surface);
 #endif
 
-    uint32_t deviceCount = 1u;
-    vkEnumeratePhysicalDevices(instance, &deviceCount, &physicalDevice);
+    // --device picks among the first few adapters; the coordinator spreads local workers
+    // over them.
+    VkPhysicalDevice physicalDevices[MAX_PHYSICAL_DEVICES];
+    uint32_t deviceCount = MAX_PHYSICAL_DEVICES;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, physicalDevices);
+    if (deviceCount == 0u)
+    {
+        fprintf(stderr, "no Vulkan device\n");
+        return 1;
+    }
+    if (deviceIndex >= deviceCount)
+    {
+        fprintf(stderr, "--device %u: only %u Vulkan devices\n", deviceIndex, deviceCount);
+        return 1;
+    }
+    physicalDevice = physicalDevices[deviceIndex];
 
     float priority = 1.0f;
     vkCreateDevice(physicalDevice, &(VkDeviceCreateInfo){
@@ -449,7 +3507,7 @@ int main(void)
             .queueCount = 1u,
             .pQueuePriorities = &priority,
         },
-        .enabledExtensionCount = (uint32_t)(sizeof(DEVICE_EXTS) / sizeof(*DEVICE_EXTS)),
+        .enabledExtensionCount = DEVICE_EXT_COUNT,
         .ppEnabledExtensionNames = DEVICE_EXTS,
     }, NULL, &device);
 
@@ -458,48 +3516,114 @@ int main(void)
     vkGetPhysicalDeviceProperties(physicalDevice, &deviceProps);
     const float timestampPeriodNs = deviceProps.limits.timestampPeriod;
 
-    VkSurfaceCapabilitiesKHR caps;
-    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &caps);
-    swapExtent = caps.currentExtent;
-    uint32_t swapchainMinImageCount = 3u;
-    if (swapchainMinImageCount < caps.minImageCount) swapchainMinImageCount = caps.minImageCount;
-    if ((caps.maxImageCount != 0u) && (swapchainMinImageCount > caps.maxImageCount)) swapchainMinImageCount = caps.maxImageCount;
-
-    vkCreateSwapchainKHR(device, &(VkSwapchainCreateInfoKHR){
-        .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-        .surface = surface,
-        .minImageCount = swapchainMinImageCount,
-        .imageFormat = VK_FORMAT_B8G8R8A8_UNORM,
-        .imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
-        .imageExtent = swapExtent,
-        .imageArrayLayers = 1u,
-        .imageUsage = VK_IMAGE_USAGE_STORAGE_BIT,
-        .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .preTransform = caps.currentTransform,
-        .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-        .presentMode = VK_PRESENT_MODE_FIFO_KHR,
-        .clipped = VK_TRUE,
-    }, NULL, &swapchain);
-
     uint32_t swapImageCount = 0u;
-    vkGetSwapchainImagesKHR(device, swapchain, &swapImageCount, NULL);
-
-    if (swapImageCount > MAX_SWAP_IMAGES) return 1;
-
-    vkGetSwapchainImagesKHR(device, swapchain, &swapImageCount, swapImages);
+    if (headless == 0u)
+    {
+        VkSurfaceCapabilitiesKHR caps;
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &caps);
+        swapExtent = caps.currentExtent;
+        // Low-latency pacing prefers MAILBOX, which replaces a queued image instead of
+        // waiting behind it; under FIFO it keeps the queue to the minimum image count.
+        VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+        uint32_t swapchainMinImageCount = 3u;
+        if (lowLatency != 0u)
+        {
+            VkPresentModeKHR presentModes[8];
+            uint32_t presentModeCount = 8u;
+            vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModeCount, presentModes);
+            for (uint32_t i = 0u; i < presentModeCount; ++i)
+            {
+                if (presentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR) presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+            }
+            swapchainMinImageCount = (presentMode == VK_PRESENT_MODE_MAILBOX_KHR) ? 3u : 2u;
+        }
+        if (swapchainMinImageCount < caps.minImageCount) swapchainMinImageCount = caps.minImageCount;
+        if ((caps.maxImageCount != 0u) && (swapchainMinImageCount > caps.maxImageCount)) swapchainMinImageCount = caps.maxImageCount;
+
+        vkCreateSwapchainKHR(device, &(VkSwapchainCreateInfoKHR){
+            .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+            .surface = surface,
+            .minImageCount = swapchainMinImageCount,
+            .imageFormat = VK_FORMAT_B8G8R8A8_UNORM,
+            .imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
+            .imageExtent = swapExtent,
+            .imageArrayLayers = 1u,
+            .imageUsage = VK_IMAGE_USAGE_STORAGE_BIT | ((capturePath != NULL) ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0u) |
+                          ((progressive != 0u) ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0u),
+            .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .preTransform = caps.currentTransform,
+            .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+            .presentMode = presentMode,
+            .clipped = VK_TRUE,
+        }, NULL, &swapchain);
+
+        vkGetSwapchainImagesKHR(device, swapchain, &swapImageCount, NULL);
+
+        if (swapImageCount > MAX_SWAP_IMAGES) return 1;
+
+        vkGetSwapchainImagesKHR(device, swapchain, &swapImageCount, swapImages);
+    }
 
-    buildPackedSpheres();
-    buildUniformGrid();
-    sphereBufferSize = (VkDeviceSize)(packedSphereCount * 2u * sizeof(uint32_t));
-    if (sphereBufferSize == 0u) sphereBufferSize = sizeof(uint32_t) * 2u;
-    gridCellBufferSize = (VkDeviceSize)(gridCellCount * 2u * sizeof(uint32_t));
-    if (gridCellBufferSize == 0u) gridCellBufferSize = sizeof(uint32_t) * 2u;
-    gridIndexBufferSize = (VkDeviceSize)(((gridIndexCount > 0u) ? gridIndexCount : 1u) * sizeof(uint32_t));
-    createStorageBuffer(packedSphereWords, sphereBufferSize, &sphereBuffer, &sphereBufferMemory);
-    createStorageBuffer(gridCellWords, gridCellBufferSize, &gridCellBuffer, &gridCellBufferMemory);
-    createStorageBuffer(gridIndexWords, gridIndexBufferSize, &gridIndexBuffer, &gridIndexBufferMemory);
+    uint32_t gridDims[3] = {GRID_RES_X, GRID_RES_Y, GRID_RES_Z};
+    if (instancedDesc.instanceCount > 0u)
+    {
+        instancedDesc.seed = sceneGenDesc.seed;
+        instancedDesc.block = sceneGenDesc;
+        uint64_t buildStart = gbbGetTimeNs();
+        if (gbbBuildInstancedScene(&instancedScene, &instancedDesc) != 0) return 1;
+        uint64_t uniqueBytes = 0u;
+        uint64_t flattenedBytes = 0u;
+        gbbInstancedSceneFootprint(&instancedScene, &uniqueBytes, &flattenedBytes);
+        printf("instanced scene: %u instances of %u blocks in %.2f ms, top grid %ux%ux%u, %.2f MB (flattened %.2f MB)\n",
+               instancedScene.instanceCount, instancedScene.blockCount, (double)(gbbGetTimeNs() - buildStart) * 1e-6,
+               instancedScene.topGrid.dims[0], instancedScene.topGrid.dims[1], instancedScene.topGrid.dims[2],
+               (double)uniqueBytes / (1024.0 * 1024.0), (double)flattenedBytes / (1024.0 * 1024.0));
+        animateSpheres = 0u;
+    }
+    else if (sceneGenDesc.sphereCount > 0u)
+    {
+        uint64_t genStart = gbbGetTimeNs();
+        gbbGenerateSpheres(&spheres, &sceneGenDesc);
+        printf("generated %u spheres in %.2f ms\n", spheres.count, (double)(gbbGetTimeNs() - genStart) * 1e-6);
+        gbbChooseGridDims(&spheres, gridDims);
+    }
+    else
+    {
+        gbbBuildPackedSpheres(&spheres, MAX_PACKED_SPHERES);
+    }
+    if (instancedScene.instanceCount == 0u)
+    {
+        gbbBuildSphereGrid(&grid, &spheres, gridDims[0], gridDims[1], gridDims[2], (animateSpheres != 0u) ? ANIMATED_GRID_SLACK : 0u);
+        printGridStats(&grid, spheres.count);
+        // Edits would have to re-encode the whole stream, so only static scenes are packed.
+        if ((useCompactGrid != 0u) && (animateSpheres == 0u))
+        {
+            if (gbbBuildCompactGrid(&compactGrid, &grid, spheres.count) != 0)
+            {
+                fprintf(stderr, "compact grid: encoding does not fit; using the regular layout\n");
+            }
+            else
+            {
+                printf("compact grid: %u-bit references, %u-bit cells, %.2f MB (regular layout %.2f MB)\n",
+                       compactGrid.indexBits, compactGrid.countBits + compactGrid.deltaBits,
+                       (double)compactGrid.wordCount * sizeof(uint32_t) / (1024.0 * 1024.0),
+                       ((double)grid.cellCount * 2u + grid.indexCount) * sizeof(uint32_t) / (1024.0 * 1024.0));
+            }
+        }
+        // Proxies are built once from the static scene; animated edits would leave them stale.
+        if ((useLod != 0u) && (animateSpheres == 0u))
+        {
+            if (lodBounce == 0u) lodBounce = LOD_DEFAULT_BOUNCE;
+            uint64_t lodStart = gbbGetTimeNs();
+            if (gbbBuildSphereLod(&sphereLod, &spheres, &grid, lodMacroSize) != 0) return 1;
+            printf("lod: %u proxies for %u spheres in a %ux%ux%u grid, %.2f ms\n", sphereLod.proxies.count, spheres.count,
+                   sphereLod.grid.dims[0], sphereLod.grid.dims[1], sphereLod.grid.dims[2],
+                   (double)(gbbGetTimeNs() - lodStart) * 1e-6);
+        }
+    }
+    createSceneBuffers();
 
-    VkDescriptorSetLayoutBinding descriptorBindings[4] = {
+    VkDescriptorSetLayoutBinding descriptorBindings[14] = {
         {
             .binding = 0u,
             .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
@@ -524,21 +3648,81 @@ int main(void)
             .descriptorCount = 1u,
             .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
         },
+        {
+            .binding = 4u,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1u,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 5u,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1u,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 6u,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .descriptorCount = 1u,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 7u,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1u,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 8u,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .descriptorCount = 1u,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 9u,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1u,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 10u,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1u,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 11u,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1u,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 12u,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1u,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 13u,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1u,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
     };
     vkCreateDescriptorSetLayout(device, &(VkDescriptorSetLayoutCreateInfo){
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .bindingCount = 4u,
+        .bindingCount = 14u,
         .pBindings = descriptorBindings,
     }, NULL, &descriptorSetLayout);
 
     VkDescriptorPoolSize descriptorPoolSizes[2] = {
         {
             .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-            .descriptorCount = MAX_SWAP_IMAGES,
+            .descriptorCount = MAX_SWAP_IMAGES * 3u,
         },
         {
             .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-            .descriptorCount = MAX_SWAP_IMAGES * 3u,
+            .descriptorCount = MAX_SWAP_IMAGES * 11u,
         },
     };
     vkCreateDescriptorPool(device, &(VkDescriptorPoolCreateInfo){
@@ -573,26 +3757,9 @@ int main(void)
         .pPushConstantRanges = &pushConstantRange,
     }, NULL, &pipelineLayout);
 
-    VkShaderModule shaderModule = VK_NULL_HANDLE;
-    vkCreateShaderModule(device, &(VkShaderModuleCreateInfo){
-        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-        .codeSize = gradientCompSpv_size,
-        .pCode = gradientCompSpv,
-     }, NULL, &shaderModule);
-
-    vkCreateComputePipelines(device, VK_NULL_HANDLE, 1u, &(VkComputePipelineCreateInfo){
-        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-        .stage = {
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
-            .module = shaderModule,
-            .pName = "main",
-        },
-        .layout = pipelineLayout,
-        .basePipelineIndex = -1,
-    }, NULL, &pipeline);
-
-    vkDestroyShaderModule(device, shaderModule, NULL);
+    pipeline = createComputePipeline(gradientCompSpv, gradientCompSpv_size);
+    probePipeline = createComputePipeline(probeUpdateCompSpv, probeUpdateCompSpv_size);
+    tileBinPipeline = createComputePipeline(tileBinCompSpv, tileBinCompSpv_size);
 
     vkCreateCommandPool(device, &(VkCommandPoolCreateInfo){
         .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
@@ -609,16 +3776,76 @@ int main(void)
     vkCreateQueryPool(device, &(VkQueryPoolCreateInfo){
         .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
         .queryType = VK_QUERY_TYPE_TIMESTAMP,
-        .queryCount = 2u,
+        .queryCount = 3u,
     }, NULL, &timestampQueryPool);
+    // Probes are refreshed by the interactive loop only; headless renders trace fully.
+    createProbeCache((uint32_t)((useProbes != 0u) && (headless == 0u)));
+    if (multiViewDesc.views > 0u)
+    {
+        multiViewDesc.views = createViewTargets(multiViewDesc.width, multiViewDesc.height, multiViewDesc.views);
+    }
+    else
+    {
+        createViewTargets(1u, 1u, 1u);
+    }
+    // Tile lists are sized for the largest frame the chosen mode traces; other modes
+    // leave them off.
+    uint32_t binSize[2] = {0u, 0u};
+    if ((useTileBins != 0u) && (instancedScene.instanceCount == 0u))
+    {
+        if (tileBinBench != 0u)
+        {
+            binSize[0] = tileBinBenchDesc.width;
+            binSize[1] = tileBinBenchDesc.height;
+        }
+        else if ((batchDesc.path != NULL) || (workerAddress != NULL))
+        {
+            binSize[0] = batchDesc.width;
+            binSize[1] = batchDesc.height;
+        }
+        else if (headless == 0u)
+        {
+            binSize[0] = swapExtent.width;
+            binSize[1] = swapExtent.height;
+        }
+    }
+    createTileBins(binSize[0], binSize[1]);
+    // Reservoirs follow the interactive swapchain frame; progressive frames already
+    // converge by accumulation.
+    if (restirBench != 0u)
+    {
+        createRestirState(restirBenchDesc.width, restirBenchDesc.height);
+    }
+    else if ((useRestir != 0u) && (headless == 0u) && (progressive == 0u))
+    {
+        createRestirState(swapExtent.width, swapExtent.height);
+    }
+    else
+    {
+        createRestirState(0u, 0u);
+    }
+    if (probeDims[0] != 0u)
+    {
+        printf("probes: %ux%ux%u grid, %u refreshed per frame\n", probeDims[0], probeDims[1], probeDims[2],
+               PROBE_UPDATES_PER_FRAME);
+    }
+    if ((restirWidth != 0u) && (restirBench == 0u))
+    {
+        printf("restir: %ux%u reservoirs, %.1f MB\n", restirWidth, restirHeight, (double)restirBufferSize / (1024.0 * 1024.0));
+    }
 
-    VkImageSubresourceRange imageRange = {
-        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-        .levelCount = 1u,
-        .layerCount = 1u
-    };
-
-    for (uint32_t i = 0u; i < swapImageCount; i++)
+    if (renderGraphCheck != 0u) return runRenderGraphCheck();
+    if (compactGridBench != 0u) return runCompactGridBench(&benchSuiteDesc);
+    if (benchSuite != 0u) return runBenchSuite(&benchSuiteDesc);
+    if (latencyTest.frames > 0u) return runLatencyTest(&latencyTest);
+    if (lodCompare != 0u) return runLodCompare(&lodCompareDesc);
+    if (multiViewDesc.views > 0u) return runMultiView(&multiViewDesc);
+    if (tileBinBench != 0u) return runTileBinBench(&tileBinBenchDesc);
+    if (restirBench != 0u) return runRestirBench(&restirBenchDesc);
+    if (workerAddress != NULL) return runRenderWorker(workerAddress);
+    if (batchDesc.path != NULL) return runBatchRender(&batchDesc);
+
+    for (uint32_t i = 0u; (progressive == 0u) && (i < swapImageCount); i++)
     {
         vkCreateImageView(device, &(VkImageViewCreateInfo){
             .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
@@ -630,63 +3857,35 @@ int main(void)
                 .levelCount = 1u,
                 .layerCount = 1u,
             },
-        }, NULL, &swapImageViews[i]);
+        }, NULL, &outputImageViews[i]);
+    }
 
-        VkDescriptorImageInfo imageInfo = {
-            .imageView = swapImageViews[i],
-            .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
-        };
-        VkDescriptorBufferInfo sphereBufferInfo = {
-            .buffer = sphereBuffer,
-            .offset = 0u,
-            .range = sphereBufferSize,
-        };
-        VkDescriptorBufferInfo gridCellBufferInfo = {
-            .buffer = gridCellBuffer,
-            .offset = 0u,
-            .range = gridCellBufferSize,
-        };
-        VkDescriptorBufferInfo gridIndexBufferInfo = {
-            .buffer = gridIndexBuffer,
-            .offset = 0u,
-            .range = gridIndexBufferSize,
-        };
-        VkWriteDescriptorSet writes[4] = {
-            {
-                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet = descriptorSets[i],
-                .dstBinding = 0u,
-                .descriptorCount = 1u,
-                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                .pImageInfo = &imageInfo,
-            },
-            {
-                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet = descriptorSets[i],
-                .dstBinding = 1u,
-                .descriptorCount = 1u,
-                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                .pBufferInfo = &sphereBufferInfo,
-            },
-            {
-                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet = descriptorSets[i],
-                .dstBinding = 2u,
-                .descriptorCount = 1u,
-                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                .pBufferInfo = &gridCellBufferInfo,
-            },
-            {
-                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet = descriptorSets[i],
-                .dstBinding = 3u,
-                .descriptorCount = 1u,
-                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                .pBufferInfo = &gridIndexBufferInfo,
-            },
-        };
-        vkUpdateDescriptorSets(device, 4u, writes, 0u, NULL);
+    // Interactive frames never accumulate, but binding 6 still needs a valid image.
+    // Progressive frames trace into their own full-size images instead of the swapchain.
+    ProgressiveState progressiveState = {0};
+    if (progressive != 0u)
+    {
+        createProgressiveState(&progressiveState, swapExtent.width, swapExtent.height, frameBudgetMs);
+        for (uint32_t i = 0u; i < swapImageCount; i++)
+        {
+            outputImageViews[i] = progressiveState.progressView;
+            accumImageViews[i] = progressiveState.accumView;
+        }
+        printf("progressive: %u tiles of %u px per pass, %.1f ms GPU budget per frame\n", progressiveState.tileCount,
+               PROGRESSIVE_TILE, (double)frameBudgetMs);
+    }
+    else
+    {
+        VkImage accumImage = VK_NULL_HANDLE;
+        VkDeviceMemory accumMemory = VK_NULL_HANDLE;
+        createStorageImage(VK_FORMAT_R32G32B32A32_SFLOAT, 1u, 1u, &accumImage, &accumMemory, &accumImageViews[0]);
+        transitionImagesToGeneral(&accumImage, 1u);
+        for (uint32_t i = 1u; i < swapImageCount; i++)
+        {
+            accumImageViews[i] = accumImageViews[0];
+        }
     }
+    writeSceneDescriptors(swapImageCount);
 
     vkCreateSemaphore(device, &(VkSemaphoreCreateInfo){
         .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
@@ -701,28 +3900,39 @@ int main(void)
     }, NULL, &inFlightFence);
 
     float cameraFocus[3] = {0.0f, 0.0f, 0.0f};
-    float cameraZoom = 26.0f;
-    const float cameraYaw = 0.7853981634f;
-    const float cameraPitch = -0.7853981634f;
-    const float cameraFov = 0.2967059728f;
-    const float cameraForwardX = sinf(cameraYaw) * cosf(cameraPitch);
-    const float cameraForwardY = sinf(cameraPitch);
-    const float cameraForwardZ = cosf(cameraYaw) * cosf(cameraPitch);
-    const float forwardLenXZ = sqrtf(cameraForwardX * cameraForwardX + cameraForwardZ * cameraForwardZ);
-    const float moveForwardX = cameraForwardX / fmaxf(forwardLenXZ, 1e-6f);
-    const float moveForwardZ = cameraForwardZ / fmaxf(forwardLenXZ, 1e-6f);
-    const float moveRightX = -moveForwardZ;
-    const float moveRightZ = moveForwardX;
+    float cameraZoom = CAMERA_DEFAULT_ZOOM;
+
+    uint32_t *animationBaseWords = NULL;
+    SphereEdit *animationEdits = NULL;
+    if (animateSpheres != 0u)
+    {
+        animationBaseWords = (uint32_t *)malloc((size_t)spheres.count * 2u * sizeof(uint32_t));
+        animationEdits = (SphereEdit *)malloc((size_t)spheres.count * sizeof(SphereEdit));
+        if (!animationBaseWords || !animationEdits) return 1;
+        memcpy(animationBaseWords, spheres.words, (size_t)spheres.count * 2u * sizeof(uint32_t));
+    }
+    const uint32_t animatedSphereCount = spheres.count;
+    const uint64_t animationStartTime = gbbGetTimeNs();
 
-    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    const VkPipelineStageFlags waitStage = (progressive != 0u) ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
     uint64_t last_time = gbbGetTimeNs();
     float frame_time_accum_ms = 0.0f;
     uint32_t frame_time_count = 0u;
     float gpu_time_accum_ms = 0.0f;
     uint32_t gpu_time_count = 0u;
     uint32_t has_gpu_timestamps = 0u;
-    while (gbbPumpEventsOnce() == 0)
+    LatencyStats latency = {0};
+    uint64_t inFlightInputTime = 0u;
+    CaptureRing captureRing = {.pendingSlot = UINT32_MAX};
+    if (capturePath && (startCaptureRing(&captureRing, capturePath, swapExtent.width, swapExtent.height, 1u) != 0)) return 1;
+    FrameGraph frameGraph = {0};
+    const int graphStatus = (progressive != 0u) ? buildProgressiveGraph(&frameGraph, &progressiveState, &captureRing)
+                                                : buildInteractiveGraph(&frameGraph, &captureRing);
+    if (graphStatus != 0) return 1;
+    for (;;)
     {
+        if ((lowLatency == 0u) && (gbbPumpEventsOnce() != 0)) break;
+
         uint64_t now_time = gbbGetTimeNs();
         float delta_time = (float)(now_time - last_time) * 1e-9f;
         last_time = now_time;
@@ -735,6 +3945,8 @@ int main(void)
             float fps = 1000.0f / avg_ms;
             float avg_gpu_ms = (gpu_time_count > 0u) ? (gpu_time_accum_ms / (float)gpu_time_count) : 0.0f;
             printf("frame %.2f ms (%.1f FPS), gpu %.3f ms\n", avg_ms, fps, avg_gpu_ms);
+            printLatencyStats((lowLatency != 0u) ? "low-latency" : "latency", &latency);
+            latency = (LatencyStats){0};
             frame_time_accum_ms = 0.0f;
             frame_time_count = 0u;
             gpu_time_accum_ms = 0.0f;
@@ -743,89 +3955,82 @@ int main(void)
 
         vkWaitForFences(device, 1u, &inFlightFence, VK_TRUE, UINT64_MAX);
         vkResetFences(device, 1u, &inFlightFence);
+        flushCaptureRing(&captureRing);
+        if (inFlightInputTime != 0u)
+        {
+            recordLatency(&latency.inputToGpuMs, &latency.inputToGpuMaxMs, &latency.gpuCount, inFlightInputTime, gbbGetTimeNs());
+            inFlightInputTime = 0u;
+        }
         if (has_gpu_timestamps != 0u)
         {
             uint64_t timestamps[2] = {0u, 0u};
             vkGetQueryPoolResults(device, timestampQueryPool, 0u, 2u, sizeof(timestamps), timestamps, sizeof(uint64_t),
                                   VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
-            gpu_time_accum_ms += (float)(timestamps[1] - timestamps[0]) * timestampPeriodNs * 1e-6f;
+            const float frameGpuMs = (float)(timestamps[1] - timestamps[0]) * timestampPeriodNs * 1e-6f;
+            gpu_time_accum_ms += frameGpuMs;
             gpu_time_count += 1u;
+            updateProgressiveCost(&progressiveState, frameGpuMs);
+        }
+
+        if (animateSpheres != 0u)
+        {
+            const float animationTime = (float)(now_time - animationStartTime) * 1e-9f;
+            for (uint32_t i = 0u; i < animatedSphereCount; ++i)
+            {
+                float center[3];
+                float radius = 0.0f;
+                gbbDecodeSphere(&spheres.bounds, &animationBaseWords[i * 2u], center, &radius);
+                center[1] += 1.5f * (0.5f + 0.5f * sinf(animationTime * 2.0f + (float)i * 0.37f));
+                animationEdits[i].op = SPHERE_EDIT_MOVE;
+                animationEdits[i].sphereIndex = i;
+                gbbPackSphere(&spheres.bounds, center, radius, animationBaseWords[i * 2u + 1u] >> 28u, animationEdits[i].words);
+            }
+            if ((gbbApplySphereEdits(&grid, &spheres, animationEdits, animatedSphereCount) & SPHERE_GRID_FAILED) != 0u)
+            {
+                fprintf(stderr, "animate: out of memory growing the grid; rebuilding it and stopping the animation\n");
+                animateSpheres = 0u;
+                if (gbbBuildSphereGrid(&grid, &spheres, grid.dims[0], grid.dims[1], grid.dims[2], 0u) != 0) break;
+            }
+            uploadSceneEdits(swapImageCount);
         }
 
         uint32_t imageIndex = 0u;
         vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
 
-        float wheelDelta = 0.0f;
-        gbbConsumeMouseWheel(&wheelDelta);
-        cameraZoom *= expf(-wheelDelta * 0.12f);
-        cameraZoom = fmaxf(6.0f, fminf(80.0f, cameraZoom));
-
-        const float move_speed = 8.0f + cameraZoom * 0.35f;
-
-        const float moveForward = (float)gbbIsKeyDown(GBB_KEY_W) - (float)gbbIsKeyDown(GBB_KEY_S);
-        const float moveRight = (float)gbbIsKeyDown(GBB_KEY_D) - (float)gbbIsKeyDown(GBB_KEY_A);
-        float moveNorm = sqrtf(moveForward * moveForward + moveRight * moveRight);
-        float moveForwardUnit = moveForward;
-        float moveRightUnit = moveRight;
-        if (moveNorm > 1e-6f)
-        {
-            moveForwardUnit /= moveNorm;
-            moveRightUnit /= moveNorm;
-        }
-        cameraFocus[0] += (moveForwardX * moveForwardUnit + moveRightX * moveRightUnit) * move_speed * delta_time;
-        cameraFocus[2] += (moveForwardZ * moveForwardUnit + moveRightZ * moveRightUnit) * move_speed * delta_time;
-
-        float cameraPositionX = cameraFocus[0] - cameraForwardX * cameraZoom;
-        float cameraPositionY = cameraFocus[1] - cameraForwardY * cameraZoom;
-        float cameraPositionZ = cameraFocus[2] - cameraForwardZ * cameraZoom;
-
-        ScenePushConstants scenePush = {
-            .origin = {cameraPositionX, cameraPositionY, cameraPositionZ, 0.0f},
-            .forward_fov = {cameraForwardX, cameraForwardY, cameraForwardZ, cameraFov},
-            .scene_min = {SCENE_MIN[0], SCENE_MIN[1], SCENE_MIN[2], 0.0f},
-            .scene_extent = {SCENE_EXTENT[0], SCENE_EXTENT[1], SCENE_EXTENT[2], 0.0f},
-            .radius_min_max = {SPHERE_RADIUS_MIN, SPHERE_RADIUS_MAX, 0.0f, 0.0f},
-            .counts = {packedSphereCount, gridCellCount, gridIndexCount, 0u},
-            .grid_dims = {GRID_RES_X, GRID_RES_Y, GRID_RES_Z, 0u},
-        };
+        // Low-latency pacing pumps events only now, after both waits, so the frame
+        // sees input that arrived while the CPU was blocked.
+        if ((lowLatency != 0u) && (gbbPumpEventsOnce() != 0)) break;
+        uint64_t inputTime = 0u;
+        gbbConsumeInputTime(&inputTime);
+        applyCameraInput(cameraFocus, &cameraZoom, delta_time);
 
         vkResetCommandBuffer(commandBuffer, 0u);
         vkBeginCommandBuffer(commandBuffer, &(VkCommandBufferBeginInfo){
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO
         });
-        vkCmdResetQueryPool(commandBuffer, timestampQueryPool, 0u, 2u);
-        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, 0u);
-
-        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u,
-                             0u, NULL, 0u, NULL, 1u, &(VkImageMemoryBarrier){
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-            .dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
-            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-            .newLayout = VK_IMAGE_LAYOUT_GENERAL,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image = swapImages[imageIndex],
-            .subresourceRange = imageRange
-        });
-
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0u, 1u, &descriptorSets[imageIndex], 0u, NULL);
-        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0u, sizeof(scenePush), &scenePush);
-        vkCmdDispatch(commandBuffer, (swapExtent.width + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE,
-                      (swapExtent.height + COMPUTE_TILE_SIZE - 1u) / COMPUTE_TILE_SIZE, 1u);
-        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampQueryPool, 1u);
+        gbbSetGraphImage(&frameGraph.graph, frameGraph.swapImage, swapImages[imageIndex],
+                         (RenderGraphState){waitStage, 0u, VK_IMAGE_LAYOUT_UNDEFINED});
+        frameGraph.context.swapImage = swapImages[imageIndex];
+        memcpy(frameGraph.context.focus, cameraFocus, sizeof(frameGraph.context.focus));
+        frameGraph.context.zoom = cameraZoom;
+        if (progressive != 0u)
+        {
+            recordProgressiveFrame(&progressiveState, &frameGraph, commandBuffer, cameraFocus, cameraZoom);
+        }
+        else
+        {
+            prepareInteractiveFrame(&frameGraph, swapExtent.width, swapExtent.height, imageIndex);
+            frameGraph.context.captureImage = swapImages[imageIndex];
 
-        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0u,
-                             0u, NULL, 0u, NULL, 1u, &(VkImageMemoryBarrier){
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
-            .oldLayout = VK_IMAGE_LAYOUT_GENERAL,
-            .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image = swapImages[imageIndex],
-            .subresourceRange = imageRange
-        });
+            vkCmdResetQueryPool(commandBuffer, timestampQueryPool, 0u, 2u);
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, 0u);
+            gbbExecuteRenderGraph(&frameGraph.graph, commandBuffer);
+        }
+        if (renderGraphDump != 0u)
+        {
+            gbbDumpRenderGraph(&frameGraph.graph, stdout);
+            renderGraphDump = 0u;
+        }
 
         vkEndCommandBuffer(commandBuffer);
 
@@ -840,6 +4045,11 @@ int main(void)
             .pSignalSemaphores = &renderFinishedSemaphore,
         }, inFlightFence);
         has_gpu_timestamps = 1u;
+        if (inputTime != 0u)
+        {
+            recordLatency(&latency.inputToSubmitMs, &latency.inputToSubmitMaxMs, &latency.submitCount, inputTime, gbbGetTimeNs());
+            inFlightInputTime = inputTime;
+        }
 
         vkQueuePresentKHR(queue, &(VkPresentInfoKHR){
             .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
@@ -850,5 +4060,7 @@ int main(void)
             .pImageIndices = &imageIndex,
         });
     }
+    vkDeviceWaitIdle(device);
+    stopCaptureRing(&captureRing);
     return 0;
 }
@@ -1,6 +1,7 @@
 #ifndef PLATFORM_H
 #define PLATFORM_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -25,8 +26,55 @@ enum {
 };
 int gbbIsKeyDown(uint32_t key);
 void gbbConsumeMouseWheel(float* delta);
+
+// input.c holds the input state shared by every platform layer. Platforms post events
+// stamped with gbbGetTimeNs when they receive them; gbbConsumeInputTime returns the
+// oldest stamp not yet consumed, so a frame can report its input-to-submit latency.
+void gbbPostKeyEvent(uint32_t key, int down, uint64_t timeNs);
+void gbbPostMouseWheel(float delta, uint64_t timeNs);
+int gbbConsumeInputTime(uint64_t* timeNs);
+
+// Scripted input for headless runs. timeNs is relative to startNs; a non-zero loopNs
+// replays the script every loopNs. Events with key >= GBB_KEY_COUNT only scroll.
+typedef struct GbbInputEvent {
+    uint64_t timeNs;
+    uint32_t key;
+    uint32_t down;
+    float wheel;
+} GbbInputEvent;
+void gbbSetInputScript(const GbbInputEvent* events, uint32_t count, uint64_t startNs, uint64_t loopNs);
+uint32_t gbbPlayInputScript(uint64_t nowNs);
 uint64_t gbbGetTimeNs(void);
 
+typedef void (*GbbThreadProc)(void* user);
+void* gbbCreateThread(GbbThreadProc proc, void* user);
+void gbbJoinThread(void* thread);
+uint32_t gbbGetCpuCount(void);
+
+// Counting semaphore for handing work between threads; the signal/wait pair also
+// orders the memory accesses around it.
+void* gbbCreateSemaphore(uint32_t initialCount);
+void gbbDestroySemaphore(void* semaphore);
+void gbbWaitSemaphore(void* semaphore);
+int gbbTryWaitSemaphore(void* semaphore);
+void gbbSignalSemaphore(void* semaphore);
+
+// Blocking TCP streams for the distributed batch render. Handles are opaque and NULL on
+// failure. port 0 listens on any free port, reported through boundPort; gbbAcceptSocket
+// also returns NULL when nothing connected within timeoutMs. Send and receive transfer
+// the whole buffer or fail.
+void* gbbListenSocket(uint16_t port, uint32_t loopbackOnly, uint16_t* boundPort);
+void* gbbAcceptSocket(void* listener, uint32_t timeoutMs);
+void* gbbConnectSocket(const char* host, uint16_t port);
+int gbbSendAll(void* stream, const void* data, size_t size);
+int gbbRecvAll(void* stream, void* data, size_t size);
+void gbbCloseSocket(void* stream);
+
+// Starts argv[0] (looked up on PATH when it has no directory) with the NULL-terminated
+// argv; gbbWaitProcess returns its exit code, or -1 when it could not be waited for.
+void* gbbSpawnProcess(const char* const* argv);
+int gbbWaitProcess(void* process);
+
 #ifdef __cplusplus
 }
 #endif
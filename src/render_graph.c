@@ -0,0 +1,672 @@
+#include <string.h>
+
+#include "render_graph.h"
+
+#define RENDER_GRAPH_WRITE_ACCESS (VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | \
+                                   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | \
+                                   VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT)
+
+typedef struct FlagName {
+    uint32_t bit;
+    const char* name;
+} FlagName;
+
+static const FlagName stageNames[] = {
+    {VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, "TOP_OF_PIPE"},
+    {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, "DRAW_INDIRECT"},
+    {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, "VERTEX_SHADER"},
+    {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, "FRAGMENT_SHADER"},
+    {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, "COLOR_ATTACHMENT_OUTPUT"},
+    {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, "COMPUTE_SHADER"},
+    {VK_PIPELINE_STAGE_TRANSFER_BIT, "TRANSFER"},
+    {VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, "BOTTOM_OF_PIPE"},
+    {VK_PIPELINE_STAGE_HOST_BIT, "HOST"},
+    {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, "ALL_COMMANDS"},
+};
+
+static const FlagName accessNames[] = {
+    {VK_ACCESS_INDIRECT_COMMAND_READ_BIT, "INDIRECT_COMMAND_READ"},
+    {VK_ACCESS_UNIFORM_READ_BIT, "UNIFORM_READ"},
+    {VK_ACCESS_SHADER_READ_BIT, "SHADER_READ"},
+    {VK_ACCESS_SHADER_WRITE_BIT, "SHADER_WRITE"},
+    {VK_ACCESS_COLOR_ATTACHMENT_READ_BIT, "COLOR_ATTACHMENT_READ"},
+    {VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, "COLOR_ATTACHMENT_WRITE"},
+    {VK_ACCESS_TRANSFER_READ_BIT, "TRANSFER_READ"},
+    {VK_ACCESS_TRANSFER_WRITE_BIT, "TRANSFER_WRITE"},
+    {VK_ACCESS_HOST_READ_BIT, "HOST_READ"},
+    {VK_ACCESS_HOST_WRITE_BIT, "HOST_WRITE"},
+    {VK_ACCESS_MEMORY_READ_BIT, "MEMORY_READ"},
+    {VK_ACCESS_MEMORY_WRITE_BIT, "MEMORY_WRITE"},
+};
+
+static void printFlags(FILE* out, uint32_t flags, const FlagName* names, uint32_t nameCount)
+{
+    if (flags == 0u)
+    {
+        fputs("none", out);
+        return;
+    }
+    const char* separator = "";
+    for (uint32_t i = 0u; i < nameCount; ++i)
+    {
+        if ((flags & names[i].bit) == 0u) continue;
+        fprintf(out, "%s%s", separator, names[i].name);
+        separator = "|";
+        flags &= ~names[i].bit;
+    }
+    if (flags != 0u) fprintf(out, "%s0x%x", separator, flags);
+}
+
+static const char* layoutName(VkImageLayout layout)
+{
+    switch (layout)
+    {
+    case VK_IMAGE_LAYOUT_UNDEFINED: return "UNDEFINED";
+    case VK_IMAGE_LAYOUT_GENERAL: return "GENERAL";
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: return "COLOR_ATTACHMENT_OPTIMAL";
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return "SHADER_READ_ONLY_OPTIMAL";
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return "TRANSFER_SRC_OPTIMAL";
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL: return "TRANSFER_DST_OPTIMAL";
+    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: return "PRESENT_SRC";
+    default: return "OTHER";
+    }
+}
+
+static void resetTracking(RenderGraphResource* res, RenderGraphState state)
+{
+    res->layout = state.layout;
+    res->writeAccess = state.access & RENDER_GRAPH_WRITE_ACCESS;
+    res->writeStage = (res->writeAccess != 0u) ? state.stage : 0u;
+    res->readStages = (res->writeAccess != 0u) ? 0u : state.stage;
+    res->visibleStages = 0u;
+    res->visibleAccess = 0u;
+}
+
+static uint32_t addResource(RenderGraph* graph, const char* name, uint32_t isImage, uint32_t transient)
+{
+    if (graph->resourceCount == RENDER_GRAPH_MAX_RESOURCES)
+    {
+        fprintf(stderr, "render graph %s: %s exceeds %u resources\n", graph->name, name, RENDER_GRAPH_MAX_RESOURCES);
+        graph->failed = 1u;
+        return RENDER_GRAPH_INVALID;
+    }
+    const uint32_t index = graph->resourceCount++;
+    RenderGraphResource* res = &graph->resources[index];
+    memset(res, 0, sizeof(*res));
+    res->name = name;
+    res->isImage = isImage;
+    res->transient = transient;
+    res->firstPass = RENDER_GRAPH_INVALID;
+    res->lastPass = RENDER_GRAPH_INVALID;
+    return index;
+}
+
+void gbbInitRenderGraph(RenderGraph* graph, const char* name)
+{
+    memset(graph, 0, sizeof(*graph));
+    graph->name = name;
+}
+
+uint32_t gbbAddGraphImage(RenderGraph* graph, const char* name, VkImage image, RenderGraphState initial)
+{
+    const uint32_t index = addResource(graph, name, 1u, 0u);
+    if (index != RENDER_GRAPH_INVALID) gbbSetGraphImage(graph, index, image, initial);
+    return index;
+}
+
+uint32_t gbbAddGraphBuffer(RenderGraph* graph, const char* name, VkBuffer buffer, RenderGraphState initial)
+{
+    const uint32_t index = addResource(graph, name, 0u, 0u);
+    if (index == RENDER_GRAPH_INVALID) return index;
+    graph->resources[index].buffer = buffer;
+    resetTracking(&graph->resources[index], initial);
+    return index;
+}
+
+uint32_t gbbAddTransientImage(RenderGraph* graph, const char* name, const VkImageCreateInfo* info)
+{
+    const uint32_t index = addResource(graph, name, 1u, 1u);
+    if (index != RENDER_GRAPH_INVALID) graph->resources[index].imageInfo = *info;
+    return index;
+}
+
+uint32_t gbbAddTransientBuffer(RenderGraph* graph, const char* name, const VkBufferCreateInfo* info)
+{
+    const uint32_t index = addResource(graph, name, 0u, 1u);
+    if (index != RENDER_GRAPH_INVALID) graph->resources[index].bufferInfo = *info;
+    return index;
+}
+
+void gbbSetGraphImage(RenderGraph* graph, uint32_t resource, VkImage image, RenderGraphState state)
+{
+    graph->resources[resource].image = image;
+    resetTracking(&graph->resources[resource], state);
+}
+
+void gbbSetGraphFinalState(RenderGraph* graph, uint32_t resource, RenderGraphState state)
+{
+    graph->resources[resource].finalState = state;
+    graph->resources[resource].hasFinalState = 1u;
+}
+
+uint32_t gbbAddGraphPass(RenderGraph* graph, const char* name, RenderGraphRecordFn record, void* user)
+{
+    if (graph->passCount == RENDER_GRAPH_MAX_PASSES)
+    {
+        fprintf(stderr, "render graph %s: pass %s exceeds %u passes\n", graph->name, name, RENDER_GRAPH_MAX_PASSES);
+        graph->failed = 1u;
+        return RENDER_GRAPH_INVALID;
+    }
+    RenderGraphPass* pass = &graph->passes[graph->passCount];
+    memset(pass, 0, sizeof(*pass));
+    pass->name = name;
+    pass->record = record;
+    pass->user = user;
+    pass->enabled = 1u;
+    return graph->passCount++;
+}
+
+// A second use of the same resource by one pass widens the first; both must agree on the
+// layout.
+void gbbGraphPassUse(RenderGraph* graph, uint32_t pass, uint32_t resource, RenderGraphState use)
+{
+    if ((pass >= graph->passCount) || (resource >= graph->resourceCount))
+    {
+        fprintf(stderr, "render graph %s: use of an invalid pass or resource\n", graph->name);
+        graph->failed = 1u;
+        return;
+    }
+    RenderGraphPass* p = &graph->passes[pass];
+    for (uint32_t i = 0u; i < p->useCount; ++i)
+    {
+        if (p->resources[i] != resource) continue;
+        p->uses[i].stage |= use.stage;
+        p->uses[i].access |= use.access;
+        return;
+    }
+    if (p->useCount == RENDER_GRAPH_MAX_USES)
+    {
+        fprintf(stderr, "render graph %s: pass %s uses more than %u resources (%s dropped)\n", graph->name, p->name,
+                RENDER_GRAPH_MAX_USES, graph->resources[resource].name);
+        graph->failed = 1u;
+        return;
+    }
+    p->resources[p->useCount] = resource;
+    p->uses[p->useCount] = use;
+    p->useCount += 1u;
+
+    RenderGraphResource* res = &graph->resources[resource];
+    if (res->firstPass == RENDER_GRAPH_INVALID) res->firstPass = pass;
+    res->lastPass = pass;
+}
+
+void gbbEnableGraphPass(RenderGraph* graph, uint32_t pass, uint32_t enabled)
+{
+    if (pass < graph->passCount) graph->passes[pass].enabled = enabled;
+}
+
+static uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags requiredFlags)
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties = {0};
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    for (uint32_t i = 0u; i < memoryProperties.memoryTypeCount; ++i)
+    {
+        if (((typeBits & (1u << i)) != 0u) &&
+            ((memoryProperties.memoryTypes[i].propertyFlags & requiredFlags) == requiredFlags))
+        {
+            return i;
+        }
+    }
+    return RENDER_GRAPH_INVALID;
+}
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1u) / alignment * alignment;
+}
+
+static uint32_t lifetimesOverlap(const RenderGraphResource* a, const RenderGraphResource* b)
+{
+    return (uint32_t)((a->firstPass <= b->lastPass) && (b->firstPass <= a->lastPass));
+}
+
+static uint32_t rangesOverlap(const RenderGraphResource* a, const RenderGraphResource* b)
+{
+    return (uint32_t)((a->offset < b->offset + b->size) && (b->offset < a->offset + a->size));
+}
+
+// Creates the transients and places them largest first, each at the lowest offset that
+// does not collide with an already placed transient whose pass range overlaps its own.
+int gbbCompileRenderGraph(RenderGraph* graph, VkPhysicalDevice physicalDevice, VkDevice device)
+{
+    graph->device = device;
+    if (graph->failed != 0u) return 1;
+    VkPhysicalDeviceProperties properties = {0};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    // Buffers and optimal-tiling images may share the allocation, so every placement
+    // respects the linear/optimal granularity.
+    const VkDeviceSize granularity = properties.limits.bufferImageGranularity;
+
+    uint32_t order[RENDER_GRAPH_MAX_RESOURCES];
+    VkDeviceSize alignments[RENDER_GRAPH_MAX_RESOURCES] = {0};
+    uint32_t transientCount = 0u;
+    uint32_t typeBits = ~0u;
+    for (uint32_t i = 0u; i < graph->resourceCount; ++i)
+    {
+        RenderGraphResource* res = &graph->resources[i];
+        if ((res->transient == 0u) || (res->firstPass == RENDER_GRAPH_INVALID)) continue;
+        VkMemoryRequirements requirements = {0};
+        if (res->isImage != 0u)
+        {
+            if (vkCreateImage(device, &res->imageInfo, NULL, &res->image) != VK_SUCCESS) return 1;
+            vkGetImageMemoryRequirements(device, res->image, &requirements);
+        }
+        else
+        {
+            if (vkCreateBuffer(device, &res->bufferInfo, NULL, &res->buffer) != VK_SUCCESS) return 1;
+            vkGetBufferMemoryRequirements(device, res->buffer, &requirements);
+        }
+        res->size = requirements.size;
+        alignments[i] = (requirements.alignment > granularity) ? requirements.alignment : granularity;
+        typeBits &= requirements.memoryTypeBits;
+        graph->unaliasedSize += alignUp(res->size, alignments[i]);
+        resetTracking(res, (RenderGraphState){0u, 0u, VK_IMAGE_LAYOUT_UNDEFINED});
+
+        uint32_t slot = transientCount++;
+        while ((slot > 0u) && (graph->resources[order[slot - 1u]].size < res->size))
+        {
+            order[slot] = order[slot - 1u];
+            slot -= 1u;
+        }
+        order[slot] = i;
+    }
+    if (transientCount == 0u) return 0;
+
+    for (uint32_t i = 0u; i < transientCount; ++i)
+    {
+        RenderGraphResource* res = &graph->resources[order[i]];
+        res->offset = 0u;
+        uint32_t moved = 1u;
+        while (moved != 0u)
+        {
+            moved = 0u;
+            for (uint32_t j = 0u; j < i; ++j)
+            {
+                const RenderGraphResource* placed = &graph->resources[order[j]];
+                if ((lifetimesOverlap(res, placed) == 0u) || (rangesOverlap(res, placed) == 0u)) continue;
+                res->offset = alignUp(placed->offset + placed->size, alignments[order[i]]);
+                moved = 1u;
+            }
+        }
+        if (res->offset + res->size > graph->transientSize) graph->transientSize = res->offset + res->size;
+    }
+
+    const uint32_t memoryType = findMemoryType(physicalDevice, typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (memoryType == RENDER_GRAPH_INVALID)
+    {
+        fprintf(stderr, "render graph %s: transients share no device-local memory type\n", graph->name);
+        return 1;
+    }
+    if (vkAllocateMemory(device, &(VkMemoryAllocateInfo){
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = graph->transientSize,
+        .memoryTypeIndex = memoryType,
+    }, NULL, &graph->transientMemory) != VK_SUCCESS)
+    {
+        fprintf(stderr, "render graph %s: failed to allocate %llu bytes of transient memory\n", graph->name,
+                (unsigned long long)graph->transientSize);
+        return 1;
+    }
+
+    for (uint32_t i = 0u; i < transientCount; ++i)
+    {
+        RenderGraphResource* res = &graph->resources[order[i]];
+        if (res->isImage == 0u)
+        {
+            vkBindBufferMemory(device, res->buffer, graph->transientMemory, res->offset);
+            continue;
+        }
+        vkBindImageMemory(device, res->image, graph->transientMemory, res->offset);
+        vkCreateImageView(device, &(VkImageViewCreateInfo){
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = res->image,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = res->imageInfo.format,
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .levelCount = 1u,
+                .layerCount = 1u,
+            },
+        }, NULL, &res->view);
+    }
+    return 0;
+}
+
+// Works out what has to happen before use of res and updates its tracking. Layout
+// transitions and writes wait for every earlier access but only flush earlier writes, so
+// write-after-read is an execution dependency. A read only waits when the last write has
+// not yet been made visible to its stage and access. A discarded transient also waits for
+// the transients it aliases.
+static uint32_t syncResource(RenderGraphResource* res, RenderGraphState use, uint32_t discard,
+                             VkPipelineStageFlags aliasStages, VkAccessFlags aliasAccess, RenderGraphBarrier* barrier)
+{
+    const VkAccessFlags writes = use.access & RENDER_GRAPH_WRITE_ACCESS;
+    const VkAccessFlags reads = use.access & ~(VkAccessFlags)RENDER_GRAPH_WRITE_ACCESS;
+    const uint32_t transition = (uint32_t)((res->isImage != 0u) && ((discard != 0u) || (use.layout != res->layout)));
+    barrier->dstStage = use.stage;
+    barrier->oldLayout = (discard != 0u) ? VK_IMAGE_LAYOUT_UNDEFINED : res->layout;
+    barrier->newLayout = (res->isImage != 0u) ? use.layout : res->layout;
+    barrier->srcStage = 0u;
+    barrier->srcAccess = 0u;
+    barrier->dstAccess = 0u;
+
+    if ((transition != 0u) || (writes != 0u) || (discard != 0u))
+    {
+        barrier->srcStage = res->writeStage | res->readStages | aliasStages;
+        barrier->srcAccess = res->writeAccess | aliasAccess;
+        if ((barrier->srcAccess != 0u) || (transition != 0u)) barrier->dstAccess = use.access;
+    }
+    else if ((res->writeStage != 0u) &&
+             (((use.stage & ~res->visibleStages) != 0u) || ((reads & ~res->visibleAccess) != 0u)))
+    {
+        barrier->srcStage = res->writeStage;
+        barrier->srcAccess = res->writeAccess;
+        barrier->dstAccess = reads;
+    }
+    const uint32_t needed = (uint32_t)((barrier->srcStage != 0u) || (transition != 0u));
+
+    if (res->isImage != 0u) res->layout = use.layout;
+    if (writes != 0u)
+    {
+        res->writeStage = use.stage;
+        res->writeAccess = writes;
+        res->readStages = 0u;
+        res->visibleStages = 0u;
+        res->visibleAccess = 0u;
+    }
+    else if (transition != 0u)
+    {
+        // The transition is itself a write, already visible to this use.
+        res->writeStage = use.stage;
+        res->writeAccess = 0u;
+        res->readStages = use.stage;
+        res->visibleStages = use.stage;
+        res->visibleAccess = reads;
+    }
+    else
+    {
+        res->readStages |= use.stage;
+        if (needed != 0u)
+        {
+            res->visibleStages |= use.stage;
+            res->visibleAccess |= reads;
+        }
+    }
+    return needed;
+}
+
+static void emitBarriers(const RenderGraph* graph, VkCommandBuffer cmd, const RenderGraphBarrier* barriers, uint32_t count)
+{
+    VkImageMemoryBarrier imageBarriers[RENDER_GRAPH_MAX_RESOURCES];
+    VkBufferMemoryBarrier bufferBarriers[RENDER_GRAPH_MAX_RESOURCES];
+    uint32_t imageCount = 0u;
+    uint32_t bufferCount = 0u;
+    VkPipelineStageFlags srcStage = 0u;
+    VkPipelineStageFlags dstStage = 0u;
+    for (uint32_t i = 0u; i < count; ++i)
+    {
+        const RenderGraphBarrier* b = &barriers[i];
+        const RenderGraphResource* res = &graph->resources[b->resource];
+        srcStage |= b->srcStage;
+        dstStage |= b->dstStage;
+        // Pure execution dependencies only contribute their stages.
+        if ((b->srcAccess == 0u) && (b->dstAccess == 0u) && (b->oldLayout == b->newLayout)) continue;
+        if (res->isImage != 0u)
+        {
+            imageBarriers[imageCount++] = (VkImageMemoryBarrier){
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask = b->srcAccess,
+                .dstAccessMask = b->dstAccess,
+                .oldLayout = b->oldLayout,
+                .newLayout = b->newLayout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = res->image,
+                .subresourceRange = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .levelCount = VK_REMAINING_MIP_LEVELS,
+                    .layerCount = VK_REMAINING_ARRAY_LAYERS,
+                },
+            };
+        }
+        else
+        {
+            bufferBarriers[bufferCount++] = (VkBufferMemoryBarrier){
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .srcAccessMask = b->srcAccess,
+                .dstAccessMask = b->dstAccess,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer = res->buffer,
+                .size = VK_WHOLE_SIZE,
+            };
+        }
+    }
+    if (count == 0u) return;
+    if (srcStage == 0u) srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0u, 0u, NULL, bufferCount, bufferBarriers, imageCount, imageBarriers);
+}
+
+// Each enabled pass gets at most one vkCmdPipelineBarrier, covering every resource it
+// declared, followed by its record callback.
+void gbbExecuteRenderGraph(RenderGraph* graph, VkCommandBuffer cmd)
+{
+    uint32_t touched[RENDER_GRAPH_MAX_RESOURCES] = {0};
+    for (uint32_t p = 0u; p < graph->passCount; ++p)
+    {
+        RenderGraphPass* pass = &graph->passes[p];
+        pass->executed = pass->enabled;
+        pass->barrierCount = 0u;
+        if (pass->enabled == 0u) continue;
+        for (uint32_t u = 0u; u < pass->useCount; ++u)
+        {
+            const uint32_t index = pass->resources[u];
+            RenderGraphResource* res = &graph->resources[index];
+            const uint32_t discard = (uint32_t)((res->transient != 0u) && (touched[index] == 0u));
+            VkPipelineStageFlags aliasStages = 0u;
+            VkAccessFlags aliasAccess = 0u;
+            for (uint32_t i = 0u; (discard != 0u) && (i < graph->resourceCount); ++i)
+            {
+                const RenderGraphResource* other = &graph->resources[i];
+                if ((i == index) || (other->transient == 0u) || (rangesOverlap(res, other) == 0u)) continue;
+                aliasStages |= other->writeStage | other->readStages;
+                aliasAccess |= other->writeAccess;
+            }
+            touched[index] = 1u;
+            RenderGraphBarrier* barrier = &pass->barriers[pass->barrierCount];
+            barrier->resource = index;
+            if (syncResource(res, pass->uses[u], discard, aliasStages, aliasAccess, barrier) != 0u) pass->barrierCount += 1u;
+        }
+        emitBarriers(graph, cmd, pass->barriers, pass->barrierCount);
+        pass->record(cmd, pass->user);
+    }
+
+    graph->finalBarrierCount = 0u;
+    for (uint32_t i = 0u; i < graph->resourceCount; ++i)
+    {
+        RenderGraphResource* res = &graph->resources[i];
+        if (res->hasFinalState == 0u) continue;
+        RenderGraphBarrier* barrier = &graph->finalBarriers[graph->finalBarrierCount];
+        barrier->resource = i;
+        if (syncResource(res, res->finalState, 0u, 0u, 0u, barrier) != 0u) graph->finalBarrierCount += 1u;
+    }
+    emitBarriers(graph, cmd, graph->finalBarriers, graph->finalBarrierCount);
+}
+
+VkImage gbbGetGraphImage(const RenderGraph* graph, uint32_t resource)
+{
+    return graph->resources[resource].image;
+}
+
+VkImageView gbbGetGraphImageView(const RenderGraph* graph, uint32_t resource)
+{
+    return graph->resources[resource].view;
+}
+
+VkBuffer gbbGetGraphBuffer(const RenderGraph* graph, uint32_t resource)
+{
+    return graph->resources[resource].buffer;
+}
+
+static void dumpBarriers(const RenderGraph* graph, FILE* out, const RenderGraphBarrier* barriers, uint32_t count)
+{
+    if (count == 0u) fputs("    no barrier\n", out);
+    for (uint32_t i = 0u; i < count; ++i)
+    {
+        const RenderGraphBarrier* b = &barriers[i];
+        const RenderGraphResource* res = &graph->resources[b->resource];
+        fprintf(out, "    %s: ", res->name);
+        printFlags(out, b->srcStage, stageNames, sizeof(stageNames) / sizeof(stageNames[0]));
+        fputs(" -> ", out);
+        printFlags(out, b->dstStage, stageNames, sizeof(stageNames) / sizeof(stageNames[0]));
+        fputs(", access ", out);
+        printFlags(out, b->srcAccess, accessNames, sizeof(accessNames) / sizeof(accessNames[0]));
+        fputs(" -> ", out);
+        printFlags(out, b->dstAccess, accessNames, sizeof(accessNames) / sizeof(accessNames[0]));
+        if ((res->isImage != 0u) && (b->oldLayout != b->newLayout))
+        {
+            fprintf(out, ", layout %s -> %s", layoutName(b->oldLayout), layoutName(b->newLayout));
+        }
+        fputc('\n', out);
+    }
+}
+
+void gbbDumpRenderGraph(const RenderGraph* graph, FILE* out)
+{
+    fprintf(out, "render graph %s: %u passes, %u resources\n", graph->name, graph->passCount, graph->resourceCount);
+    for (uint32_t p = 0u; p < graph->passCount; ++p)
+    {
+        const RenderGraphPass* pass = &graph->passes[p];
+        fprintf(out, "  pass %u %s%s\n", p, pass->name, (pass->executed != 0u) ? "" : " (skipped)");
+        if (pass->executed != 0u) dumpBarriers(graph, out, pass->barriers, pass->barrierCount);
+    }
+    fputs("  final\n", out);
+    dumpBarriers(graph, out, graph->finalBarriers, graph->finalBarrierCount);
+
+    fputs("  memory\n", out);
+    for (uint32_t i = 0u; i < graph->resourceCount; ++i)
+    {
+        const RenderGraphResource* res = &graph->resources[i];
+        fprintf(out, "    %-12s %s", res->name, (res->isImage != 0u) ? "image " : "buffer");
+        if (res->firstPass == RENDER_GRAPH_INVALID)
+        {
+            fputs(" unused\n", out);
+        }
+        else if (res->transient == 0u)
+        {
+            fprintf(out, " imported, passes %u-%u\n", res->firstPass, res->lastPass);
+        }
+        else
+        {
+            fprintf(out, " transient, passes %u-%u, offset %llu, %llu bytes\n", res->firstPass, res->lastPass,
+                    (unsigned long long)res->offset, (unsigned long long)res->size);
+        }
+    }
+    fprintf(out, "  transient memory %llu bytes (%llu without aliasing)\n", (unsigned long long)graph->transientSize,
+            (unsigned long long)graph->unaliasedSize);
+}
+
+void gbbDestroyRenderGraph(RenderGraph* graph)
+{
+    for (uint32_t i = 0u; i < graph->resourceCount; ++i)
+    {
+        RenderGraphResource* res = &graph->resources[i];
+        if (res->transient == 0u) continue;
+        if (res->view != VK_NULL_HANDLE) vkDestroyImageView(graph->device, res->view, NULL);
+        if (res->image != VK_NULL_HANDLE) vkDestroyImage(graph->device, res->image, NULL);
+        if (res->buffer != VK_NULL_HANDLE) vkDestroyBuffer(graph->device, res->buffer, NULL);
+        res->view = VK_NULL_HANDLE;
+        res->image = VK_NULL_HANDLE;
+        res->buffer = VK_NULL_HANDLE;
+    }
+    if (graph->transientMemory != VK_NULL_HANDLE) vkFreeMemory(graph->device, graph->transientMemory, NULL);
+    graph->transientMemory = VK_NULL_HANDLE;
+}
+
+static void recordNothing(VkCommandBuffer cmd, void* user)
+{
+    (void)cmd;
+    (void)user;
+}
+
+static const RenderGraphBarrier* findBarrier(const RenderGraphPass* pass, uint32_t resource)
+{
+    for (uint32_t i = 0u; i < pass->barrierCount; ++i)
+    {
+        if (pass->barriers[i].resource == resource) return &pass->barriers[i];
+    }
+    return NULL;
+}
+
+int gbbRecordRenderGraphCheck(RenderGraph* graph, VkPhysicalDevice physicalDevice, VkDevice device, VkCommandBuffer cmd)
+{
+    const RenderGraphState write = {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED};
+    const RenderGraphState read = {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED};
+    const VkBufferCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = 1u << 20u,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+    };
+
+    // a lives in passes 0-1, b in 1-2 and c in 2-3: a and c may alias, b overlaps both.
+    gbbInitRenderGraph(graph, "check");
+    const uint32_t a = gbbAddTransientBuffer(graph, "a", &info);
+    const uint32_t b = gbbAddTransientBuffer(graph, "b", &info);
+    const uint32_t c = gbbAddTransientBuffer(graph, "c", &info);
+    uint32_t passes[4];
+    for (uint32_t i = 0u; i < 4u; ++i)
+    {
+        passes[i] = gbbAddGraphPass(graph, "pass", recordNothing, NULL);
+    }
+    gbbGraphPassUse(graph, passes[0], a, write);
+    gbbGraphPassUse(graph, passes[1], a, read);
+    gbbGraphPassUse(graph, passes[1], b, write);
+    gbbGraphPassUse(graph, passes[2], b, read);
+    gbbGraphPassUse(graph, passes[2], c, write);
+    gbbGraphPassUse(graph, passes[3], c, read);
+    if (gbbCompileRenderGraph(graph, physicalDevice, device) != 0) return 1;
+    gbbExecuteRenderGraph(graph, cmd);
+    return 0;
+}
+
+int gbbFinishRenderGraphCheck(RenderGraph* graph)
+{
+    // Resources were added in order, so a, b and c are handles 0, 1 and 2.
+    const uint32_t a = 0u;
+    const uint32_t b = 1u;
+    const uint32_t c = 2u;
+    const RenderGraphResource* res = graph->resources;
+    const RenderGraphBarrier* discardC = findBarrier(&graph->passes[2], c);
+    const RenderGraphBarrier* readA = findBarrier(&graph->passes[1], a);
+    const char* failure = NULL;
+    if ((graph->resourceCount != 3u) || (graph->passCount != 4u)) failure = "the graph was not recorded";
+    else if (rangesOverlap(&res[a], &res[c]) == 0u) failure = "a and c were not aliased";
+    else if ((rangesOverlap(&res[a], &res[b]) != 0u) || (rangesOverlap(&res[b], &res[c]) != 0u)) failure = "b overlaps a live transient";
+    else if (graph->transientSize >= graph->unaliasedSize) failure = "aliasing saved no memory";
+    else if ((discardC == NULL) || ((discardC->srcStage & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) == 0u)) failure = "c does not wait for a";
+    else if ((readA == NULL) || ((readA->srcAccess & VK_ACCESS_SHADER_WRITE_BIT) == 0u)) failure = "a's read does not wait for its write";
+    else if (findBarrier(&graph->passes[0], a) != NULL) failure = "a's first write waits on nothing it aliases";
+
+    if (failure != NULL)
+    {
+        fprintf(stderr, "render graph check: %s\n", failure);
+        gbbDumpRenderGraph(graph, stderr);
+    }
+    else
+    {
+        printf("render graph check: %llu of %llu transient bytes after aliasing\n", (unsigned long long)graph->transientSize,
+               (unsigned long long)graph->unaliasedSize);
+    }
+    gbbDestroyRenderGraph(graph);
+    return (failure != NULL) ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vulkan/vulkan.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RENDER_GRAPH_MAX_RESOURCES 16u
+#define RENDER_GRAPH_MAX_PASSES 16u
+#define RENDER_GRAPH_MAX_USES 8u
+#define RENDER_GRAPH_INVALID 0xffffffffu
+
+// How a pass touches a resource, or the state a resource is handed over in. layout is
+// ignored for buffers.
+typedef struct RenderGraphState {
+    VkPipelineStageFlags stage;
+    VkAccessFlags access;
+    VkImageLayout layout;
+} RenderGraphState;
+
+typedef void (*RenderGraphRecordFn)(VkCommandBuffer cmd, void* user);
+
+// What the last execution recorded in front of a pass, for gbbDumpRenderGraph.
+typedef struct RenderGraphBarrier {
+    uint32_t resource;
+    VkPipelineStageFlags srcStage;
+    VkPipelineStageFlags dstStage;
+    VkAccessFlags srcAccess;
+    VkAccessFlags dstAccess;
+    VkImageLayout oldLayout;
+    VkImageLayout newLayout;
+} RenderGraphBarrier;
+
+typedef struct RenderGraphResource {
+    const char* name;
+    uint32_t isImage;
+    uint32_t transient;
+    VkImage image;
+    VkImageView view;
+    VkBuffer buffer;
+    VkImageCreateInfo imageInfo;
+    VkBufferCreateInfo bufferInfo;
+    RenderGraphState finalState;
+    uint32_t hasFinalState;
+    // Synchronization state carried from use to use and across executions: the last
+    // write, the stages that read since it, and what those reads already made visible.
+    VkImageLayout layout;
+    VkPipelineStageFlags writeStage;
+    VkAccessFlags writeAccess;
+    VkPipelineStageFlags readStages;
+    VkPipelineStageFlags visibleStages;
+    VkAccessFlags visibleAccess;
+    // Memory plan; transients only share memory when their pass ranges are disjoint.
+    uint32_t firstPass;
+    uint32_t lastPass;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+} RenderGraphResource;
+
+typedef struct RenderGraphPass {
+    const char* name;
+    RenderGraphRecordFn record;
+    void* user;
+    uint32_t enabled;
+    uint32_t useCount;
+    uint32_t resources[RENDER_GRAPH_MAX_USES];
+    RenderGraphState uses[RENDER_GRAPH_MAX_USES];
+    uint32_t barrierCount;
+    RenderGraphBarrier barriers[RENDER_GRAPH_MAX_USES];
+    uint32_t executed;
+} RenderGraphPass;
+
+// Passes run in the order they were added. Resources are either imported (owned by the
+// caller, state tracked across executions) or transient (created by gbbCompileRenderGraph
+// and aliased into one allocation, contents undefined at their first use in each
+// execution). Executions must be separated by a wait on the previous one's fence.
+// Declaring past a RENDER_GRAPH_MAX_* limit, or with a RENDER_GRAPH_INVALID handle,
+// reports the error, sets failed and makes gbbCompileRenderGraph fail.
+typedef struct RenderGraph {
+    const char* name;
+    VkDevice device;
+    uint32_t failed;
+    VkDeviceMemory transientMemory;
+    VkDeviceSize transientSize;
+    VkDeviceSize unaliasedSize;
+    uint32_t resourceCount;
+    RenderGraphResource resources[RENDER_GRAPH_MAX_RESOURCES];
+    uint32_t passCount;
+    RenderGraphPass passes[RENDER_GRAPH_MAX_PASSES];
+    uint32_t finalBarrierCount;
+    RenderGraphBarrier finalBarriers[RENDER_GRAPH_MAX_RESOURCES];
+} RenderGraph;
+
+void gbbInitRenderGraph(RenderGraph* graph, const char* name);
+uint32_t gbbAddGraphImage(RenderGraph* graph, const char* name, VkImage image, RenderGraphState initial);
+uint32_t gbbAddGraphBuffer(RenderGraph* graph, const char* name, VkBuffer buffer, RenderGraphState initial);
+uint32_t gbbAddTransientImage(RenderGraph* graph, const char* name, const VkImageCreateInfo* info);
+uint32_t gbbAddTransientBuffer(RenderGraph* graph, const char* name, const VkBufferCreateInfo* info);
+// Rebinds an imported image (a newly acquired swapchain image, say) and restarts its
+// tracking from state.
+void gbbSetGraphImage(RenderGraph* graph, uint32_t resource, VkImage image, RenderGraphState state);
+// State an imported resource is left in after the last pass, e.g. PRESENT_SRC.
+void gbbSetGraphFinalState(RenderGraph* graph, uint32_t resource, RenderGraphState state);
+uint32_t gbbAddGraphPass(RenderGraph* graph, const char* name, RenderGraphRecordFn record, void* user);
+void gbbGraphPassUse(RenderGraph* graph, uint32_t pass, uint32_t resource, RenderGraphState use);
+// Disabled passes are skipped by the next execution and their uses ignored.
+void gbbEnableGraphPass(RenderGraph* graph, uint32_t pass, uint32_t enabled);
+int gbbCompileRenderGraph(RenderGraph* graph, VkPhysicalDevice physicalDevice, VkDevice device);
+void gbbExecuteRenderGraph(RenderGraph* graph, VkCommandBuffer cmd);
+VkImage gbbGetGraphImage(const RenderGraph* graph, uint32_t resource);
+VkImageView gbbGetGraphImageView(const RenderGraph* graph, uint32_t resource);
+VkBuffer gbbGetGraphBuffer(const RenderGraph* graph, uint32_t resource);
+// Prints the barriers of the last execution and the transient memory plan.
+void gbbDumpRenderGraph(const RenderGraph* graph, FILE* out);
+void gbbDestroyRenderGraph(RenderGraph* graph);
+// Self-check of the aliasing plan. gbbRecordRenderGraphCheck builds a graph of three
+// transient buffers whose pass ranges chain, compiles it and records it into cmd
+// (recording); it returns 1 if compilation failed. Once cmd has finished executing,
+// gbbFinishRenderGraphCheck checks the plan and the barriers derived for it and destroys
+// the graph, returning 0 when they match and 1 after printing what did not. After a
+// failed record, release the graph with gbbDestroyRenderGraph instead.
+int gbbRecordRenderGraphCheck(RenderGraph* graph, VkPhysicalDevice physicalDevice, VkDevice device, VkCommandBuffer cmd);
+int gbbFinishRenderGraphCheck(RenderGraph* graph);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,709 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scene.h"
+
+static const float SCENE_MIN[3] = {-18.0f, 0.0f, -18.0f};
+static const float SCENE_EXTENT[3] = {36.0f, 8.0f, 36.0f};
+static const float SPHERE_RADIUS_MIN = 0.22f;
+static const float SPHERE_RADIUS_MAX = 0.85f;
+
+static const uint32_t COMPACTION_MIN_GARBAGE = 1024u;
+
+static float clampf01(float v)
+{
+    if (v < 0.0f) return 0.0f;
+    if (v > 1.0f) return 1.0f;
+    return v;
+}
+
+static uint32_t nextRandom(uint32_t *state)
+{
+    *state = (*state * 1664525u) + 1013904223u;
+    return *state;
+}
+
+static float random01(uint32_t *state)
+{
+    return (float)((nextRandom(state) >> 8u) & 0x00ffffffu) * (1.0f / 16777215.0f);
+}
+
+static uint32_t quantizeUnorm16(float v)
+{
+    return (uint32_t)floorf(clampf01(v) * 65535.0f + 0.5f);
+}
+
+static float dequantizeUnorm16(uint32_t q)
+{
+    return (float)q * (1.0f / 65535.0f);
+}
+
+static uint32_t quantizeRadius12(const SceneBounds* bounds, float radius)
+{
+    float range = fmaxf(bounds->radiusMax - bounds->radiusMin, 1e-6f);
+    float radiusNorm = clampf01((radius - bounds->radiusMin) / range);
+    float encoded = sqrtf(radiusNorm);
+    return (uint32_t)floorf(encoded * 4095.0f + 0.5f);
+}
+
+static float dequantizeRadius12(const SceneBounds* bounds, uint32_t q)
+{
+    float range = bounds->radiusMax - bounds->radiusMin;
+    float encoded = (float)q * (1.0f / 4095.0f);
+    return bounds->radiusMin + (encoded * encoded) * range;
+}
+
+static uint32_t clampGridCoord(int32_t value, uint32_t maxValue)
+{
+    if (value < 0) return 0u;
+    if ((uint32_t)value >= maxValue) return maxValue - 1u;
+    return (uint32_t)value;
+}
+
+void gbbDefaultSceneBounds(SceneBounds* bounds)
+{
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        bounds->min[axis] = SCENE_MIN[axis];
+        bounds->extent[axis] = SCENE_EXTENT[axis];
+    }
+    bounds->radiusMin = SPHERE_RADIUS_MIN;
+    bounds->radiusMax = SPHERE_RADIUS_MAX;
+}
+
+void gbbPackSphere(const SceneBounds* bounds, const float center[3], float radius, uint32_t materialId, uint32_t words[2])
+{
+    uint32_t qx = quantizeUnorm16((center[0] - bounds->min[0]) / bounds->extent[0]);
+    uint32_t qy = quantizeUnorm16((center[1] - bounds->min[1]) / bounds->extent[1]);
+    uint32_t qz = quantizeUnorm16((center[2] - bounds->min[2]) / bounds->extent[2]);
+    uint32_t qRadius = quantizeRadius12(bounds, radius);
+    words[0] = (qx & 0xffffu) | ((qy & 0xffffu) << 16u);
+    words[1] = (qz & 0xffffu) | ((qRadius & 0x0fffu) << 16u) | ((materialId & 0x0fu) << 28u);
+}
+
+void gbbDecodeSphere(const SceneBounds* bounds, const uint32_t words[2], float center[3], float* radius)
+{
+    uint32_t qx = words[0] & 0xffffu;
+    uint32_t qy = (words[0] >> 16u) & 0xffffu;
+    uint32_t qz = words[1] & 0xffffu;
+    uint32_t qRadius = (words[1] >> 16u) & 0x0fffu;
+    center[0] = bounds->min[0] + dequantizeUnorm16(qx) * bounds->extent[0];
+    center[1] = bounds->min[1] + dequantizeUnorm16(qy) * bounds->extent[1];
+    center[2] = bounds->min[2] + dequantizeUnorm16(qz) * bounds->extent[2];
+    *radius = dequantizeRadius12(bounds, qRadius);
+}
+
+static int reserveDirtyPages(DirtyPages* dirty, uint32_t wordCount)
+{
+    uint32_t pageCount = (wordCount + DIRTY_PAGE_WORDS - 1u) / DIRTY_PAGE_WORDS;
+    uint32_t oldBitWords = (dirty->pageCount + 63u) / 64u;
+    uint32_t newBitWords = (pageCount + 63u) / 64u;
+    if (newBitWords > oldBitWords)
+    {
+        uint64_t *bits = (uint64_t *)realloc(dirty->bits, (size_t)newBitWords * sizeof(uint64_t));
+        if (!bits) return 1;
+        memset(bits + oldBitWords, 0, (size_t)(newBitWords - oldBitWords) * sizeof(uint64_t));
+        dirty->bits = bits;
+    }
+    if (pageCount > dirty->pageCount) dirty->pageCount = pageCount;
+    return 0;
+}
+
+void gbbMarkDirty(DirtyPages* dirty, uint32_t firstWord, uint32_t wordCount)
+{
+    if ((wordCount == 0u) || (dirty->pageCount == 0u)) return;
+    uint32_t firstPage = firstWord / DIRTY_PAGE_WORDS;
+    uint32_t lastPage = (firstWord + wordCount - 1u) / DIRTY_PAGE_WORDS;
+    if (lastPage >= dirty->pageCount) lastPage = dirty->pageCount - 1u;
+    for (uint32_t page = firstPage; page <= lastPage; ++page)
+    {
+        dirty->bits[page >> 6u] |= 1ull << (page & 63u);
+    }
+}
+
+void gbbMarkAllDirty(DirtyPages* dirty)
+{
+    if (dirty->pageCount == 0u) return;
+    gbbMarkDirty(dirty, 0u, dirty->pageCount * DIRTY_PAGE_WORDS);
+}
+
+int gbbNextDirtyRange(const DirtyPages* dirty, uint32_t* cursor, uint32_t* firstWord, uint32_t* wordCount)
+{
+    uint32_t page = *cursor;
+    while ((page < dirty->pageCount) && ((dirty->bits[page >> 6u] & (1ull << (page & 63u))) == 0u))
+    {
+        page = ((dirty->bits[page >> 6u] >> (page & 63u)) == 0u) ? ((page | 63u) + 1u) : (page + 1u);
+    }
+    if (page >= dirty->pageCount) return 0;
+
+    uint32_t endPage = page + 1u;
+    while ((endPage < dirty->pageCount) && ((dirty->bits[endPage >> 6u] & (1ull << (endPage & 63u))) != 0u))
+    {
+        endPage += 1u;
+    }
+    *firstWord = page * DIRTY_PAGE_WORDS;
+    *wordCount = (endPage - page) * DIRTY_PAGE_WORDS;
+    *cursor = endPage;
+    return 1;
+}
+
+void gbbClearDirty(DirtyPages* dirty)
+{
+    if (dirty->bits) memset(dirty->bits, 0, (size_t)((dirty->pageCount + 63u) / 64u) * sizeof(uint64_t));
+}
+
+int gbbReserveSpheres(PackedSpheres* spheres, uint32_t capacity)
+{
+    if (capacity <= spheres->capacity) return 0;
+    uint32_t *words = (uint32_t *)realloc(spheres->words, (size_t)capacity * 2u * sizeof(uint32_t));
+    if (!words) return 1;
+    spheres->words = words;
+    spheres->capacity = capacity;
+    return reserveDirtyPages(&spheres->dirty, capacity * 2u);
+}
+
+void gbbBuildPackedSpheres(PackedSpheres* spheres, uint32_t maxCount)
+{
+    gbbDefaultSceneBounds(&spheres->bounds);
+    spheres->count = 0u;
+    if (gbbReserveSpheres(spheres, (maxCount > 0u) ? maxCount : 1u) != 0) return;
+
+    const SceneBounds* bounds = &spheres->bounds;
+    float *placed = (float *)malloc((size_t)maxCount * 4u * sizeof(float));
+    uint32_t rng = 0x1f2e3d4cu;
+    for (uint32_t i = 0u; (placed != NULL) && (i < maxCount); ++i)
+    {
+        uint32_t placedThisSphere = 0u;
+        for (uint32_t attempt = 0u; attempt < 64u; ++attempt)
+        {
+            float radiusMix = random01(&rng);
+            float radius = bounds->radiusMin + (bounds->radiusMax - bounds->radiusMin) * (0.25f + 0.75f * radiusMix);
+
+            float minX = bounds->min[0] + radius;
+            float maxX = bounds->min[0] + bounds->extent[0] - radius;
+            float minZ = bounds->min[2] + radius;
+            float maxZ = bounds->min[2] + bounds->extent[2] - radius;
+            if ((maxX <= minX) || (maxZ <= minZ)) continue;
+
+            float center[3];
+            center[0] = minX + (maxX - minX) * random01(&rng);
+            center[1] = bounds->min[1] + radius;
+            center[2] = minZ + (maxZ - minZ) * random01(&rng);
+            uint32_t materialId = nextRandom(&rng) % 3u;
+
+            uint32_t words[2];
+            gbbPackSphere(bounds, center, radius, materialId, words);
+            float decoded[3];
+            float decodedRadius = 0.0f;
+            gbbDecodeSphere(bounds, words, decoded, &decodedRadius);
+
+            uint32_t overlap = 0u;
+            for (uint32_t s = 0u; s < spheres->count; ++s)
+            {
+                float dx = decoded[0] - placed[s * 4u + 0u];
+                float dy = decoded[1] - placed[s * 4u + 1u];
+                float dz = decoded[2] - placed[s * 4u + 2u];
+                float minDist = decodedRadius + placed[s * 4u + 3u] + 0.03f;
+                if ((dx * dx + dy * dy + dz * dz) < (minDist * minDist))
+                {
+                    overlap = 1u;
+                    break;
+                }
+            }
+            if (overlap != 0u) continue;
+
+            spheres->words[spheres->count * 2u + 0u] = words[0];
+            spheres->words[spheres->count * 2u + 1u] = words[1];
+            placed[spheres->count * 4u + 0u] = decoded[0];
+            placed[spheres->count * 4u + 1u] = decoded[1];
+            placed[spheres->count * 4u + 2u] = decoded[2];
+            placed[spheres->count * 4u + 3u] = decodedRadius;
+            spheres->count += 1u;
+            placedThisSphere = 1u;
+            break;
+        }
+        if ((placedThisSphere == 0u) && (spheres->count >= 32u)) break;
+    }
+    free(placed);
+
+    if (spheres->count == 0u)
+    {
+        const float center[3] = {0.0f, 0.8f, -6.0f};
+        gbbPackSphere(bounds, center, 0.8f, 0u, spheres->words);
+        spheres->count = 1u;
+    }
+    gbbMarkAllDirty(&spheres->dirty);
+}
+
+void gbbFreePackedSpheres(PackedSpheres* spheres)
+{
+    free(spheres->words);
+    free(spheres->dirty.bits);
+    memset(spheres, 0, sizeof(*spheres));
+}
+
+static void sphereCellRange(const SphereGrid* grid, const SceneBounds* bounds, const uint32_t words[2],
+                            uint32_t lo[3], uint32_t hi[3])
+{
+    float center[3];
+    float radius = 0.0f;
+    gbbDecodeSphere(bounds, words, center, &radius);
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        const float cellSize = bounds->extent[axis] / (float)grid->dims[axis];
+        int32_t minCell = (int32_t)floorf((center[axis] - radius - bounds->min[axis]) / cellSize);
+        int32_t maxCell = (int32_t)floorf((center[axis] + radius - bounds->min[axis]) / cellSize);
+        lo[axis] = clampGridCoord(minCell, grid->dims[axis]);
+        hi[axis] = clampGridCoord(maxCell, grid->dims[axis]);
+    }
+}
+
+static void boxCellRange(const SphereGrid* grid, const SceneBounds* bounds, const float box[6],
+                         uint32_t lo[3], uint32_t hi[3])
+{
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        const float cellSize = bounds->extent[axis] / (float)grid->dims[axis];
+        lo[axis] = clampGridCoord((int32_t)floorf((box[axis] - bounds->min[axis]) / cellSize), grid->dims[axis]);
+        hi[axis] = clampGridCoord((int32_t)floorf((box[axis + 3u] - bounds->min[axis]) / cellSize), grid->dims[axis]);
+    }
+}
+
+typedef struct GridItems {
+    const SceneBounds* bounds;
+    const uint32_t *sphereWords;
+    const float *boxes;
+    uint32_t count;
+} GridItems;
+
+static void gridItemRange(const SphereGrid* grid, const GridItems* items, uint32_t item, uint32_t lo[3], uint32_t hi[3])
+{
+    if (items->boxes)
+    {
+        boxCellRange(grid, items->bounds, &items->boxes[item * 6u], lo, hi);
+        return;
+    }
+    sphereCellRange(grid, items->bounds, &items->sphereWords[item * 2u], lo, hi);
+}
+
+static uint32_t rangeContains(const uint32_t lo[3], const uint32_t hi[3], uint32_t x, uint32_t y, uint32_t z)
+{
+    return (uint32_t)((x >= lo[0]) && (x <= hi[0]) && (y >= lo[1]) && (y <= hi[1]) && (z >= lo[2]) && (z <= hi[2]));
+}
+
+static int reserveGridIndices(SphereGrid* grid, uint32_t capacity)
+{
+    if (capacity <= grid->indexCapacity) return 0;
+    uint32_t *indexWords = (uint32_t *)realloc(grid->indexWords, (size_t)capacity * sizeof(uint32_t));
+    if (!indexWords) return 1;
+    grid->indexWords = indexWords;
+    grid->indexCapacity = capacity;
+    return reserveDirtyPages(&grid->indexDirty, capacity);
+}
+
+// Headroom beyond the laid-out cells absorbs relocations between compactions.
+static uint32_t gridIndexHeadroom(const SphereGrid* grid, uint32_t layoutCount)
+{
+    return (grid->slackPerCell > 0u) ? (layoutCount / 4u + 64u) : 0u;
+}
+
+static int buildGrid(SphereGrid* grid, const GridItems* items,
+                     uint32_t dimX, uint32_t dimY, uint32_t dimZ, uint32_t slackPerCell)
+{
+    const uint32_t cellCount = dimX * dimY * dimZ;
+    if (cellCount > grid->cellCount)
+    {
+        uint32_t *cellWords = (uint32_t *)realloc(grid->cellWords, (size_t)cellCount * 2u * sizeof(uint32_t));
+        if (!cellWords) return 1;
+        grid->cellWords = cellWords;
+        uint32_t *cellCapacity = (uint32_t *)realloc(grid->cellCapacity, (size_t)cellCount * sizeof(uint32_t));
+        if (!cellCapacity) return 1;
+        grid->cellCapacity = cellCapacity;
+        if (reserveDirtyPages(&grid->cellDirty, cellCount * 2u) != 0) return 1;
+    }
+    grid->dims[0] = dimX;
+    grid->dims[1] = dimY;
+    grid->dims[2] = dimZ;
+    grid->cellCount = cellCount;
+    grid->slackPerCell = slackPerCell;
+    grid->garbageCount = 0u;
+
+    uint32_t *cellHistogram = grid->cellCapacity;
+    memset(cellHistogram, 0, (size_t)cellCount * sizeof(uint32_t));
+    for (uint32_t item = 0u; item < items->count; ++item)
+    {
+        uint32_t lo[3];
+        uint32_t hi[3];
+        gridItemRange(grid, items, item, lo, hi);
+        for (uint32_t z = lo[2]; z <= hi[2]; ++z)
+        {
+            for (uint32_t y = lo[1]; y <= hi[1]; ++y)
+            {
+                for (uint32_t x = lo[0]; x <= hi[0]; ++x)
+                {
+                    cellHistogram[x + y * dimX + z * dimX * dimY] += 1u;
+                }
+            }
+        }
+    }
+
+    uint32_t runningOffset = 0u;
+    uint32_t refCount = 0u;
+    for (uint32_t cell = 0u; cell < cellCount; ++cell)
+    {
+        uint32_t count = cellHistogram[cell];
+        grid->cellWords[cell * 2u + 0u] = runningOffset;
+        grid->cellWords[cell * 2u + 1u] = 0u;
+        grid->cellCapacity[cell] = count + slackPerCell;
+        runningOffset += count + slackPerCell;
+        refCount += count;
+    }
+    if (reserveGridIndices(grid, runningOffset + gridIndexHeadroom(grid, runningOffset) + 1u) != 0) return 1;
+    memset(grid->indexWords, 0, (size_t)grid->indexCapacity * sizeof(uint32_t));
+    grid->indexCount = runningOffset;
+    grid->refCount = refCount;
+
+    for (uint32_t item = 0u; item < items->count; ++item)
+    {
+        uint32_t lo[3];
+        uint32_t hi[3];
+        gridItemRange(grid, items, item, lo, hi);
+        for (uint32_t z = lo[2]; z <= hi[2]; ++z)
+        {
+            for (uint32_t y = lo[1]; y <= hi[1]; ++y)
+            {
+                for (uint32_t x = lo[0]; x <= hi[0]; ++x)
+                {
+                    uint32_t cellIndex = x + y * dimX + z * dimX * dimY;
+                    uint32_t cellOffset = grid->cellWords[cellIndex * 2u + 0u];
+                    uint32_t cursor = grid->cellWords[cellIndex * 2u + 1u];
+                    grid->indexWords[cellOffset + cursor] = item;
+                    grid->cellWords[cellIndex * 2u + 1u] = cursor + 1u;
+                }
+            }
+        }
+    }
+
+    gbbMarkAllDirty(&grid->cellDirty);
+    gbbMarkAllDirty(&grid->indexDirty);
+    return 0;
+}
+
+int gbbBuildSphereGrid(SphereGrid* grid, const PackedSpheres* spheres,
+                       uint32_t dimX, uint32_t dimY, uint32_t dimZ, uint32_t slackPerCell)
+{
+    const GridItems items = {&spheres->bounds, spheres->words, NULL, spheres->count};
+    return buildGrid(grid, &items, dimX, dimY, dimZ, slackPerCell);
+}
+
+int gbbBuildBoxGrid(SphereGrid* grid, const SceneBounds* bounds, const float* boxes, uint32_t boxCount,
+                    uint32_t dimX, uint32_t dimY, uint32_t dimZ)
+{
+    const GridItems items = {bounds, NULL, boxes, boxCount};
+    return buildGrid(grid, &items, dimX, dimY, dimZ, 0u);
+}
+
+int gbbCompactSphereGrid(SphereGrid* grid)
+{
+    uint32_t layoutCount = 0u;
+    for (uint32_t cell = 0u; cell < grid->cellCount; ++cell)
+    {
+        layoutCount += grid->cellWords[cell * 2u + 1u] + grid->slackPerCell;
+    }
+    uint32_t capacity = layoutCount + gridIndexHeadroom(grid, layoutCount) + 1u;
+    if (capacity < grid->indexCapacity) capacity = grid->indexCapacity;
+
+    uint32_t *compacted = (uint32_t *)calloc((size_t)capacity, sizeof(uint32_t));
+    if (!compacted) return 1;
+    uint32_t runningOffset = 0u;
+    for (uint32_t cell = 0u; cell < grid->cellCount; ++cell)
+    {
+        uint32_t offset = grid->cellWords[cell * 2u + 0u];
+        uint32_t count = grid->cellWords[cell * 2u + 1u];
+        memcpy(compacted + runningOffset, grid->indexWords + offset, (size_t)count * sizeof(uint32_t));
+        grid->cellWords[cell * 2u + 0u] = runningOffset;
+        grid->cellCapacity[cell] = count + grid->slackPerCell;
+        runningOffset += count + grid->slackPerCell;
+    }
+    free(grid->indexWords);
+    grid->indexWords = compacted;
+    grid->indexCapacity = capacity;
+    grid->indexCount = runningOffset;
+    grid->garbageCount = 0u;
+    grid->compactionCount += 1u;
+    if (reserveDirtyPages(&grid->indexDirty, capacity) != 0) return 1;
+    gbbMarkAllDirty(&grid->cellDirty);
+    gbbMarkAllDirty(&grid->indexDirty);
+    return 0;
+}
+
+static void removeCellRef(SphereGrid* grid, uint32_t cell, uint32_t sphereIndex)
+{
+    uint32_t offset = grid->cellWords[cell * 2u + 0u];
+    uint32_t count = grid->cellWords[cell * 2u + 1u];
+    for (uint32_t i = 0u; i < count; ++i)
+    {
+        if (grid->indexWords[offset + i] != sphereIndex) continue;
+        grid->indexWords[offset + i] = grid->indexWords[offset + count - 1u];
+        grid->cellWords[cell * 2u + 1u] = count - 1u;
+        grid->refCount -= 1u;
+        gbbMarkDirty(&grid->indexDirty, offset + i, 1u);
+        gbbMarkDirty(&grid->cellDirty, cell * 2u, 2u);
+        return;
+    }
+}
+
+static void replaceCellRef(SphereGrid* grid, uint32_t cell, uint32_t fromIndex, uint32_t toIndex)
+{
+    uint32_t offset = grid->cellWords[cell * 2u + 0u];
+    uint32_t count = grid->cellWords[cell * 2u + 1u];
+    for (uint32_t i = 0u; i < count; ++i)
+    {
+        if (grid->indexWords[offset + i] != fromIndex) continue;
+        grid->indexWords[offset + i] = toIndex;
+        gbbMarkDirty(&grid->indexDirty, offset + i, 1u);
+        return;
+    }
+}
+
+static uint32_t addCellRef(SphereGrid* grid, uint32_t cell, uint32_t sphereIndex)
+{
+    uint32_t flags = 0u;
+    uint32_t offset = grid->cellWords[cell * 2u + 0u];
+    uint32_t count = grid->cellWords[cell * 2u + 1u];
+    if (count >= grid->cellCapacity[cell])
+    {
+        uint32_t capacity = grid->cellCapacity[cell] * 2u;
+        if (capacity < count + grid->slackPerCell + 1u) capacity = count + grid->slackPerCell + 1u;
+        if ((grid->indexCount + capacity) > grid->indexCapacity)
+        {
+            if (gbbCompactSphereGrid(grid) != 0) return SPHERE_GRID_FAILED;
+            flags |= SPHERE_GRID_COMPACTED;
+            offset = grid->cellWords[cell * 2u + 0u];
+            if (count >= grid->cellCapacity[cell])
+            {
+                capacity = count + grid->slackPerCell + 1u;
+                if (((grid->indexCount + capacity) > grid->indexCapacity) &&
+                    (reserveGridIndices(grid, grid->indexCount + capacity + gridIndexHeadroom(grid, grid->indexCount)) != 0))
+                {
+                    return flags | SPHERE_GRID_FAILED;
+                }
+            }
+        }
+        if (count >= grid->cellCapacity[cell])
+        {
+            uint32_t relocated = grid->indexCount;
+            memcpy(grid->indexWords + relocated, grid->indexWords + offset, (size_t)count * sizeof(uint32_t));
+            gbbMarkDirty(&grid->indexDirty, relocated, count);
+            grid->garbageCount += grid->cellCapacity[cell];
+            grid->indexCount += capacity;
+            grid->cellCapacity[cell] = capacity;
+            grid->cellWords[cell * 2u + 0u] = relocated;
+            offset = relocated;
+        }
+    }
+
+    grid->indexWords[offset + count] = sphereIndex;
+    grid->cellWords[cell * 2u + 1u] = count + 1u;
+    grid->refCount += 1u;
+    gbbMarkDirty(&grid->indexDirty, offset + count, 1u);
+    gbbMarkDirty(&grid->cellDirty, cell * 2u, 2u);
+    return flags;
+}
+
+uint32_t gbbApplySphereEdits(SphereGrid* grid, PackedSpheres* spheres, const SphereEdit* edits, uint32_t editCount)
+{
+    uint32_t flags = 0u;
+    const uint32_t strideY = grid->dims[0];
+    const uint32_t strideZ = grid->dims[0] * grid->dims[1];
+    for (uint32_t e = 0u; e < editCount; ++e)
+    {
+        const SphereEdit* edit = &edits[e];
+        uint32_t oldLo[3] = {1u, 1u, 1u};
+        uint32_t oldHi[3] = {0u, 0u, 0u};
+        uint32_t newLo[3] = {1u, 1u, 1u};
+        uint32_t newHi[3] = {0u, 0u, 0u};
+        uint32_t sphereIndex = edit->sphereIndex;
+
+        if (edit->op == SPHERE_EDIT_ADD)
+        {
+            if ((spheres->count >= spheres->capacity) &&
+                (gbbReserveSpheres(spheres, spheres->capacity + spheres->capacity / 2u + 64u) != 0))
+            {
+                flags |= SPHERE_GRID_FAILED;
+                continue;
+            }
+            sphereIndex = spheres->count;
+            spheres->count += 1u;
+        }
+        else if (sphereIndex >= spheres->count)
+        {
+            continue;
+        }
+        else
+        {
+            sphereCellRange(grid, &spheres->bounds, &spheres->words[sphereIndex * 2u], oldLo, oldHi);
+        }
+
+        if (edit->op != SPHERE_EDIT_REMOVE)
+        {
+            sphereCellRange(grid, &spheres->bounds, edit->words, newLo, newHi);
+        }
+
+        for (uint32_t z = oldLo[2]; z <= oldHi[2]; ++z)
+        {
+            for (uint32_t y = oldLo[1]; y <= oldHi[1]; ++y)
+            {
+                for (uint32_t x = oldLo[0]; x <= oldHi[0]; ++x)
+                {
+                    if (rangeContains(newLo, newHi, x, y, z) != 0u) continue;
+                    removeCellRef(grid, x + y * strideY + z * strideZ, sphereIndex);
+                }
+            }
+        }
+        for (uint32_t z = newLo[2]; z <= newHi[2]; ++z)
+        {
+            for (uint32_t y = newLo[1]; y <= newHi[1]; ++y)
+            {
+                for (uint32_t x = newLo[0]; x <= newHi[0]; ++x)
+                {
+                    if (rangeContains(oldLo, oldHi, x, y, z) != 0u) continue;
+                    flags |= addCellRef(grid, x + y * strideY + z * strideZ, sphereIndex);
+                }
+            }
+        }
+
+        if (edit->op == SPHERE_EDIT_REMOVE)
+        {
+            uint32_t lastIndex = spheres->count - 1u;
+            if (lastIndex != sphereIndex)
+            {
+                uint32_t lastLo[3];
+                uint32_t lastHi[3];
+                sphereCellRange(grid, &spheres->bounds, &spheres->words[lastIndex * 2u], lastLo, lastHi);
+                for (uint32_t z = lastLo[2]; z <= lastHi[2]; ++z)
+                {
+                    for (uint32_t y = lastLo[1]; y <= lastHi[1]; ++y)
+                    {
+                        for (uint32_t x = lastLo[0]; x <= lastHi[0]; ++x)
+                        {
+                            replaceCellRef(grid, x + y * strideY + z * strideZ, lastIndex, sphereIndex);
+                        }
+                    }
+                }
+                spheres->words[sphereIndex * 2u + 0u] = spheres->words[lastIndex * 2u + 0u];
+                spheres->words[sphereIndex * 2u + 1u] = spheres->words[lastIndex * 2u + 1u];
+                gbbMarkDirty(&spheres->dirty, sphereIndex * 2u, 2u);
+            }
+            spheres->count = lastIndex;
+        }
+        else
+        {
+            spheres->words[sphereIndex * 2u + 0u] = edit->words[0];
+            spheres->words[sphereIndex * 2u + 1u] = edit->words[1];
+            gbbMarkDirty(&spheres->dirty, sphereIndex * 2u, 2u);
+        }
+    }
+
+    uint32_t garbageLimit = grid->indexCount / 4u;
+    if (garbageLimit < COMPACTION_MIN_GARBAGE) garbageLimit = COMPACTION_MIN_GARBAGE;
+    if ((grid->garbageCount > garbageLimit) && (gbbCompactSphereGrid(grid) == 0))
+    {
+        flags |= SPHERE_GRID_COMPACTED;
+    }
+    return flags;
+}
+
+void gbbFreeSphereGrid(SphereGrid* grid)
+{
+    free(grid->cellWords);
+    free(grid->cellCapacity);
+    free(grid->indexWords);
+    free(grid->cellDirty.bits);
+    free(grid->indexDirty.bits);
+    memset(grid, 0, sizeof(*grid));
+}
+
+static uint32_t bitWidth(uint32_t value)
+{
+    uint32_t bits = 1u;
+    while ((bits < 32u) && ((value >> bits) != 0u)) bits += 1u;
+    return bits;
+}
+
+static void writeBits(uint32_t* words, uint64_t bit, uint32_t width, uint32_t value)
+{
+    const size_t word = (size_t)(bit >> 5u);
+    const uint32_t shift = (uint32_t)(bit & 31u);
+    words[word] |= value << shift;
+    if ((shift + width) > 32u) words[word + 1u] |= value >> (32u - shift);
+}
+
+int gbbBuildCompactGrid(CompactGrid* compact, const SphereGrid* grid, uint32_t itemCount)
+{
+    gbbFreeCompactGrid(compact);
+    uint32_t maxCount = 0u;
+    uint32_t maxDelta = 0u;
+    uint64_t refCount = 0u;
+    uint32_t groupRefs = 0u;
+    for (uint32_t cell = 0u; cell < grid->cellCount; ++cell)
+    {
+        const uint32_t count = grid->cellWords[cell * 2u + 1u];
+        if ((cell % COMPACT_GRID_GROUP) == 0u) groupRefs = 0u;
+        if (groupRefs > maxDelta) maxDelta = groupRefs;
+        if (count > maxCount) maxCount = count;
+        groupRefs += count;
+        refCount += count;
+    }
+    const uint32_t indexBits = bitWidth((itemCount > 0u) ? (itemCount - 1u) : 0u);
+    const uint32_t countBits = bitWidth(maxCount);
+    const uint32_t deltaBits = bitWidth(maxDelta);
+    const uint32_t cellBits = countBits + deltaBits;
+    const uint64_t cellStreamBits = (uint64_t)grid->cellCount * cellBits;
+    const uint64_t indexStreamBits = refCount * indexBits;
+    if ((cellBits > 32u) || (cellStreamBits >= (1ull << 32u)) || (indexStreamBits >= (1ull << 32u))) return 1;
+
+    const uint32_t cellStart = COMPACT_GRID_HEADER_WORDS + (grid->cellCount + COMPACT_GRID_GROUP - 1u) / COMPACT_GRID_GROUP;
+    const uint32_t indexStart = cellStart + (uint32_t)((cellStreamBits + 31u) / 32u);
+    const uint32_t wordCount = indexStart + (uint32_t)((indexStreamBits + 31u) / 32u) + 1u;
+    uint32_t *words = (uint32_t *)calloc((size_t)wordCount, sizeof(uint32_t));
+    if (!words) return 1;
+    words[0] = indexBits | (countBits << 8u) | (deltaBits << 16u);
+    words[1] = cellStart;
+    words[2] = indexStart;
+    words[3] = (uint32_t)refCount;
+
+    uint32_t ref = 0u;
+    uint32_t groupBase = 0u;
+    for (uint32_t cell = 0u; cell < grid->cellCount; ++cell)
+    {
+        const uint32_t offset = grid->cellWords[cell * 2u + 0u];
+        const uint32_t count = grid->cellWords[cell * 2u + 1u];
+        if ((cell % COMPACT_GRID_GROUP) == 0u)
+        {
+            groupBase = ref;
+            words[COMPACT_GRID_HEADER_WORDS + cell / COMPACT_GRID_GROUP] = ref;
+        }
+        writeBits(words + cellStart, (uint64_t)cell * cellBits, cellBits, ((ref - groupBase) << countBits) | count);
+        for (uint32_t i = 0u; i < count; ++i)
+        {
+            writeBits(words + indexStart, (uint64_t)ref * indexBits, indexBits, grid->indexWords[offset + i]);
+            ref += 1u;
+        }
+    }
+
+    compact->words = words;
+    compact->wordCount = wordCount;
+    compact->indexBits = indexBits;
+    compact->countBits = countBits;
+    compact->deltaBits = deltaBits;
+    compact->refCount = (uint32_t)refCount;
+    return 0;
+}
+
+void gbbFreeCompactGrid(CompactGrid* compact)
+{
+    free(compact->words);
+    memset(compact, 0, sizeof(*compact));
+}
@@ -0,0 +1,206 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DIRTY_PAGE_WORDS 64u
+
+typedef struct SceneBounds {
+    float min[3];
+    float extent[3];
+    float radiusMin;
+    float radiusMax;
+} SceneBounds;
+
+// One bit per DIRTY_PAGE_WORDS words; set pages are coalesced into upload ranges.
+typedef struct DirtyPages {
+    uint64_t *bits;
+    uint32_t pageCount;
+} DirtyPages;
+
+// Two words per sphere: x|y<<16, z|radius12<<16|material<<28, all relative to bounds.
+typedef struct PackedSpheres {
+    SceneBounds bounds;
+    uint32_t *words;
+    uint32_t count;
+    uint32_t capacity;
+    DirtyPages dirty;
+} PackedSpheres;
+
+// cellWords holds the (offset, count) pairs read by gradient.comp. Each cell owns
+// cellCapacity[cell] index slots starting at its offset, so edits can grow a cell in
+// place until its slack runs out; full cells are relocated to the tail of indexWords
+// and the abandoned slots are reclaimed by compaction.
+typedef struct SphereGrid {
+    uint32_t dims[3];
+    uint32_t cellCount;
+    uint32_t slackPerCell;
+    uint32_t *cellWords;
+    uint32_t *cellCapacity;
+    uint32_t *indexWords;
+    uint32_t indexCount;
+    uint32_t indexCapacity;
+    uint32_t refCount;
+    uint32_t garbageCount;
+    uint32_t compactionCount;
+    DirtyPages cellDirty;
+    DirtyPages indexDirty;
+} SphereGrid;
+
+#define COMPACT_GRID_HEADER_WORDS 4u
+#define COMPACT_GRID_GROUP 16u
+
+// Read-only bit-packed copy of a built grid for static scenes. words[0] holds
+// indexBits | countBits << 8 | deltaBits << 16, words[1..3] the first word of the cell
+// stream, the first word of the index stream and the reference count. One absolute
+// reference offset per COMPACT_GRID_GROUP cells follows, then a cell stream of
+// (delta << countBits) | count words, delta counting from the group's first reference,
+// then the references themselves at indexBits each, without slack. A trailing zero word
+// keeps reads that straddle the last word in bounds.
+typedef struct CompactGrid {
+    uint32_t *words;
+    uint32_t wordCount;
+    uint32_t indexBits;
+    uint32_t countBits;
+    uint32_t deltaBits;
+    uint32_t refCount;
+} CompactGrid;
+
+enum {
+    SPHERE_EDIT_MOVE = 0u,
+    SPHERE_EDIT_ADD = 1u,
+    SPHERE_EDIT_REMOVE = 2u,
+};
+
+// REMOVE moves the last sphere into sphereIndex, so later edits in the same batch
+// must address spheres by their index after the preceding edits were applied.
+typedef struct SphereEdit {
+    uint32_t op;
+    uint32_t sphereIndex;
+    uint32_t words[2];
+} SphereEdit;
+
+// SPHERE_GRID_FAILED means an allocation failed and at least one edit was dropped or
+// left a cell without its reference; the grid should be rebuilt before it is traced.
+enum {
+    SPHERE_GRID_COMPACTED = 1u << 0u,
+    SPHERE_GRID_FAILED = 1u << 1u,
+};
+
+enum {
+    SCENE_DIST_UNIFORM = 0u,
+    SCENE_DIST_CLUSTERED = 1u,
+    SCENE_DIST_STACKED = 2u,
+};
+
+// Zero fields pick defaults: radii 0.22..0.85, one thread per CPU, 8% packing and a
+// height of 8 units (eight shelves for SCENE_DIST_STACKED). The XZ extent grows with
+// sphereCount; the result is bit-identical for any threadCount.
+typedef struct SceneGenDesc {
+    uint32_t sphereCount;
+    uint32_t distribution;
+    uint32_t seed;
+    uint32_t threadCount;
+    float radiusMin;
+    float radiusMax;
+    float height;
+    float packingFraction;
+} SceneGenDesc;
+
+// Binding 4 of gradient.comp: one entry per unique block. The radius range rides in the
+// .w lanes; base holds the block's first sphere, cell and index in the shared buffers.
+typedef struct GpuSphereBlock {
+    float boundsMin[4];
+    float boundsExtent[4];
+    uint32_t counts[4];
+    uint32_t dims[4];
+    uint32_t base[4];
+} GpuSphereBlock;
+
+// Binding 5: rows of the world-to-block affine transform and the block index in block[0].
+typedef struct GpuSphereInstance {
+    float worldToLocal[12];
+    uint32_t block[4];
+} GpuSphereInstance;
+
+// Zero fields pick defaults: 4096 instances of 4 blocks, each block generated from
+// block (512 spheres unless set) with its own seed.
+typedef struct InstancedSceneDesc {
+    uint32_t instanceCount;
+    uint32_t blockCount;
+    uint32_t seed;
+    SceneGenDesc block;
+} InstancedSceneDesc;
+
+// Unique blocks are stored once; each instance only adds a GpuSphereInstance and its
+// entries in the top-level grid. The packed streams are laid out for upload: the
+// top-level grid comes first in cellWords/indexWords, followed by every block's grid.
+typedef struct InstancedScene {
+    uint32_t blockCount;
+    PackedSpheres *blockSpheres;
+    SphereGrid *blockGrids;
+    GpuSphereBlock *gpuBlocks;
+    uint32_t instanceCount;
+    GpuSphereInstance *instances;
+    SceneBounds worldBounds;
+    SphereGrid topGrid;
+    uint32_t *sphereWords;
+    uint32_t sphereWordCount;
+    uint32_t *cellWords;
+    uint32_t cellWordCount;
+    uint32_t *indexWords;
+    uint32_t indexWordCount;
+} InstancedScene;
+
+// Coarse stand-in for a flat scene, traced by secondary rays: one merged proxy sphere
+// per macro cell of macroSize^3 source grid cells (4 when zero), in its own grid. The
+// proxies share the source bounds except for their radius range.
+typedef struct SphereLod {
+    PackedSpheres proxies;
+    SphereGrid grid;
+    uint32_t macroSize;
+} SphereLod;
+
+void gbbDefaultSceneBounds(SceneBounds* bounds);
+void gbbPackSphere(const SceneBounds* bounds, const float center[3], float radius, uint32_t materialId, uint32_t words[2]);
+void gbbDecodeSphere(const SceneBounds* bounds, const uint32_t words[2], float center[3], float* radius);
+int gbbReserveSpheres(PackedSpheres* spheres, uint32_t capacity);
+void gbbBuildPackedSpheres(PackedSpheres* spheres, uint32_t maxCount);
+void gbbFreePackedSpheres(PackedSpheres* spheres);
+uint32_t gbbGenerateSpheres(PackedSpheres* spheres, const SceneGenDesc* desc);
+void gbbChooseGridDims(const PackedSpheres* spheres, uint32_t dims[3]);
+
+int gbbBuildSphereGrid(SphereGrid* grid, const PackedSpheres* spheres,
+                       uint32_t dimX, uint32_t dimY, uint32_t dimZ, uint32_t slackPerCell);
+int gbbBuildBoxGrid(SphereGrid* grid, const SceneBounds* bounds, const float* boxes, uint32_t boxCount,
+                    uint32_t dimX, uint32_t dimY, uint32_t dimZ);
+uint32_t gbbApplySphereEdits(SphereGrid* grid, PackedSpheres* spheres, const SphereEdit* edits, uint32_t editCount);
+int gbbCompactSphereGrid(SphereGrid* grid);
+void gbbFreeSphereGrid(SphereGrid* grid);
+
+// Fails (leaving compact empty) when a cell word would need more than 32 bits or a
+// stream more than 2^32 bits; the grid must have been built for itemCount items.
+int gbbBuildCompactGrid(CompactGrid* compact, const SphereGrid* grid, uint32_t itemCount);
+void gbbFreeCompactGrid(CompactGrid* compact);
+
+int gbbBuildInstancedScene(InstancedScene* scene, const InstancedSceneDesc* desc);
+void gbbInstancedSceneFootprint(const InstancedScene* scene, uint64_t* uniqueBytes, uint64_t* flattenedBytes);
+void gbbFreeInstancedScene(InstancedScene* scene);
+
+int gbbBuildSphereLod(SphereLod* lod, const PackedSpheres* spheres, const SphereGrid* grid, uint32_t macroSize);
+void gbbFreeSphereLod(SphereLod* lod);
+
+void gbbMarkDirty(DirtyPages* dirty, uint32_t firstWord, uint32_t wordCount);
+void gbbMarkAllDirty(DirtyPages* dirty);
+int gbbNextDirtyRange(const DirtyPages* dirty, uint32_t* cursor, uint32_t* firstWord, uint32_t* wordCount);
+void gbbClearDirty(DirtyPages* dirty);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
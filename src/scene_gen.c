@@ -0,0 +1,360 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+#include "scene.h"
+
+#define GEN_MAX_THREADS 64u
+#define GEN_BIN_MAX_SPHERES 24u
+#define GEN_ATTEMPTS_PER_SPHERE 16u
+#define GEN_CLUSTER_BINS 8u
+
+static const float GEN_SPHERE_GAP = 0.03f;
+static const float GEN_DEFAULT_HEIGHT = 8.0f;
+static const float GEN_STACKED_SHELVES = 8.0f;
+
+// Candidates are binned on a grid whose cells are at least one minimum centre distance
+// wide, so overlap tests only visit the 27 neighbouring bins. Bins are filled in eight
+// parity phases: bins sharing a phase are never neighbours, so each phase runs in
+// parallel without locks, and every bin draws from its own seed, which keeps the
+// output independent of the thread count.
+typedef struct SceneGenContext {
+    const SceneGenDesc* desc;
+    SceneBounds bounds;
+    uint32_t dims[3];
+    float binExtent[3];
+    float *density;
+    uint32_t *quota;
+    uint32_t *slotOffset;
+    uint32_t *placedCount;
+    float *placed;
+    uint32_t *placedWords;
+    uint32_t phase;
+} SceneGenContext;
+
+typedef void (*SceneGenJob)(SceneGenContext* ctx, uint32_t job);
+
+typedef struct SceneGenWorker {
+    SceneGenContext* ctx;
+    SceneGenJob job;
+    uint32_t first;
+    uint32_t end;
+} SceneGenWorker;
+
+static uint32_t hash32(uint32_t x)
+{
+    x ^= x >> 16u;
+    x *= 0x7feb352du;
+    x ^= x >> 15u;
+    x *= 0x846ca68bu;
+    x ^= x >> 16u;
+    return x;
+}
+
+static uint32_t nextRandom(uint32_t *state)
+{
+    *state = (*state * 1664525u) + 1013904223u;
+    return *state;
+}
+
+static float random01(uint32_t *state)
+{
+    return (float)((nextRandom(state) >> 8u) & 0x00ffffffu) * (1.0f / 16777216.0f);
+}
+
+static float hash01(uint32_t x)
+{
+    return (float)(hash32(x) >> 8u) * (1.0f / 16777216.0f);
+}
+
+static void sceneGenWorkerMain(void* user)
+{
+    SceneGenWorker* worker = (SceneGenWorker*)user;
+    for (uint32_t job = worker->first; job < worker->end; ++job)
+    {
+        worker->job(worker->ctx, job);
+    }
+}
+
+static void runParallel(SceneGenContext* ctx, uint32_t threadCount, uint32_t jobCount, SceneGenJob job)
+{
+    SceneGenWorker workers[GEN_MAX_THREADS];
+    void* threads[GEN_MAX_THREADS];
+    if (jobCount == 0u) return;
+    if (threadCount == 0u) threadCount = 1u;
+    if (threadCount > jobCount) threadCount = jobCount;
+    for (uint32_t t = 0u; t < threadCount; ++t)
+    {
+        const uint32_t first = (uint32_t)(((uint64_t)jobCount * t) / threadCount);
+        const uint32_t end = (uint32_t)(((uint64_t)jobCount * (t + 1u)) / threadCount);
+        workers[t] = (SceneGenWorker){ctx, job, first, end};
+        threads[t] = (t > 0u) ? gbbCreateThread(sceneGenWorkerMain, &workers[t]) : NULL;
+    }
+    sceneGenWorkerMain(&workers[0]);
+    for (uint32_t t = 1u; t < threadCount; ++t)
+    {
+        if (threads[t]) gbbJoinThread(threads[t]);
+        else sceneGenWorkerMain(&workers[t]);
+    }
+}
+
+static float clusterDensity(const SceneGenContext* ctx, uint32_t x, uint32_t z)
+{
+    const uint32_t seed = ctx->desc->seed;
+    const float binX = (float)x + 0.5f;
+    const float binZ = (float)z + 0.5f;
+    const int32_t cellX = (int32_t)(x / GEN_CLUSTER_BINS);
+    const int32_t cellZ = (int32_t)(z / GEN_CLUSTER_BINS);
+    const float sigma = (float)GEN_CLUSTER_BINS * 0.22f;
+    float density = 0.02f;
+    for (int32_t dz = -1; dz <= 1; ++dz)
+    {
+        for (int32_t dx = -1; dx <= 1; ++dx)
+        {
+            const uint32_t key = (uint32_t)(cellX + dx) * 0x8da6b343u ^ (uint32_t)(cellZ + dz) * 0xd8163841u ^ seed;
+            const float centerX = ((float)(cellX + dx) + hash01(key)) * (float)GEN_CLUSTER_BINS;
+            const float centerZ = ((float)(cellZ + dz) + hash01(key ^ 0x68bc21ebu)) * (float)GEN_CLUSTER_BINS;
+            const float distSq = (binX - centerX) * (binX - centerX) + (binZ - centerZ) * (binZ - centerZ);
+            density = fmaxf(density, expf(-distSq / (2.0f * sigma * sigma)));
+        }
+    }
+    return density;
+}
+
+static void computeBinDensity(SceneGenContext* ctx, uint32_t bin)
+{
+    const uint32_t x = bin % ctx->dims[0];
+    const uint32_t z = bin / (ctx->dims[0] * ctx->dims[1]);
+    ctx->density[bin] = (ctx->desc->distribution == SCENE_DIST_CLUSTERED) ? clusterDensity(ctx, x, z) : 1.0f;
+}
+
+static uint32_t overlapsNeighbours(const SceneGenContext* ctx, const uint32_t bin[3], const float center[3], float radius)
+{
+    for (int32_t dz = -1; dz <= 1; ++dz)
+    {
+        for (int32_t dy = -1; dy <= 1; ++dy)
+        {
+            for (int32_t dx = -1; dx <= 1; ++dx)
+            {
+                const int32_t nx = (int32_t)bin[0] + dx;
+                const int32_t ny = (int32_t)bin[1] + dy;
+                const int32_t nz = (int32_t)bin[2] + dz;
+                if ((nx < 0) || (ny < 0) || (nz < 0) ||
+                    ((uint32_t)nx >= ctx->dims[0]) || ((uint32_t)ny >= ctx->dims[1]) || ((uint32_t)nz >= ctx->dims[2]))
+                {
+                    continue;
+                }
+                const uint32_t neighbour = (uint32_t)nx + (uint32_t)ny * ctx->dims[0] + (uint32_t)nz * ctx->dims[0] * ctx->dims[1];
+                const float* placed = ctx->placed + (size_t)ctx->slotOffset[neighbour] * 4u;
+                for (uint32_t s = 0u; s < ctx->placedCount[neighbour]; ++s)
+                {
+                    float ddx = center[0] - placed[s * 4u + 0u];
+                    float ddy = center[1] - placed[s * 4u + 1u];
+                    float ddz = center[2] - placed[s * 4u + 2u];
+                    float minDist = radius + placed[s * 4u + 3u] + GEN_SPHERE_GAP;
+                    if ((ddx * ddx + ddy * ddy + ddz * ddz) < (minDist * minDist)) return 1u;
+                }
+            }
+        }
+    }
+    return 0u;
+}
+
+static void placeBinSpheres(SceneGenContext* ctx, uint32_t job)
+{
+    const uint32_t parity[3] = {ctx->phase & 1u, (ctx->phase >> 1u) & 1u, (ctx->phase >> 2u) & 1u};
+    const uint32_t phaseDimX = (ctx->dims[0] - parity[0] + 1u) / 2u;
+    const uint32_t phaseDimY = (ctx->dims[1] - parity[1] + 1u) / 2u;
+    const uint32_t bin[3] = {
+        parity[0] + 2u * (job % phaseDimX),
+        parity[1] + 2u * ((job / phaseDimX) % phaseDimY),
+        parity[2] + 2u * (job / (phaseDimX * phaseDimY)),
+    };
+    const uint32_t binIndex = bin[0] + bin[1] * ctx->dims[0] + bin[2] * ctx->dims[0] * ctx->dims[1];
+    const uint32_t quota = ctx->quota[binIndex];
+    const SceneBounds* bounds = &ctx->bounds;
+    const float radiusMin = bounds->radiusMin;
+    const float radiusMax = bounds->radiusMax;
+
+    float binMin[3];
+    float boundsMax[3];
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        binMin[axis] = bounds->min[axis] + (float)bin[axis] * ctx->binExtent[axis];
+        boundsMax[axis] = bounds->min[axis] + bounds->extent[axis];
+    }
+
+    uint32_t rng = hash32(ctx->desc->seed ^ hash32(binIndex * 0x9e3779b9u + 0x85ebca6bu));
+    uint32_t placedCount = 0u;
+    for (uint32_t attempt = 0u; (attempt < quota * GEN_ATTEMPTS_PER_SPHERE) && (placedCount < quota); ++attempt)
+    {
+        float radius = radiusMin + (radiusMax - radiusMin) * (0.25f + 0.75f * random01(&rng));
+        float center[3];
+        center[0] = binMin[0] + ctx->binExtent[0] * random01(&rng);
+        center[1] = binMin[1] + ctx->binExtent[1] * random01(&rng);
+        center[2] = binMin[2] + ctx->binExtent[2] * random01(&rng);
+        if (ctx->desc->distribution == SCENE_DIST_STACKED)
+        {
+            center[1] = binMin[1] + radius + bounds->extent[1] * (1.0f / 65535.0f);
+        }
+        uint32_t materialId = nextRandom(&rng) % 3u;
+
+        uint32_t words[2];
+        gbbPackSphere(bounds, center, radius, materialId, words);
+        float decoded[3];
+        float decodedRadius = 0.0f;
+        gbbDecodeSphere(bounds, words, decoded, &decodedRadius);
+
+        uint32_t rejected = 0u;
+        for (uint32_t axis = 0u; axis < 3u; ++axis)
+        {
+            const float binCoord = floorf((decoded[axis] - bounds->min[axis]) / ctx->binExtent[axis]);
+            rejected |= (uint32_t)(binCoord != (float)bin[axis]);
+            rejected |= (uint32_t)((decoded[axis] - decodedRadius) < bounds->min[axis]);
+            rejected |= (uint32_t)((decoded[axis] + decodedRadius) > boundsMax[axis]);
+        }
+        if (rejected != 0u) continue;
+        if (overlapsNeighbours(ctx, bin, decoded, decodedRadius) != 0u) continue;
+
+        const size_t slot = (size_t)ctx->slotOffset[binIndex] + placedCount;
+        ctx->placed[slot * 4u + 0u] = decoded[0];
+        ctx->placed[slot * 4u + 1u] = decoded[1];
+        ctx->placed[slot * 4u + 2u] = decoded[2];
+        ctx->placed[slot * 4u + 3u] = decodedRadius;
+        ctx->placedWords[slot * 2u + 0u] = words[0];
+        ctx->placedWords[slot * 2u + 1u] = words[1];
+        placedCount += 1u;
+        ctx->placedCount[binIndex] = placedCount;
+    }
+}
+
+static float averageSphereVolume(float radiusMin, float radiusMax)
+{
+    float sum = 0.0f;
+    for (uint32_t i = 0u; i < 16u; ++i)
+    {
+        float radius = radiusMin + (radiusMax - radiusMin) * (0.25f + 0.75f * ((float)i + 0.5f) * (1.0f / 16.0f));
+        sum += radius * radius * radius;
+    }
+    return (4.0f / 3.0f) * 3.14159265f * sum * (1.0f / 16.0f);
+}
+
+static uint32_t fillBins(SceneGenContext* ctx, uint32_t threadCount)
+{
+    const uint32_t binCount = ctx->dims[0] * ctx->dims[1] * ctx->dims[2];
+    runParallel(ctx, threadCount, binCount, computeBinDensity);
+    double densitySum = 0.0;
+    for (uint32_t bin = 0u; bin < binCount; ++bin)
+    {
+        densitySum += (double)ctx->density[bin];
+    }
+    uint32_t slotCount = 0u;
+    for (uint32_t bin = 0u; bin < binCount; ++bin)
+    {
+        double share = (double)ctx->desc->sphereCount * (double)ctx->density[bin] / densitySum;
+        uint32_t quota = (uint32_t)floor(share + (double)hash01(ctx->desc->seed ^ hash32(bin + 0x632be5abu)));
+        if (quota > GEN_BIN_MAX_SPHERES) quota = GEN_BIN_MAX_SPHERES;
+        ctx->quota[bin] = quota;
+        ctx->slotOffset[bin] = slotCount;
+        slotCount += quota;
+    }
+
+    ctx->placed = (float *)malloc(((size_t)slotCount + 1u) * 4u * sizeof(float));
+    ctx->placedWords = (uint32_t *)malloc(((size_t)slotCount + 1u) * 2u * sizeof(uint32_t));
+    if (!ctx->placed || !ctx->placedWords) return 0u;
+
+    for (ctx->phase = 0u; ctx->phase < 8u; ++ctx->phase)
+    {
+        const uint32_t phaseDims[3] = {
+            (ctx->dims[0] - (ctx->phase & 1u) + 1u) / 2u,
+            (ctx->dims[1] - ((ctx->phase >> 1u) & 1u) + 1u) / 2u,
+            (ctx->dims[2] - ((ctx->phase >> 2u) & 1u) + 1u) / 2u,
+        };
+        runParallel(ctx, threadCount, phaseDims[0] * phaseDims[1] * phaseDims[2], placeBinSpheres);
+    }
+
+    uint32_t generated = 0u;
+    for (uint32_t bin = 0u; bin < binCount; ++bin)
+    {
+        generated += ctx->placedCount[bin];
+    }
+    return generated;
+}
+
+uint32_t gbbGenerateSpheres(PackedSpheres* spheres, const SceneGenDesc* desc)
+{
+    SceneGenContext ctx = {0};
+    ctx.desc = desc;
+    ctx.bounds.radiusMin = (desc->radiusMax > desc->radiusMin) ? desc->radiusMin : 0.22f;
+    ctx.bounds.radiusMax = (desc->radiusMax > desc->radiusMin) ? desc->radiusMax : 0.85f;
+    const float minBin = 2.0f * ctx.bounds.radiusMax + GEN_SPHERE_GAP;
+
+    float height = desc->height;
+    if (height <= 0.0f)
+    {
+        height = (desc->distribution == SCENE_DIST_STACKED) ? (minBin * GEN_STACKED_SHELVES) : GEN_DEFAULT_HEIGHT;
+    }
+    if (height < minBin) height = minBin;
+    float packing = (desc->packingFraction > 0.0f) ? desc->packingFraction : 0.08f;
+    if (desc->distribution == SCENE_DIST_CLUSTERED) packing *= 0.5f;
+    const float volume = (float)desc->sphereCount * averageSphereVolume(ctx.bounds.radiusMin, ctx.bounds.radiusMax) / packing;
+    const float side = fmaxf(sqrtf(volume / height), minBin * 4.0f);
+    ctx.bounds.min[0] = -0.5f * side;
+    ctx.bounds.min[1] = 0.0f;
+    ctx.bounds.min[2] = -0.5f * side;
+    ctx.bounds.extent[0] = side;
+    ctx.bounds.extent[1] = height;
+    ctx.bounds.extent[2] = side;
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        ctx.dims[axis] = (uint32_t)floorf(ctx.bounds.extent[axis] / minBin);
+        if (ctx.dims[axis] == 0u) ctx.dims[axis] = 1u;
+        ctx.binExtent[axis] = ctx.bounds.extent[axis] / (float)ctx.dims[axis];
+    }
+
+    uint32_t threadCount = (desc->threadCount > 0u) ? desc->threadCount : gbbGetCpuCount();
+    if (threadCount > GEN_MAX_THREADS) threadCount = GEN_MAX_THREADS;
+
+    const uint32_t binCount = ctx.dims[0] * ctx.dims[1] * ctx.dims[2];
+    ctx.density = (float *)malloc((size_t)binCount * sizeof(float));
+    ctx.quota = (uint32_t *)malloc((size_t)binCount * sizeof(uint32_t));
+    ctx.slotOffset = (uint32_t *)malloc((size_t)binCount * sizeof(uint32_t));
+    ctx.placedCount = (uint32_t *)calloc((size_t)binCount, sizeof(uint32_t));
+    uint32_t generated = 0u;
+    if (ctx.density && ctx.quota && ctx.slotOffset && ctx.placedCount)
+    {
+        generated = fillBins(&ctx, threadCount);
+    }
+
+    spheres->bounds = ctx.bounds;
+    spheres->count = 0u;
+    if ((generated > 0u) && (gbbReserveSpheres(spheres, generated) == 0))
+    {
+        for (uint32_t bin = 0u; bin < binCount; ++bin)
+        {
+            memcpy(spheres->words + (size_t)spheres->count * 2u, ctx.placedWords + (size_t)ctx.slotOffset[bin] * 2u,
+                   (size_t)ctx.placedCount[bin] * 2u * sizeof(uint32_t));
+            spheres->count += ctx.placedCount[bin];
+        }
+        gbbMarkAllDirty(&spheres->dirty);
+    }
+
+    free(ctx.density);
+    free(ctx.quota);
+    free(ctx.slotOffset);
+    free(ctx.placedCount);
+    free(ctx.placed);
+    free(ctx.placedWords);
+    return spheres->count;
+}
+
+void gbbChooseGridDims(const PackedSpheres* spheres, uint32_t dims[3])
+{
+    const float cellSize = 2.0f * spheres->bounds.radiusMax;
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        float cells = ceilf(spheres->bounds.extent[axis] / cellSize);
+        dims[axis] = (cells < 1.0f) ? 1u : ((cells > 1024.0f) ? 1024u : (uint32_t)cells);
+    }
+}
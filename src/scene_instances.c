@@ -0,0 +1,252 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scene.h"
+
+#define INSTANCE_DEFAULT_COUNT 4096u
+#define INSTANCE_DEFAULT_BLOCKS 4u
+#define INSTANCE_DEFAULT_BLOCK_SPHERES 512u
+#define INSTANCE_GRID_MAX_DIM 1024u
+
+static const float INSTANCE_SCALE_MIN = 0.75f;
+static const float INSTANCE_SCALE_MAX = 1.25f;
+static const float INSTANCE_GAP = 1.0f;
+
+static uint32_t hash32(uint32_t x)
+{
+    x ^= x >> 16u;
+    x *= 0x7feb352du;
+    x ^= x >> 15u;
+    x *= 0x846ca68bu;
+    x ^= x >> 16u;
+    return x;
+}
+
+static float hash01(uint32_t x)
+{
+    return (float)(hash32(x) >> 8u) * (1.0f / 16777216.0f);
+}
+
+static uint32_t clampDim(float cells)
+{
+    if (!(cells >= 1.0f)) return 1u;
+    if (cells >= (float)INSTANCE_GRID_MAX_DIM) return INSTANCE_GRID_MAX_DIM;
+    return (uint32_t)ceilf(cells);
+}
+
+static int packInstancedScene(InstancedScene* scene)
+{
+    uint32_t sphereWordCount = 0u;
+    uint32_t cellWordCount = scene->topGrid.cellCount * 2u;
+    uint32_t indexWordCount = scene->topGrid.indexCount;
+    for (uint32_t b = 0u; b < scene->blockCount; ++b)
+    {
+        sphereWordCount += scene->blockSpheres[b].count * 2u;
+        cellWordCount += scene->blockGrids[b].cellCount * 2u;
+        indexWordCount += scene->blockGrids[b].indexCount;
+    }
+
+    scene->sphereWords = (uint32_t *)malloc((size_t)(sphereWordCount + 2u) * sizeof(uint32_t));
+    scene->cellWords = (uint32_t *)malloc((size_t)(cellWordCount + 2u) * sizeof(uint32_t));
+    scene->indexWords = (uint32_t *)malloc((size_t)(indexWordCount + 2u) * sizeof(uint32_t));
+    scene->gpuBlocks = (GpuSphereBlock *)calloc((size_t)scene->blockCount, sizeof(GpuSphereBlock));
+    if (!scene->sphereWords || !scene->cellWords || !scene->indexWords || !scene->gpuBlocks) return 1;
+
+    memcpy(scene->cellWords, scene->topGrid.cellWords, (size_t)scene->topGrid.cellCount * 2u * sizeof(uint32_t));
+    memcpy(scene->indexWords, scene->topGrid.indexWords, (size_t)scene->topGrid.indexCount * sizeof(uint32_t));
+    uint32_t sphereBase = 0u;
+    uint32_t cellBase = scene->topGrid.cellCount;
+    uint32_t indexBase = scene->topGrid.indexCount;
+    for (uint32_t b = 0u; b < scene->blockCount; ++b)
+    {
+        const PackedSpheres* spheres = &scene->blockSpheres[b];
+        const SphereGrid* grid = &scene->blockGrids[b];
+        memcpy(scene->sphereWords + sphereBase * 2u, spheres->words, (size_t)spheres->count * 2u * sizeof(uint32_t));
+        memcpy(scene->cellWords + cellBase * 2u, grid->cellWords, (size_t)grid->cellCount * 2u * sizeof(uint32_t));
+        memcpy(scene->indexWords + indexBase, grid->indexWords, (size_t)grid->indexCount * sizeof(uint32_t));
+
+        GpuSphereBlock* gpu = &scene->gpuBlocks[b];
+        for (uint32_t axis = 0u; axis < 3u; ++axis)
+        {
+            gpu->boundsMin[axis] = spheres->bounds.min[axis];
+            gpu->boundsExtent[axis] = spheres->bounds.extent[axis];
+            gpu->dims[axis] = grid->dims[axis];
+        }
+        gpu->boundsMin[3] = spheres->bounds.radiusMin;
+        gpu->boundsExtent[3] = spheres->bounds.radiusMax;
+        gpu->counts[0] = spheres->count;
+        gpu->counts[1] = grid->cellCount;
+        gpu->counts[2] = grid->indexCount;
+        gpu->base[0] = sphereBase;
+        gpu->base[1] = cellBase;
+        gpu->base[2] = indexBase;
+
+        sphereBase += spheres->count;
+        cellBase += grid->cellCount;
+        indexBase += grid->indexCount;
+    }
+    scene->sphereWordCount = sphereWordCount;
+    scene->cellWordCount = cellWordCount;
+    scene->indexWordCount = indexWordCount;
+    return 0;
+}
+
+// Instances sit on a jittered XZ lattice with a random yaw and uniform scale; each
+// lattice slot is wide enough for the largest block at the largest scale and rotation.
+int gbbBuildInstancedScene(InstancedScene* scene, const InstancedSceneDesc* desc)
+{
+    memset(scene, 0, sizeof(*scene));
+    const uint32_t instanceCount = (desc->instanceCount > 0u) ? desc->instanceCount : INSTANCE_DEFAULT_COUNT;
+    const uint32_t blockCount = (desc->blockCount > 0u) ? desc->blockCount : INSTANCE_DEFAULT_BLOCKS;
+
+    scene->blockSpheres = (PackedSpheres *)calloc((size_t)blockCount, sizeof(PackedSpheres));
+    scene->blockGrids = (SphereGrid *)calloc((size_t)blockCount, sizeof(SphereGrid));
+    scene->instances = (GpuSphereInstance *)calloc((size_t)instanceCount, sizeof(GpuSphereInstance));
+    float *boxes = (float *)malloc((size_t)instanceCount * 6u * sizeof(float));
+    if (!scene->blockSpheres || !scene->blockGrids || !scene->instances || !boxes)
+    {
+        free(boxes);
+        return 1;
+    }
+    scene->blockCount = blockCount;
+    scene->instanceCount = instanceCount;
+
+    float blockDiagonal = 0.0f;
+    for (uint32_t b = 0u; b < blockCount; ++b)
+    {
+        SceneGenDesc blockDesc = desc->block;
+        if (blockDesc.sphereCount == 0u) blockDesc.sphereCount = INSTANCE_DEFAULT_BLOCK_SPHERES;
+        blockDesc.seed = hash32(desc->seed + b * 0x9e3779b9u);
+        gbbGenerateSpheres(&scene->blockSpheres[b], &blockDesc);
+
+        uint32_t dims[3];
+        gbbChooseGridDims(&scene->blockSpheres[b], dims);
+        if (gbbBuildSphereGrid(&scene->blockGrids[b], &scene->blockSpheres[b], dims[0], dims[1], dims[2], 0u) != 0)
+        {
+            free(boxes);
+            return 1;
+        }
+        const float* extent = scene->blockSpheres[b].bounds.extent;
+        blockDiagonal = fmaxf(blockDiagonal, sqrtf(extent[0] * extent[0] + extent[2] * extent[2]));
+    }
+
+    const uint32_t side = (uint32_t)ceilf(sqrtf((float)instanceCount));
+    const float slot = blockDiagonal * INSTANCE_SCALE_MAX + INSTANCE_GAP;
+    float worldMin[3] = {1e30f, 1e30f, 1e30f};
+    float worldMax[3] = {-1e30f, -1e30f, -1e30f};
+    for (uint32_t i = 0u; i < instanceCount; ++i)
+    {
+        const uint32_t key = desc->seed ^ hash32(i * 4u + 0x51u);
+        const uint32_t blockIndex = hash32(key) % blockCount;
+        const SceneBounds* local = &scene->blockSpheres[blockIndex].bounds;
+        const float angle = hash01(key + 1u) * 6.2831853072f;
+        const float scale = INSTANCE_SCALE_MIN + (INSTANCE_SCALE_MAX - INSTANCE_SCALE_MIN) * hash01(key + 2u);
+        const float play = 0.5f * (slot - blockDiagonal * scale - INSTANCE_GAP);
+        const float translation[3] = {
+            ((float)(i % side) - 0.5f * (float)(side - 1u)) * slot + play * (2.0f * hash01(key + 3u) - 1.0f),
+            0.0f,
+            ((float)(i / side) - 0.5f * (float)(side - 1u)) * slot + play * (2.0f * hash01(key + 4u) - 1.0f),
+        };
+        const float pivot[3] = {
+            local->min[0] + 0.5f * local->extent[0],
+            local->min[1],
+            local->min[2] + 0.5f * local->extent[2],
+        };
+        const float c = cosf(angle);
+        const float s = sinf(angle);
+
+        // local = pivot + R^T (world - T) / scale, with R a rotation about +Y.
+        const float rows[3][3] = {
+            {c / scale, 0.0f, -s / scale},
+            {0.0f, 1.0f / scale, 0.0f},
+            {s / scale, 0.0f, c / scale},
+        };
+        GpuSphereInstance* inst = &scene->instances[i];
+        for (uint32_t r = 0u; r < 3u; ++r)
+        {
+            inst->worldToLocal[r * 4u + 0u] = rows[r][0];
+            inst->worldToLocal[r * 4u + 1u] = rows[r][1];
+            inst->worldToLocal[r * 4u + 2u] = rows[r][2];
+            inst->worldToLocal[r * 4u + 3u] = pivot[r] -
+                (rows[r][0] * translation[0] + rows[r][1] * translation[1] + rows[r][2] * translation[2]);
+        }
+        inst->block[0] = blockIndex;
+
+        float* box = &boxes[i * 6u];
+        box[0] = box[1] = box[2] = 1e30f;
+        box[3] = box[4] = box[5] = -1e30f;
+        for (uint32_t corner = 0u; corner < 8u; ++corner)
+        {
+            float p[3];
+            for (uint32_t axis = 0u; axis < 3u; ++axis)
+            {
+                p[axis] = local->min[axis] + (((corner >> axis) & 1u) ? local->extent[axis] : 0.0f) - pivot[axis];
+            }
+            const float world[3] = {
+                translation[0] + scale * (c * p[0] + s * p[2]),
+                translation[1] + scale * p[1],
+                translation[2] + scale * (-s * p[0] + c * p[2]),
+            };
+            for (uint32_t axis = 0u; axis < 3u; ++axis)
+            {
+                box[axis] = fminf(box[axis], world[axis]);
+                box[axis + 3u] = fmaxf(box[axis + 3u], world[axis]);
+            }
+        }
+        for (uint32_t axis = 0u; axis < 3u; ++axis)
+        {
+            worldMin[axis] = fminf(worldMin[axis], box[axis]);
+            worldMax[axis] = fmaxf(worldMax[axis], box[axis + 3u]);
+        }
+    }
+
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        scene->worldBounds.min[axis] = worldMin[axis] - 1e-3f;
+        scene->worldBounds.extent[axis] = fmaxf(worldMax[axis] - worldMin[axis], 1e-3f) + 2e-3f;
+    }
+    scene->worldBounds.radiusMin = scene->blockSpheres[0].bounds.radiusMin;
+    scene->worldBounds.radiusMax = scene->blockSpheres[0].bounds.radiusMax;
+
+    int result = gbbBuildBoxGrid(&scene->topGrid, &scene->worldBounds, boxes, instanceCount,
+                                 clampDim(scene->worldBounds.extent[0] / slot), 1u,
+                                 clampDim(scene->worldBounds.extent[2] / slot));
+    free(boxes);
+    if (result != 0) return result;
+    return packInstancedScene(scene);
+}
+
+// uniqueBytes is what the GPU holds; flattenedBytes is what copying every instance's
+// spheres and grid into one flat scene would take.
+void gbbInstancedSceneFootprint(const InstancedScene* scene, uint64_t* uniqueBytes, uint64_t* flattenedBytes)
+{
+    *uniqueBytes = (uint64_t)(scene->sphereWordCount + scene->cellWordCount + scene->indexWordCount) * sizeof(uint32_t) +
+                   (uint64_t)scene->blockCount * sizeof(GpuSphereBlock) +
+                   (uint64_t)scene->instanceCount * sizeof(GpuSphereInstance);
+    *flattenedBytes = 0u;
+    for (uint32_t i = 0u; i < scene->instanceCount; ++i)
+    {
+        const uint32_t b = scene->instances[i].block[0];
+        *flattenedBytes += (uint64_t)(scene->blockSpheres[b].count * 2u + scene->blockGrids[b].cellCount * 2u +
+                                      scene->blockGrids[b].indexCount) * sizeof(uint32_t);
+    }
+}
+
+void gbbFreeInstancedScene(InstancedScene* scene)
+{
+    for (uint32_t b = 0u; b < scene->blockCount; ++b)
+    {
+        if (scene->blockSpheres) gbbFreePackedSpheres(&scene->blockSpheres[b]);
+        if (scene->blockGrids) gbbFreeSphereGrid(&scene->blockGrids[b]);
+    }
+    free(scene->blockSpheres);
+    free(scene->blockGrids);
+    free(scene->gpuBlocks);
+    free(scene->instances);
+    gbbFreeSphereGrid(&scene->topGrid);
+    free(scene->sphereWords);
+    free(scene->cellWords);
+    free(scene->indexWords);
+    memset(scene, 0, sizeof(*scene));
+}
@@ -0,0 +1,116 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scene.h"
+
+#define LOD_DEFAULT_MACRO_SIZE 4u
+#define LOD_MATERIAL_COUNT 16u
+
+typedef struct LodAccum {
+    double center[3];
+    double area;
+    double areaByMaterial[LOD_MATERIAL_COUNT];
+} LodAccum;
+
+static uint32_t macroCoord(float value, float boundsMin, float cellSize, uint32_t macroSize, uint32_t macroDim)
+{
+    int32_t cell = (int32_t)floorf((value - boundsMin) / cellSize);
+    if (cell < 0) cell = 0;
+    const uint32_t macro = (uint32_t)cell / macroSize;
+    return (macro >= macroDim) ? (macroDim - 1u) : macro;
+}
+
+// Each sphere lands in the macro cell holding its center. A proxy sits at the
+// area-weighted centroid with the summed cross-section (r = sqrt(sum r^2)), so it
+// blocks roughly as much light as the spheres it replaces, and takes the material
+// covering the most area.
+int gbbBuildSphereLod(SphereLod* lod, const PackedSpheres* spheres, const SphereGrid* grid, uint32_t macroSize)
+{
+    gbbFreeSphereLod(lod);
+    if (macroSize == 0u) macroSize = LOD_DEFAULT_MACRO_SIZE;
+    lod->macroSize = macroSize;
+    if ((spheres->count == 0u) || (grid->cellCount == 0u)) return 0;
+
+    const SceneBounds *bounds = &spheres->bounds;
+    uint32_t macroDims[3];
+    float cellSize[3];
+    for (uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        macroDims[axis] = (grid->dims[axis] + macroSize - 1u) / macroSize;
+        cellSize[axis] = bounds->extent[axis] / (float)grid->dims[axis];
+    }
+    const size_t macroCount = (size_t)macroDims[0] * macroDims[1] * macroDims[2];
+    LodAccum *accum = (LodAccum *)calloc(macroCount, sizeof(LodAccum));
+    if (!accum) return 1;
+
+    for (uint32_t i = 0u; i < spheres->count; ++i)
+    {
+        float center[3];
+        float radius = 0.0f;
+        gbbDecodeSphere(bounds, &spheres->words[i * 2u], center, &radius);
+        uint32_t macro[3];
+        for (uint32_t axis = 0u; axis < 3u; ++axis)
+        {
+            macro[axis] = macroCoord(center[axis], bounds->min[axis], cellSize[axis], macroSize, macroDims[axis]);
+        }
+        LodAccum *a = &accum[macro[0] + (size_t)macroDims[0] * (macro[1] + (size_t)macroDims[1] * macro[2])];
+        const double area = (double)radius * radius;
+        for (uint32_t axis = 0u; axis < 3u; ++axis)
+        {
+            a->center[axis] += (double)center[axis] * area;
+        }
+        a->area += area;
+        a->areaByMaterial[(spheres->words[i * 2u + 1u] >> 28u) & (LOD_MATERIAL_COUNT - 1u)] += area;
+    }
+
+    uint32_t proxyCount = 0u;
+    float radiusMin = INFINITY;
+    float radiusMax = 0.0f;
+    for (size_t m = 0u; m < macroCount; ++m)
+    {
+        if (accum[m].area <= 0.0) continue;
+        const float radius = (float)sqrt(accum[m].area);
+        radiusMin = fminf(radiusMin, radius);
+        radiusMax = fmaxf(radiusMax, radius);
+        proxyCount += 1u;
+    }
+
+    PackedSpheres *proxies = &lod->proxies;
+    proxies->bounds = *bounds;
+    proxies->bounds.radiusMin = radiusMin;
+    proxies->bounds.radiusMax = fmaxf(radiusMax, radiusMin + 1e-3f);
+    if (gbbReserveSpheres(proxies, proxyCount) != 0)
+    {
+        free(accum);
+        return 1;
+    }
+    for (size_t m = 0u; m < macroCount; ++m)
+    {
+        const LodAccum *a = &accum[m];
+        if (a->area <= 0.0) continue;
+        float center[3];
+        for (uint32_t axis = 0u; axis < 3u; ++axis)
+        {
+            center[axis] = (float)(a->center[axis] / a->area);
+        }
+        uint32_t material = 0u;
+        for (uint32_t k = 1u; k < LOD_MATERIAL_COUNT; ++k)
+        {
+            if (a->areaByMaterial[k] > a->areaByMaterial[material]) material = k;
+        }
+        gbbPackSphere(&proxies->bounds, center, (float)sqrt(a->area), material, &proxies->words[proxies->count * 2u]);
+        proxies->count += 1u;
+    }
+    free(accum);
+    gbbMarkAllDirty(&proxies->dirty);
+
+    return gbbBuildSphereGrid(&lod->grid, proxies, macroDims[0], macroDims[1], macroDims[2], 0u);
+}
+
+void gbbFreeSphereLod(SphereLod* lod)
+{
+    gbbFreeSphereGrid(&lod->grid);
+    gbbFreePackedSpheres(&lod->proxies);
+    lod->macroSize = 0u;
+}
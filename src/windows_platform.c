@@ -1,5 +1,10 @@
+#include <winsock2.h>
+#include <ws2tcpip.h>
 #include <windows.h>
 #include <windowsx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "platform.h"
 
 static const char* const WINDOW_CLASS_NAME = "greatbadbeyond_window_class";
@@ -8,8 +13,6 @@ static const uint32_t MAX_PUMP_EVENTS_PER_CALL = 64u;
 static HINSTANCE instance_handle = NULL;
 void *window_handle = NULL;
 static uint32_t should_quit = 0u;
-static uint8_t key_states[GBB_KEY_COUNT] = {0u};
-static float mouse_wheel_delta = 0.0f;
 
 static int gbbMapVirtualKey(WPARAM wParam, uint32_t* key)
 {
@@ -45,7 +48,7 @@ static LRESULT CALLBACK gbbWindowProc(HWND window, UINT message, WPARAM wParam,
         {
             const uint32_t is_escape = (wParam == VK_ESCAPE) ? 1u : 0u;
             uint32_t key = 0u;
-            if (gbbMapVirtualKey(wParam, &key) != 0) key_states[key] = 1u;
+            if (gbbMapVirtualKey(wParam, &key) != 0) gbbPostKeyEvent(key, 1, gbbGetTimeNs());
             should_quit |= is_escape;
             if (is_escape != 0u)
             {
@@ -57,12 +60,12 @@ static LRESULT CALLBACK gbbWindowProc(HWND window, UINT message, WPARAM wParam,
         case WM_KEYUP:
         {
             uint32_t key = 0u;
-            if (gbbMapVirtualKey(wParam, &key) != 0) key_states[key] = 0u;
+            if (gbbMapVirtualKey(wParam, &key) != 0) gbbPostKeyEvent(key, 0, gbbGetTimeNs());
             break;
         }
         case WM_MOUSEWHEEL:
         {
-            mouse_wheel_delta += (float)GET_WHEEL_DELTA_WPARAM(wParam) / (float)WHEEL_DELTA;
+            gbbPostMouseWheel((float)GET_WHEEL_DELTA_WPARAM(wParam) / (float)WHEEL_DELTA, gbbGetTimeNs());
             break;
         }
         default:
@@ -99,7 +102,6 @@ int gbbInitWindow(uint32_t width, uint32_t height, const char* title)
     UpdateWindow((HWND)window_handle);
 
     should_quit = 0u;
-    mouse_wheel_delta = 0.0f;
     return 0;
 }
 
@@ -133,18 +135,6 @@ int gbbPumpEventsOnce(void)
     return (int)should_quit;
 }
 
-int gbbIsKeyDown(uint32_t key)
-{
-    if (key >= GBB_KEY_COUNT) return 0;
-    return (int)key_states[key];
-}
-
-void gbbConsumeMouseWheel(float* delta)
-{
-    if (delta) *delta = mouse_wheel_delta;
-    mouse_wheel_delta = 0.0f;
-}
-
 uint64_t gbbGetTimeNs(void)
 {
     static LARGE_INTEGER freq = {0};
@@ -156,3 +146,252 @@ uint64_t gbbGetTimeNs(void)
     QueryPerformanceCounter(&now);
     return (uint64_t)(now.QuadPart * 1000000000ULL / freq.QuadPart);
 }
+
+typedef struct GbbThreadStart {
+    GbbThreadProc proc;
+    void* user;
+} GbbThreadStart;
+
+static DWORD WINAPI gbbThreadEntry(LPVOID param)
+{
+    GbbThreadStart start = *(GbbThreadStart*)param;
+    free(param);
+    start.proc(start.user);
+    return 0;
+}
+
+void* gbbCreateThread(GbbThreadProc proc, void* user)
+{
+    GbbThreadStart* start = (GbbThreadStart*)malloc(sizeof(GbbThreadStart));
+    if (!start) return NULL;
+    start->proc = proc;
+    start->user = user;
+    HANDLE thread = CreateThread(NULL, 0, gbbThreadEntry, start, 0, NULL);
+    if (!thread) free(start);
+    return (void*)thread;
+}
+
+void gbbJoinThread(void* thread)
+{
+    if (!thread) return;
+    WaitForSingleObject((HANDLE)thread, INFINITE);
+    CloseHandle((HANDLE)thread);
+}
+
+uint32_t gbbGetCpuCount(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (uint32_t)info.dwNumberOfProcessors : 1u;
+}
+
+void* gbbCreateSemaphore(uint32_t initialCount)
+{
+    return (void*)CreateSemaphoreA(NULL, (LONG)initialCount, 0x7fffffff, NULL);
+}
+
+void gbbDestroySemaphore(void* semaphore)
+{
+    if (!semaphore) return;
+    CloseHandle((HANDLE)semaphore);
+}
+
+void gbbWaitSemaphore(void* semaphore)
+{
+    WaitForSingleObject((HANDLE)semaphore, INFINITE);
+}
+
+int gbbTryWaitSemaphore(void* semaphore)
+{
+    return (WaitForSingleObject((HANDLE)semaphore, 0u) == WAIT_OBJECT_0) ? 1 : 0;
+}
+
+void gbbSignalSemaphore(void* semaphore)
+{
+    ReleaseSemaphore((HANDLE)semaphore, 1, NULL);
+}
+
+// Winsock is started by the first listen or connect, which both happen on the main
+// thread, and left running until exit.
+static int gbbStartWinsock(void)
+{
+    static uint32_t started = 0u;
+    if (started != 0u) return 0;
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return 1;
+    started = 1u;
+    return 0;
+}
+
+static void* gbbWrapSocket(SOCKET handle)
+{
+    if (handle == INVALID_SOCKET) return NULL;
+    SOCKET* stream = (SOCKET*)malloc(sizeof(SOCKET));
+    if (!stream)
+    {
+        closesocket(handle);
+        return NULL;
+    }
+    const BOOL one = TRUE;
+    setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+    *stream = handle;
+    return stream;
+}
+
+void* gbbListenSocket(uint16_t port, uint32_t loopbackOnly, uint16_t* boundPort)
+{
+    if (gbbStartWinsock() != 0) return NULL;
+    const SOCKET handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (handle == INVALID_SOCKET) return NULL;
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl((loopbackOnly != 0u) ? INADDR_LOOPBACK : INADDR_ANY);
+    int addressSize = (int)sizeof(address);
+    if ((bind(handle, (struct sockaddr*)&address, (int)sizeof(address)) != 0) || (listen(handle, 16) != 0) ||
+        (getsockname(handle, (struct sockaddr*)&address, &addressSize) != 0))
+    {
+        closesocket(handle);
+        return NULL;
+    }
+    if (boundPort) *boundPort = ntohs(address.sin_port);
+    SOCKET* listener = (SOCKET*)malloc(sizeof(SOCKET));
+    if (!listener)
+    {
+        closesocket(handle);
+        return NULL;
+    }
+    *listener = handle;
+    return listener;
+}
+
+void* gbbAcceptSocket(void* listener, uint32_t timeoutMs)
+{
+    const SOCKET handle = *(SOCKET*)listener;
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(handle, &readable);
+    const struct timeval timeout = {(long)(timeoutMs / 1000u), (long)((timeoutMs % 1000u) * 1000u)};
+    if (select(0, &readable, NULL, NULL, &timeout) <= 0) return NULL;
+    return gbbWrapSocket(accept(handle, NULL, NULL));
+}
+
+void* gbbConnectSocket(const char* host, uint16_t port)
+{
+    if (gbbStartWinsock() != 0) return NULL;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", (unsigned)port);
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    struct addrinfo* results = NULL;
+    if (getaddrinfo(host, service, &hints, &results) != 0) return NULL;
+    SOCKET handle = INVALID_SOCKET;
+    for (struct addrinfo* it = results; it && (handle == INVALID_SOCKET); it = it->ai_next)
+    {
+        handle = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+        if ((handle != INVALID_SOCKET) && (connect(handle, it->ai_addr, (int)it->ai_addrlen) != 0))
+        {
+            closesocket(handle);
+            handle = INVALID_SOCKET;
+        }
+    }
+    freeaddrinfo(results);
+    return gbbWrapSocket(handle);
+}
+
+int gbbSendAll(void* stream, const void* data, size_t size)
+{
+    const char* bytes = (const char*)data;
+    while (size > 0u)
+    {
+        const int chunk = (size > 0x40000000u) ? 0x40000000 : (int)size;
+        const int sent = send(*(SOCKET*)stream, bytes, chunk, 0);
+        if (sent <= 0) return 1;
+        bytes += sent;
+        size -= (size_t)sent;
+    }
+    return 0;
+}
+
+int gbbRecvAll(void* stream, void* data, size_t size)
+{
+    char* bytes = (char*)data;
+    while (size > 0u)
+    {
+        const int chunk = (size > 0x40000000u) ? 0x40000000 : (int)size;
+        const int received = recv(*(SOCKET*)stream, bytes, chunk, 0);
+        if (received <= 0) return 1;
+        bytes += received;
+        size -= (size_t)received;
+    }
+    return 0;
+}
+
+void gbbCloseSocket(void* stream)
+{
+    if (!stream) return;
+    closesocket(*(SOCKET*)stream);
+    free(stream);
+}
+
+// CreateProcess takes one command line, so every argument is quoted, with the
+// backslash doubling the MSVC runtime expects before quotes.
+void* gbbSpawnProcess(const char* const* argv)
+{
+    size_t length = 1u;
+    for (const char* const* arg = argv; *arg; ++arg)
+    {
+        length += strlen(*arg) * 2u + 3u;
+    }
+    char* commandLine = (char*)malloc(length);
+    if (!commandLine) return NULL;
+    char* out = commandLine;
+    for (const char* const* arg = argv; *arg; ++arg)
+    {
+        if (arg != argv) *out++ = ' ';
+        *out++ = '"';
+        size_t backslashes = 0u;
+        for (const char* c = *arg; *c; ++c)
+        {
+            if (*c == '\\')
+            {
+                backslashes += 1u;
+                *out++ = *c;
+                continue;
+            }
+            if (*c == '"')
+            {
+                for (size_t i = 0u; i < backslashes + 1u; ++i) *out++ = '\\';
+            }
+            backslashes = 0u;
+            *out++ = *c;
+        }
+        for (size_t i = 0u; i < backslashes; ++i) *out++ = '\\';
+        *out++ = '"';
+    }
+    *out = '\0';
+
+    STARTUPINFOA startup;
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION info;
+    const BOOL created = CreateProcessA(NULL, commandLine, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info);
+    free(commandLine);
+    if (!created) return NULL;
+    CloseHandle(info.hThread);
+    return (void*)info.hProcess;
+}
+
+int gbbWaitProcess(void* process)
+{
+    if (!process) return -1;
+    DWORD exitCode = 0u;
+    const int waited = (WaitForSingleObject((HANDLE)process, INFINITE) == WAIT_OBJECT_0) &&
+                       GetExitCodeProcess((HANDLE)process, &exitCode);
+    CloseHandle((HANDLE)process);
+    return waited ? (int)exitCode : -1;
+}